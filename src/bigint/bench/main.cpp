@@ -0,0 +1,176 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dinterp/bigint.h"
+#ifdef DINTERP_BENCH_GMP
+#include <gmp.h>
+#endif
+using namespace std;
+using namespace dinterp;
+
+/*
+ * Sizes are given in 32-bit chunks. Operations that are linear or subquadratic are measured up to ~10^6 chunks;
+ * division and conversions from/to decimal are quadratic, so they stop earlier to keep a full run within minutes.
+ */
+
+static void LinearSizes(benchmark::internal::Benchmark* b) { b->RangeMultiplier(8)->Range(1, 1 << 20); }
+static void MulSizes(benchmark::internal::Benchmark* b) { b->RangeMultiplier(4)->Range(1, 1 << 20); }
+static void QuadraticSizes(benchmark::internal::Benchmark* b) { b->RangeMultiplier(4)->Range(1, 1 << 12); }
+static void ToStringSizes(benchmark::internal::Benchmark* b) { b->RangeMultiplier(4)->Range(1, 1 << 10); }
+
+// Random chunks, least significant first; the top chunk is nonzero so that the number has exactly `n` chunks
+static vector<uint32_t> RandomChunks(size_t n, uint64_t seed) {
+    mt19937_64 rng(seed);
+    vector<uint32_t> res(n);
+    for (auto& chunk : res) chunk = static_cast<uint32_t>(rng());
+    res.back() |= 1u << 31;
+    return res;
+}
+
+static BigInt MakeBigInt(const vector<uint32_t>& chunks) {
+    return BigInt(vector<size_t>(chunks.rbegin(), chunks.rend()), 1ul << 32);
+}
+
+static BigInt RandomBigInt(size_t n, uint64_t seed) { return MakeBigInt(RandomChunks(n, seed)); }
+
+static void BM_Add(benchmark::State& state) {
+    size_t n = state.range(0);
+    BigInt a = RandomBigInt(n, 1), b = RandomBigInt(n, 2);
+    for (auto _ : state) benchmark::DoNotOptimize(a + b);
+    state.SetComplexityN(n);
+}
+BENCHMARK(BM_Add)->Apply(LinearSizes)->Complexity(benchmark::oN);
+
+static void BM_Sub(benchmark::State& state) {
+    size_t n = state.range(0);
+    BigInt a = RandomBigInt(n, 1), b = RandomBigInt(n, 2);
+    for (auto _ : state) benchmark::DoNotOptimize(a - b);
+    state.SetComplexityN(n);
+}
+BENCHMARK(BM_Sub)->Apply(LinearSizes)->Complexity(benchmark::oN);
+
+static void BM_Mul(benchmark::State& state) {
+    size_t n = state.range(0);
+    BigInt a = RandomBigInt(n, 1), b = RandomBigInt(n, 2);
+    for (auto _ : state) benchmark::DoNotOptimize(a * b);
+    state.SetComplexityN(n);
+}
+BENCHMARK(BM_Mul)->Apply(MulSizes)->Complexity();
+
+// A 2n-chunk number divided by an n-chunk one
+static void BM_DivMod(benchmark::State& state) {
+    size_t n = state.range(0);
+    BigInt a = RandomBigInt(2 * n, 1), b = RandomBigInt(n, 2);
+    for (auto _ : state) benchmark::DoNotOptimize(a.DivMod(b));
+    state.SetComplexityN(n);
+}
+BENCHMARK(BM_DivMod)->Apply(QuadraticSizes)->Complexity();
+
+static void BM_ToString(benchmark::State& state) {
+    size_t n = state.range(0);
+    BigInt a = RandomBigInt(n, 1);
+    for (auto _ : state) benchmark::DoNotOptimize(a.ToString());
+    state.SetComplexityN(n);
+}
+BENCHMARK(BM_ToString)->Apply(ToStringSizes)->Complexity();
+
+static void BM_Parse(benchmark::State& state) {
+    size_t n = state.range(0);
+    // ~9.63 decimal digits per chunk
+    string digits = "9" + string(n * 963 / 100, '7');
+    for (auto _ : state) benchmark::DoNotOptimize(BigInt(digits, 10));
+    state.SetComplexityN(n);
+}
+BENCHMARK(BM_Parse)->Apply(QuadraticSizes)->Complexity();
+
+#ifdef DINTERP_BENCH_GMP
+
+class Mpz {
+public:
+    mpz_t value;
+    Mpz() { mpz_init(value); }
+    explicit Mpz(const vector<uint32_t>& chunks) : Mpz() {
+        mpz_import(value, chunks.size(), -1, sizeof(uint32_t), 0, 0, chunks.data());
+    }
+    Mpz(const Mpz&) = delete;
+    Mpz& operator=(const Mpz&) = delete;
+    ~Mpz() { mpz_clear(value); }
+};
+
+static void BM_GmpAdd(benchmark::State& state) {
+    size_t n = state.range(0);
+    Mpz a(RandomChunks(n, 1)), b(RandomChunks(n, 2));
+    for (auto _ : state) {
+        Mpz c;
+        mpz_add(c.value, a.value, b.value);
+        benchmark::DoNotOptimize(c.value);
+    }
+    state.SetComplexityN(n);
+}
+BENCHMARK(BM_GmpAdd)->Apply(LinearSizes)->Complexity(benchmark::oN);
+
+static void BM_GmpSub(benchmark::State& state) {
+    size_t n = state.range(0);
+    Mpz a(RandomChunks(n, 1)), b(RandomChunks(n, 2));
+    for (auto _ : state) {
+        Mpz c;
+        mpz_sub(c.value, a.value, b.value);
+        benchmark::DoNotOptimize(c.value);
+    }
+    state.SetComplexityN(n);
+}
+BENCHMARK(BM_GmpSub)->Apply(LinearSizes)->Complexity(benchmark::oN);
+
+static void BM_GmpMul(benchmark::State& state) {
+    size_t n = state.range(0);
+    Mpz a(RandomChunks(n, 1)), b(RandomChunks(n, 2));
+    for (auto _ : state) {
+        Mpz c;
+        mpz_mul(c.value, a.value, b.value);
+        benchmark::DoNotOptimize(c.value);
+    }
+    state.SetComplexityN(n);
+}
+BENCHMARK(BM_GmpMul)->Apply(MulSizes)->Complexity();
+
+static void BM_GmpDivMod(benchmark::State& state) {
+    size_t n = state.range(0);
+    Mpz a(RandomChunks(2 * n, 1)), b(RandomChunks(n, 2));
+    for (auto _ : state) {
+        Mpz q, r;
+        mpz_fdiv_qr(q.value, r.value, a.value, b.value);
+        benchmark::DoNotOptimize(q.value);
+        benchmark::DoNotOptimize(r.value);
+    }
+    state.SetComplexityN(n);
+}
+BENCHMARK(BM_GmpDivMod)->Apply(QuadraticSizes)->Complexity();
+
+static void BM_GmpToString(benchmark::State& state) {
+    size_t n = state.range(0);
+    Mpz a(RandomChunks(n, 1));
+    string buf(mpz_sizeinbase(a.value, 10) + 2, '\0');
+    for (auto _ : state) benchmark::DoNotOptimize(mpz_get_str(buf.data(), 10, a.value));
+    state.SetComplexityN(n);
+}
+BENCHMARK(BM_GmpToString)->Apply(ToStringSizes)->Complexity();
+
+static void BM_GmpParse(benchmark::State& state) {
+    size_t n = state.range(0);
+    string digits = "9" + string(n * 963 / 100, '7');
+    for (auto _ : state) {
+        Mpz a;
+        mpz_set_str(a.value, digits.c_str(), 10);
+        benchmark::DoNotOptimize(a.value);
+    }
+    state.SetComplexityN(n);
+}
+BENCHMARK(BM_GmpParse)->Apply(QuadraticSizes)->Complexity();
+
+#endif
+
+BENCHMARK_MAIN();
@@ -3,19 +3,20 @@
 #include <ieee754.h>
 
 #include <algorithm>
+#include <atomic>
 #include <bit>
 #include <cmath>
 #include <compare>
 #include <cstdint>
+#include <future>
 #include <limits>
-#include <sstream>
 #include <stdexcept>
 #include <vector>
+
+#include "limbs.h"
 using namespace std;
 
 namespace dinterp {
-ZeroDivisionException::ZeroDivisionException() : runtime_error("Tried to divide by BigInt(0)") {}
-
 BigInt::BigInt(const vector<uint32_t>& v, bool sign) : v(v), sign(sign) { normalize(); }
 
 static void assert_base_ge2(size_t base) {
@@ -73,7 +74,7 @@ void BigInt::initBigEndianRepr(const std::vector<size_t>& bigEndianRepr, size_t
 BigInt::BigInt(long val) {
     if (val == std::numeric_limits<long>::min()) {
         sign = true;
-        v = {0u, 0x10000000u};
+        v = {0u, 0x80000000u};
         return;
     }
     sign = val < 0;
@@ -152,6 +153,7 @@ BigInt& BigInt::operator=(size_t val) {
     v.resize(2);
     v[0] = static_cast<uint32_t>(val);
     v[1] = static_cast<uint32_t>(val >> 32);
+    normalize();
     return *this;
 }
 
@@ -178,7 +180,7 @@ std::vector<size_t> BigInt::Repr(size_t base) const {
         uint64_t buf = 0;
         int buflen = 0;
         for (uint32_t num : v) {
-            buf |= num << buflen;
+            buf |= static_cast<uint64_t>(num) << buflen;
             buflen += 32;
             while (buflen >= bits) {
                 res.push_back(buf & (base - 1));
@@ -187,29 +189,12 @@ std::vector<size_t> BigInt::Repr(size_t base) const {
             }
         }
         if (buflen) res.push_back(buf);
+        while (res.size() > 1 && !res.back()) res.pop_back();
     }
     reverse(res.begin(), res.end());
     return res;
 }
 
-std::string BigInt::ToString(size_t base) const {
-    assert_base_ge2(base);
-    if (base > 10 + 26) throw std::invalid_argument("base > 36 for string representation");
-    auto repr = Repr(base);
-    size_t n = repr.size();
-    string res(n, '.');
-    for (size_t i = 0; i < n; i++) {
-        size_t val = repr[i];
-        char& dest = res[i];
-        if (val < 10)
-            dest = '0' + val;
-        else
-            dest = 'A' + val - 10;
-    }
-    if (sign) res.insert(res.begin(), '-');
-    return res;
-}
-
 struct VectorView {
     vector<uint32_t>& v;
     size_t start, end;
@@ -218,6 +203,7 @@ struct VectorView {
     size_t size() const { return end - start; }
     uint32_t& operator[](int index) { return v[index + start]; }
     uint32_t& get(int index) { return v[index + start]; }
+    uint32_t* data() { return v.data() + start; }
     vector<uint32_t> Cut() const { return vector<uint32_t>(v.begin() + start, v.begin() + end); }
     pair<VectorView, VectorView> Split(size_t lowsize) const {
         return {{v, start, start + lowsize}, {v, start + lowsize, end}};
@@ -234,6 +220,7 @@ struct ConstVectorView {
     size_t size() const { return end - start; }
     uint32_t operator[](int index) const { return v[index + start]; }
     uint32_t get(int index) const { return v[index + start]; }
+    const uint32_t* data() const { return v.data() + start; }
     vector<uint32_t> Cut() const { return vector<uint32_t>(v.begin() + start, v.begin() + end); }
     pair<ConstVectorView, ConstVectorView> Split(size_t lowsize) const {
         return {{v, start, start + lowsize}, {v, start + lowsize, end}};
@@ -277,39 +264,29 @@ static int UnsignedBigCompare(const vector<uint32_t>& a, const vector<uint32_t>&
 }
 
 static uint32_t BigAdd(VectorView dest, ConstVectorView src) {
-    uint64_t buf = 0;
-    size_t srcn = src.size();
-    for (size_t i = 0; i < srcn; i++) {
-        buf += static_cast<uint64_t>(dest[i]) + src[i];
-        dest[i] = static_cast<uint32_t>(buf);
-        buf >>= 32;
-    }
-    return buf;
+    return limbs::Add(dest.data(), dest.data(), src.data(), src.size(), 0);
+}
+
+// Propagates `carry` into `dest`; returns the carry out of the last chunk
+static uint32_t AddCarry(VectorView dest, uint32_t carry) {
+    size_t n = dest.size();
+    for (size_t i = 0; i < n && carry; i++) carry = ++dest[i] == 0;
+    return carry;
 }
 
 static void BigAdd(vector<uint32_t>& dest, ConstVectorView src) {
     if (dest.size() < src.size()) dest.resize(src.size());
-    uint32_t carry = BigAdd({dest, 0, dest.size()}, src);
-    if (carry) {
-        if (dest.size() == src.size())
-            dest.push_back(static_cast<uint32_t>(carry));
-        else
-            dest[src.size()] += static_cast<uint32_t>(carry);
-    }
+    VectorView view = dest;
+    uint32_t carry = AddCarry(view.Subview(src.size(), view.size()), BigAdd(view, src));
+    if (carry) dest.push_back(carry);
 }
 
 static void BigAdd(vector<uint32_t>& dest, const vector<uint32_t>& src) { BigAdd(dest, {src, 0, src.size()}); }
 
 static void BigSub(VectorView dest, ConstVectorView src) {
-    long buf = 0;
-    size_t n = dest.size();
-    size_t srcn = src.size();
-    for (size_t i = 0; i < n; i++) {
-        buf += dest[i];
-        if (i < srcn) buf -= src[i];
-        dest[i] = static_cast<uint32_t>(bit_cast<uint64_t>(buf));
-        buf >>= 32;
-    }
+    size_t n = dest.size(), srcn = min(n, src.size());
+    uint32_t borrow = limbs::Sub(dest.data(), dest.data(), src.data(), srcn, 0);
+    for (size_t i = srcn; i < n && borrow; i++) borrow = dest[i]-- == 0;
 }
 
 static void BigSub(vector<uint32_t>& dest, const vector<uint32_t>& src) {
@@ -365,73 +342,176 @@ BigInt BigInt::operator-(const BigInt& other) const {
     return res -= other;
 }
 
-static uint32_t BigMul(VectorView a, uint32_t b) {
-    uint64_t buf = 0;
-    size_t n = a.size();
-    for (size_t i = 0; i < n; i++) {
-        buf += static_cast<uint64_t>(a[i]) * b;
-        a[i] = static_cast<uint32_t>(buf);
-        buf >>= 32;
-    }
-    return static_cast<uint32_t>(buf);
-}
+static uint32_t BigMul(VectorView a, uint32_t b) { return limbs::Mul(a.data(), a.data(), a.size(), b, 0); }
 
 static void BigMul(vector<uint32_t>& a, uint32_t b) {
     uint32_t carry = BigMul({a, 0, a.size()}, b);
     if (carry) a.push_back(carry);
 }
 
-static void AddFrom(vector<uint32_t>& dest, size_t startadd, ConstVectorView src) {
-    dest.resize(max(startadd + src.size(), dest.size()));
-    uint32_t carry = BigAdd({dest, startadd, dest.size()}, src);
-    if (carry) {
-        size_t ind = startadd + src.size();
-        if (ind == dest.size()) dest.push_back(0);
-        dest[ind] += carry;
+// Operands shorter than this many chunks are multiplied with the schoolbook algorithm: below it, Karatsuba's extra
+// additions cost more than the multiplications they save. Tuned on 10..500-chunk operands.
+static constexpr size_t KARATSUBA_THRESHOLD = 32;
+
+// dest = a + b; requires a.size() >= b.size() and dest.size() == a.size() + 1
+static void OutOfPlaceAdd(VectorView dest, ConstVectorView a, ConstVectorView b) {
+    size_t an = a.size(), bn = b.size();
+    uint64_t buf = limbs::Add(dest.data(), a.data(), b.data(), bn, 0);
+    for (size_t i = bn; i < an; i++) {
+        buf += a[i];
+        dest[i] = static_cast<uint32_t>(buf);
+        buf >>= 32;
+    }
+    dest[an] = static_cast<uint32_t>(buf);
+}
+
+// dest = a * b; requires dest.size() == a.size() + b.size()
+static void SchoolbookMul(VectorView dest, ConstVectorView a, ConstVectorView b) {
+    size_t an = a.size(), bn = b.size();
+    dest[an] = limbs::Mul(dest.data(), a.data(), an, b[0], 0);
+    for (size_t j = 1; j < bn; j++) dest[an + j] = limbs::AddMul(dest.data() + j, a.data(), an, b[j], 0);
+}
+
+// The number of scratch chunks KaratsubaMul needs for operands of these sizes; mirrors its recursion
+static size_t KaratsubaScratchSize(size_t an, size_t bn) {
+    if (an < bn) swap(an, bn);
+    if (bn < KARATSUBA_THRESHOLD) return 0;
+    size_t half = an / 2;
+    if (half >= bn) {
+        size_t res = 2 * bn + KaratsubaScratchSize(bn, bn);
+        if (size_t rest = an % bn) res = max(res, rest + bn + KaratsubaScratchSize(rest, bn));
+        return res;
     }
+    size_t sumn1 = an - half + 1, sumn2 = max(half, bn - half) + 1;
+    return 2 * (sumn1 + sumn2) + KaratsubaScratchSize(sumn1, sumn2);
 }
 
-static vector<uint32_t> KaratsubaMul(ConstVectorView a, ConstVectorView b) {
+// Karatsuba steps whose smaller operand has at least this many chunks may compute their three sub-products on separate
+// threads; below it, a sub-product takes too little time to pay for starting a thread.
+static constexpr size_t PARALLEL_MUL_THRESHOLD = 4096;
+
+static atomic<size_t> mulThreads = 1;
+
+// The threads a single multiplication may still start. A step takes one for each sub-product it hands to another
+// thread and gives it back once that thread is joined, so idle threads are picked up by whichever branch of the
+// recursion reaches a large enough step first.
+class ThreadBudget {
+    atomic<size_t> spare;
+
+public:
+    explicit ThreadBudget(size_t threads) : spare(threads - 1) {}
+    bool TryAcquire() {
+        size_t cur = spare.load(memory_order_relaxed);
+        while (cur && !spare.compare_exchange_weak(cur, cur - 1, memory_order_relaxed)) {
+        }
+        return cur;
+    }
+    void Release() { spare.fetch_add(1, memory_order_relaxed); }
+};
+
+// dest = a * b; requires dest.size() == a.size() + b.size() and
+// scratch.size() >= KaratsubaScratchSize(a.size(), b.size()). dest must not overlap a, b, or scratch.
+// With a budget, sub-products may run concurrently; they write disjoint parts of dest, so the result is the same.
+static void KaratsubaMul(VectorView dest, ConstVectorView a, ConstVectorView b, VectorView scratch,
+                         ThreadBudget* budget = nullptr) {
     // a = wc + x; b = yc + z
     // a * b = wycc + (wz + xy)c + xz
     // wz + xy = (w + x)(y + z) - wy - xz
     ConstVectorView *pa = &a, *pb = &b;
     if (pa->size() < pb->size()) swap(pa, pb);
-    if (pb->size() == 1) {
-        auto v = pa->Cut();
-        BigMul(v, pb->get(0));
-        return v;
-    }
-    size_t half = pa->size() / 2;
-    if (half >= pb->size()) {
-        auto lh = pa->Split(half);
-        auto low = KaratsubaMul(lh.first, *pb);
-        auto high = KaratsubaMul(lh.second, *pb);
-        AddFrom(low, half, high);
-        return low;
+    size_t an = pa->size(), bn = pb->size();
+    if (bn < KARATSUBA_THRESHOLD) {
+        SchoolbookMul(dest, *pa, *pb);
+        return;
+    }
+    size_t half = an / 2;
+    if (half >= bn) {
+        // multiply bn-sized pieces of a by b and accumulate them in dest
+        fill(dest.v.begin() + dest.start, dest.v.begin() + dest.end, 0u);
+        for (size_t from = 0; from < an; from += bn) {
+            size_t to = min(an, from + bn);
+            auto prod = scratch.Subview(0, to - from + bn);
+            KaratsubaMul(prod, pa->Subview(from, to), *pb, scratch.Subview(prod.size(), scratch.size()), budget);
+            auto rest = dest.Subview(from, dest.size());
+            AddCarry(rest.Subview(prod.size(), rest.size()), BigAdd(rest, prod));
+        }
+        return;
     }
     auto x_w = pa->Split(half);
     auto z_y = pb->Split(half);
     ConstVectorView w = x_w.second, x = x_w.first, y = z_y.second, z = z_y.first;
-    auto wy = KaratsubaMul(w, y);
-    auto xz = KaratsubaMul(x, z);
-    auto wplusx = w.Cut();
-    BigAdd(wplusx, x);
-    auto yplusz = y.Cut();
-    BigAdd(yplusz, z);
-    auto mid = KaratsubaMul(wplusx, yplusz);
-    BigSub(mid, wy);
-    BigSub(mid, xz);
-    AddFrom(xz, half, mid);
-    AddFrom(xz, half * 2, wy);
-    return xz;
-}
-
-BigInt& BigInt::operator*=(const BigInt& other) { return *this = *this * other; }
+    auto low = dest.Subview(0, half * 2), top = dest.Subview(half * 2, dest.size());
+    size_t sumn1 = w.size() + 1, sumn2 = max(y.size(), z.size()) + 1;
+    auto wplusx = scratch.Subview(0, sumn1);
+    auto yplusz = scratch.Subview(sumn1, sumn1 + sumn2);
+    auto mid = scratch.Subview(sumn1 + sumn2, 2 * (sumn1 + sumn2));
+    auto midScratch = scratch.Subview(mid.end - scratch.start, scratch.size());
+    if (budget && bn >= PARALLEL_MUL_THRESHOLD) {
+        // the sums are computed first, so the scratch memory they occupy is not shared with the other sub-products
+        OutOfPlaceAdd(wplusx, w, x);
+        if (y.size() >= z.size())
+            OutOfPlaceAdd(yplusz, y, z);
+        else
+            OutOfPlaceAdd(yplusz, z, y);
+        // a sub-product handed to another thread gets its own scratch memory
+        auto spawn = [budget](VectorView pdest, ConstVectorView pa, ConstVectorView pb) -> future<void> {
+            if (!budget->TryAcquire()) {
+                vector<uint32_t> pscratch(KaratsubaScratchSize(pa.size(), pb.size()));
+                KaratsubaMul(pdest, pa, pb, pscratch, budget);
+                return {};
+            }
+            return async(launch::async, [=] {
+                vector<uint32_t> pscratch(KaratsubaScratchSize(pa.size(), pb.size()));
+                KaratsubaMul(pdest, pa, pb, pscratch, budget);
+                budget->Release();
+            });
+        };
+        auto lowDone = spawn(low, x, z);
+        auto topDone = spawn(top, w, y);
+        KaratsubaMul(mid, wplusx, yplusz, midScratch, budget);
+        if (lowDone.valid()) lowDone.get();
+        if (topDone.valid()) topDone.get();
+    } else {
+        KaratsubaMul(low, x, z, scratch, budget);
+        KaratsubaMul(top, w, y, scratch, budget);
+        OutOfPlaceAdd(wplusx, w, x);
+        if (y.size() >= z.size())
+            OutOfPlaceAdd(yplusz, y, z);
+        else
+            OutOfPlaceAdd(yplusz, z, y);
+        KaratsubaMul(mid, wplusx, yplusz, midScratch, budget);
+    }
+    BigSub(mid, low);
+    BigSub(mid, top);
+    // wz + xy fits into the chunks of dest above `half`; the rest of `mid` is zeros
+    auto high = dest.Subview(half, dest.size());
+    size_t midn = min(mid.size(), high.size());
+    AddCarry(high.Subview(midn, high.size()), BigAdd(high, mid.Subview(0, midn)));
+}
+
+void BigInt::SetMulThreads(size_t threads) { mulThreads.store(max<size_t>(threads, 1), memory_order_relaxed); }
+
+size_t BigInt::MulThreads() { return mulThreads.load(memory_order_relaxed); }
+
+BigInt& BigInt::operator*=(const BigInt& other) {
+    if (other.v.size() == 1) {
+        BigMul(v, other.v[0]);
+        sign = sign != other.sign;
+        normalize();
+        return *this;
+    }
+    return *this = *this * other;
+}
 
 BigInt BigInt::operator*(const BigInt& other) const {
     BigInt res;
-    res.v = KaratsubaMul(v, other.v);
+    res.v.resize(v.size() + other.v.size());
+    vector<uint32_t> scratch(KaratsubaScratchSize(v.size(), other.v.size()));
+    if (size_t threads = mulThreads.load(memory_order_relaxed); threads > 1) {
+        ThreadBudget budget(threads);
+        KaratsubaMul(res.v, v, other.v, scratch, &budget);
+    } else
+        KaratsubaMul(res.v, v, other.v, scratch);
     res.sign = sign != other.sign;
     res.normalize();
     return res;
@@ -465,13 +545,8 @@ BigInt BigInt::operator%(const BigInt& other) const {
 }
 
 static void OutOfPlaceMul(VectorView dest, ConstVectorView a, uint32_t b) {
-    uint64_t buf = 0;
     size_t n = a.size();
-    for (size_t i = 0; i < n; i++) {
-        buf += static_cast<uint64_t>(a[i]) * b;
-        dest[i] = static_cast<uint32_t>(buf);
-        buf >>= 32;
-    }
+    uint32_t buf = limbs::Mul(dest.data(), a.data(), n, b, 0);
     size_t dn = dest.size();
     for (size_t i = n; i < dn; i++) {
         dest[i] = buf;
@@ -534,6 +609,222 @@ std::optional<std::pair<BigInt, BigInt>> BigInt::DivMod(const BigInt& other) con
     return {};
 }
 
+BigInt& BigInt::operator<<=(size_t shift) {
+    if (!*this) return *this;
+    size_t chunks = shift / 32, bits = shift % 32;
+    if (bits) {
+        uint32_t carry = 0;
+        for (uint32_t& chunk : v) {
+            uint32_t next = chunk >> (32 - bits);
+            chunk = (chunk << bits) | carry;
+            carry = next;
+        }
+        if (carry) v.push_back(carry);
+    }
+    v.insert(v.begin(), chunks, 0u);
+    return *this;
+}
+
+BigInt BigInt::operator<<(size_t shift) const {
+    BigInt res = *this;
+    return res <<= shift;
+}
+
+BigInt& BigInt::operator>>=(size_t shift) {
+    size_t chunks = shift / 32, bits = shift % 32;
+    if (chunks >= v.size()) {
+        *this = sign ? -1l : 0l;
+        return *this;
+    }
+    bool lostOnes = any_of(v.begin(), v.begin() + chunks, [](uint32_t chunk) { return chunk; }) ||
+                    (bits && (v[chunks] & ((1u << bits) - 1)));
+    v.erase(v.begin(), v.begin() + chunks);
+    if (bits) {
+        size_t n = v.size();
+        for (size_t i = 0; i + 1 < n; i++) v[i] = (v[i] >> bits) | (v[i + 1] << (32 - bits));
+        v.back() >>= bits;
+    }
+    normalize();
+    if (sign && lostOnes) {  // round towards negative infinity
+        sign = false;
+        ++*this;
+        sign = true;
+    } else if (!*this)
+        sign = false;
+    return *this;
+}
+
+BigInt BigInt::operator>>(size_t shift) const {
+    BigInt res = *this;
+    return res >>= shift;
+}
+
+// Writes n chunks of the two's complement representation of a number into a vector
+static vector<uint32_t> TwosComplement(const vector<uint32_t>& v, bool sign, size_t n) {
+    vector<uint32_t> res(v);
+    res.resize(n, 0u);
+    if (!sign) return res;
+    BigSub(res, vector<uint32_t>{1u});
+    for (uint32_t& chunk : res) chunk = ~chunk;
+    return res;
+}
+
+BigInt BigInt::bitwise(const BigInt& other, uint32_t (*op)(uint32_t, uint32_t)) const {
+    size_t n = max(v.size(), other.v.size());
+    auto a = TwosComplement(v, sign, n), b = TwosComplement(other.v, other.sign, n);
+    bool ressign = op(sign ? ~0u : 0u, other.sign ? ~0u : 0u);
+    for (size_t i = 0; i < n; i++) a[i] = op(a[i], b[i]);
+    if (ressign) {
+        for (uint32_t& chunk : a) chunk = ~chunk;
+        BigAdd(a, vector<uint32_t>{1u});
+    }
+    return BigInt(a, ressign);
+}
+
+BigInt BigInt::operator&(const BigInt& other) const {
+    return bitwise(other, [](uint32_t a, uint32_t b) { return a & b; });
+}
+
+BigInt BigInt::operator|(const BigInt& other) const {
+    return bitwise(other, [](uint32_t a, uint32_t b) { return a | b; });
+}
+
+BigInt BigInt::operator^(const BigInt& other) const {
+    return bitwise(other, [](uint32_t a, uint32_t b) { return a ^ b; });
+}
+
+optional<BigInt> BigInt::Pow(const BigInt& exponent) const {
+    if (exponent.sign) return {};
+    if (!exponent) return BigInt(1);
+    if (!*this || *this == 1) return *this;
+    if (*this == -1) return (exponent.v[0] & 1) ? *this : BigInt(1);
+    // left-to-right binary exponentiation: multiplications by `this` stay cheap when it is short
+    BigInt res = *this;
+    for (long bit = static_cast<long>(exponent.SignificantBits()) - 2; bit >= 0; bit--) {
+        res *= res;
+        if ((exponent.v[bit / 32] >> (bit % 32)) & 1) res *= *this;
+    }
+    return res;
+}
+
+namespace {
+// Barrett reduction modulo a fixed positive number: one slow division up front, then only multiplications and
+// shifts for every reduction
+class BarrettReducer {
+    BigInt mod, mu;
+    size_t k;
+
+public:
+    BarrettReducer(const BigInt& mod) : mod(mod), k((mod.SignificantBits() + 31) / 32) {
+        mu = (BigInt(1) << (64 * k)) / mod;
+    }
+    // x must be in [0, mod**2)
+    BigInt Reduce(const BigInt& x) const {
+        BigInt q = ((x >> (32 * (k - 1))) * mu) >> (32 * (k + 1));
+        BigInt r = x - q * mod;
+        while (r >= mod) r -= mod;
+        return r;
+    }
+};
+}  // namespace
+
+optional<BigInt> BigInt::ModPow(const BigInt& exponent, const BigInt& modulus) const {
+    if (exponent.sign || !modulus) return {};
+    BigInt absmod = modulus;
+    absmod.sign = false;
+    BigInt res;
+    if (absmod != 1) {
+        BarrettReducer reducer(absmod);
+        BigInt base = *this % absmod;
+        res = 1l;
+        for (long bit = static_cast<long>(exponent.SignificantBits()) - 1; bit >= 0; bit--) {
+            res = reducer.Reduce(res * res);
+            if ((exponent.v[bit / 32] >> (bit % 32)) & 1) res = reducer.Reduce(res * base);
+        }
+    }
+    if (modulus.sign && res) res += modulus;  // the remainder has the sign of the divisor
+    return res;
+}
+
+// 64 bits of the number starting from bit `shift`
+static uint64_t BitWindow(const vector<uint32_t>& v, size_t shift) {
+    size_t i = shift / 32, bits = shift % 32, n = v.size();
+    uint64_t res = 0;
+    for (size_t j = 0; j < 3 && i + j < n; j++) {
+        uint64_t chunk = v[i + j];
+        if (!j)
+            res |= chunk >> bits;
+        else if (32 * j - bits < 64)
+            res |= chunk << (32 * j - bits);
+    }
+    return res;
+}
+
+BigInt BigInt::Gcd(const BigInt& other) const {
+    BigInt a = *this, b = other;
+    a.sign = b.sign = false;
+    if (a < b) swap(a, b);
+    // Lehmer's algorithm: simulate Euclid's algorithm on the leading 60 bits, then apply the accumulated cofactors
+    // to the whole numbers
+    while (b.v.size() > 2) {
+        size_t shift = a.SignificantBits() - 60;
+        int64_t x = BitWindow(a.v, shift) & ((1ull << 60) - 1), y = BitWindow(b.v, shift) & ((1ull << 60) - 1);
+        int64_t A = 1, B = 0, C = 0, D = 1;
+        int k;
+        for (k = 0;; k++) {
+            if (y - C == 0) break;
+            int64_t q = (x + (A - 1)) / (y - C);
+            int64_t s = B + q * D;
+            int64_t t = x - q * y;
+            if (s > t) break;
+            x = y;
+            y = t;
+            t = A + q * C;
+            A = D;
+            B = C;
+            C = s;
+            D = t;
+        }
+        if (!k) {
+            BigInt r = a % b;
+            a = std::move(b);
+            b = std::move(r);
+            continue;
+        }
+        BigInt na, nb;
+        if (k & 1) {
+            na = b * BigInt(A) - a * BigInt(B);
+            nb = a * BigInt(D) - b * BigInt(C);
+        } else {
+            na = a * BigInt(A) - b * BigInt(B);
+            nb = b * BigInt(D) - a * BigInt(C);
+        }
+        a = std::move(na);
+        b = std::move(nb);
+    }
+    if (!b) return a;
+    a %= b;
+    uint64_t x = b.v[0] | (b.v.size() > 1 ? static_cast<uint64_t>(b.v[1]) << 32 : 0);
+    uint64_t y = a.v[0] | (a.v.size() > 1 ? static_cast<uint64_t>(a.v[1]) << 32 : 0);
+    while (y) {
+        x %= y;
+        swap(x, y);
+    }
+    return BigInt(static_cast<size_t>(x));
+}
+
+optional<BigInt> BigInt::ISqrt() const {
+    if (sign) return {};
+    if (!*this) return BigInt();
+    // Newton's method, starting from a power of 2 that is not less than the root
+    BigInt x = BigInt(1) << ((SignificantBits() + 1) / 2);
+    while (true) {
+        BigInt y = (x + *this / x) >> 1ul;
+        if (y >= x) return x;
+        x = std::move(y);
+    }
+}
+
 BigInt BigInt::operator-() const { return BigInt(v, !sign); }
 
 BigInt& BigInt::Negate() {
@@ -552,8 +843,9 @@ BigInt& BigInt::operator++() {
 }
 
 BigInt BigInt::operator++(int) {
-    BigInt res;
-    return ++res;
+    BigInt res = *this;
+    ++*this;
+    return res;
 }
 
 BigInt& BigInt::operator--() {
@@ -573,7 +865,8 @@ BigInt& BigInt::operator--() {
 
 BigInt BigInt::operator--(int) {
     BigInt res = *this;
-    return --res;
+    --*this;
+    return res;
 }
 
 int BigInt::operator<=>(const BigInt& other) const {
@@ -669,82 +962,10 @@ long double BigInt::ToFloat() const {
     return ld.d;
 }
 
-bool BigInt::operator<(const BigInt& other) const { return (*this <=> other) < 0; }
-bool BigInt::operator<(long other) const { return (*this <=> other) < 0; }
-bool BigInt::operator<(size_t other) const { return (*this <=> other) < 0; }
-bool BigInt::operator<(int other) const { return (*this <=> other) < 0; }
-bool BigInt::operator<(long double other) const { return (*this <=> other) < 0; }
-bool BigInt::operator<=(const BigInt& other) const { return (*this <=> other) <= 0; }
-bool BigInt::operator<=(long other) const { return (*this <=> other) <= 0; }
-bool BigInt::operator<=(size_t other) const { return (*this <=> other) <= 0; }
-bool BigInt::operator<=(int other) const { return (*this <=> other) <= 0; }
-bool BigInt::operator<=(long double other) const { return (*this <=> other) <= 0; }
-bool BigInt::operator>(const BigInt& other) const { return (*this <=> other) > 0; }
-bool BigInt::operator>(long other) const { return (*this <=> other) > 0; }
-bool BigInt::operator>(size_t other) const { return (*this <=> other) > 0; }
-bool BigInt::operator>(int other) const { return (*this <=> other) > 0; }
-bool BigInt::operator>(long double other) const { return (*this <=> other) > 0; }
-bool BigInt::operator>=(const BigInt& other) const { return (*this <=> other) >= 0; }
-bool BigInt::operator>=(long other) const { return (*this <=> other) >= 0; }
-bool BigInt::operator>=(size_t other) const { return (*this <=> other) >= 0; }
-bool BigInt::operator>=(int other) const { return (*this <=> other) >= 0; }
-bool BigInt::operator>=(long double other) const { return (*this <=> other) >= 0; }
-bool BigInt::operator==(const BigInt& other) const { return !(*this <=> other); }
-bool BigInt::operator==(long other) const { return !(*this <=> other); }
-bool BigInt::operator==(size_t other) const { return !(*this <=> other); }
-bool BigInt::operator==(int other) const { return !(*this <=> other); }
-bool BigInt::operator==(long double other) const { return (*this <=> other) == partial_ordering::equivalent; }
-bool BigInt::operator!=(const BigInt& other) const { return (*this <=> other); }
-bool BigInt::operator!=(long other) const { return !(*this <=> other); }
-bool BigInt::operator!=(size_t other) const { return !(*this <=> other); }
-bool BigInt::operator!=(int other) const { return !(*this <=> other); }
-bool BigInt::operator!=(long double other) const { return (*this <=> other) != partial_ordering::equivalent; }
-
 BigInt::operator bool() const { return v.size() > 1 || v[0]; }
 
 size_t BigInt::SignificantBits() const { return v.size() * 32 - countl_zero(v.back()); }
 
-int operator<=>(size_t a, const BigInt& b) { return -(b <=> a); }
-
-int operator<=>(int a, const BigInt& b) { return -(b <=> a); }
-
-int operator<=>(long a, const BigInt& b) { return -(b <=> a); }
-
-std::partial_ordering operator<=>(long double a, const BigInt& b) {
-    auto res = b <=> a;
-    if (res == partial_ordering::unordered || res == partial_ordering::equivalent) return res;
-    if (res == partial_ordering::less) return partial_ordering::greater;
-    return partial_ordering::less;
-}
-
-bool operator<(long a, const BigInt& b) { return (a <=> b) < 0; }
-bool operator<=(long a, const BigInt& b) { return (a <=> b) <= 0; }
-bool operator>(long a, const BigInt& b) { return (a <=> b) > 0; }
-bool operator>=(long a, const BigInt& b) { return (a <=> b) >= 0; }
-bool operator==(long a, const BigInt& b) { return (a <=> b) == 0; }
-bool operator!=(long a, const BigInt& b) { return (a <=> b) != 0; }
-
-bool operator<(size_t a, const BigInt& b) { return (a <=> b) < 0; }
-bool operator<=(size_t a, const BigInt& b) { return (a <=> b) <= 0; }
-bool operator>(size_t a, const BigInt& b) { return (a <=> b) > 0; }
-bool operator>=(size_t a, const BigInt& b) { return (a <=> b) >= 0; }
-bool operator==(size_t a, const BigInt& b) { return (a <=> b) == 0; }
-bool operator!=(size_t a, const BigInt& b) { return (a <=> b) != 0; }
-
-bool operator<(int a, const BigInt& b) { return (a <=> b) < 0; }
-bool operator<=(int a, const BigInt& b) { return (a <=> b) <= 0; }
-bool operator>(int a, const BigInt& b) { return (a <=> b) > 0; }
-bool operator>=(int a, const BigInt& b) { return (a <=> b) >= 0; }
-bool operator==(int a, const BigInt& b) { return (a <=> b) == 0; }
-bool operator!=(int a, const BigInt& b) { return (a <=> b) != 0; }
-
-bool operator<(long double a, const BigInt& b) { return (a <=> b) < 0; }
-bool operator<=(long double a, const BigInt& b) { return (a <=> b) <= 0; }
-bool operator>(long double a, const BigInt& b) { return (a <=> b) > 0; }
-bool operator>=(long double a, const BigInt& b) { return (a <=> b) >= 0; }
-bool operator==(long double a, const BigInt& b) { return (a <=> b) == 0; }
-bool operator!=(long double a, const BigInt& b) { return (a <=> b) != 0; }
-
 void BigInt::WriteRawReprToStream(ostream& out) const {
     out << "BigInt( { ";
     bool first = true;
@@ -755,17 +976,4 @@ void BigInt::WriteRawReprToStream(ostream& out) const {
     }
     out << " }, sign = " << sign << " }";
 }
-
-ostream& operator<<(ostream& out, const BigInt& a) {
-    a.WriteRawReprToStream(out);
-    return out;
-}
-
-std::string BigInt::RawRepr() const {
-    stringstream ss;
-    WriteRawReprToStream(ss);
-    return ss.str();
-}
-
-std::string to_string(const BigInt& a) { return a.RawRepr(); }
 }  // namespace dinterp
@@ -0,0 +1,114 @@
+#include "dinterp/bigint.h"
+
+#include <compare>
+#include <sstream>
+#include <stdexcept>
+using namespace std;
+
+// The part of BigInt that is expressed through the rest of its public interface and does not depend on the backend
+
+namespace dinterp {
+ZeroDivisionException::ZeroDivisionException() : runtime_error("Tried to divide by BigInt(0)") {}
+
+std::string BigInt::ToString(size_t base) const {
+    if (base > 10 + 26) throw std::invalid_argument("base > 36 for string representation");
+    auto repr = Repr(base);
+    size_t n = repr.size();
+    string res(n, '.');
+    for (size_t i = 0; i < n; i++) {
+        size_t val = repr[i];
+        char& dest = res[i];
+        if (val < 10)
+            dest = '0' + val;
+        else
+            dest = 'A' + val - 10;
+    }
+    if (IsNegative()) res.insert(res.begin(), '-');
+    return res;
+}
+
+bool BigInt::operator<(const BigInt& other) const { return (*this <=> other) < 0; }
+bool BigInt::operator<(long other) const { return (*this <=> other) < 0; }
+bool BigInt::operator<(size_t other) const { return (*this <=> other) < 0; }
+bool BigInt::operator<(int other) const { return (*this <=> other) < 0; }
+bool BigInt::operator<(long double other) const { return (*this <=> other) < 0; }
+bool BigInt::operator<=(const BigInt& other) const { return (*this <=> other) <= 0; }
+bool BigInt::operator<=(long other) const { return (*this <=> other) <= 0; }
+bool BigInt::operator<=(size_t other) const { return (*this <=> other) <= 0; }
+bool BigInt::operator<=(int other) const { return (*this <=> other) <= 0; }
+bool BigInt::operator<=(long double other) const { return (*this <=> other) <= 0; }
+bool BigInt::operator>(const BigInt& other) const { return (*this <=> other) > 0; }
+bool BigInt::operator>(long other) const { return (*this <=> other) > 0; }
+bool BigInt::operator>(size_t other) const { return (*this <=> other) > 0; }
+bool BigInt::operator>(int other) const { return (*this <=> other) > 0; }
+bool BigInt::operator>(long double other) const { return (*this <=> other) > 0; }
+bool BigInt::operator>=(const BigInt& other) const { return (*this <=> other) >= 0; }
+bool BigInt::operator>=(long other) const { return (*this <=> other) >= 0; }
+bool BigInt::operator>=(size_t other) const { return (*this <=> other) >= 0; }
+bool BigInt::operator>=(int other) const { return (*this <=> other) >= 0; }
+bool BigInt::operator>=(long double other) const { return (*this <=> other) >= 0; }
+bool BigInt::operator==(const BigInt& other) const { return !(*this <=> other); }
+bool BigInt::operator==(long other) const { return !(*this <=> other); }
+bool BigInt::operator==(size_t other) const { return !(*this <=> other); }
+bool BigInt::operator==(int other) const { return !(*this <=> other); }
+bool BigInt::operator==(long double other) const { return (*this <=> other) == partial_ordering::equivalent; }
+bool BigInt::operator!=(const BigInt& other) const { return (*this <=> other); }
+bool BigInt::operator!=(long other) const { return (*this <=> other); }
+bool BigInt::operator!=(size_t other) const { return (*this <=> other); }
+bool BigInt::operator!=(int other) const { return (*this <=> other); }
+bool BigInt::operator!=(long double other) const { return (*this <=> other) != partial_ordering::equivalent; }
+
+int operator<=>(size_t a, const BigInt& b) { return -(b <=> a); }
+
+int operator<=>(int a, const BigInt& b) { return -(b <=> a); }
+
+int operator<=>(long a, const BigInt& b) { return -(b <=> a); }
+
+std::partial_ordering operator<=>(long double a, const BigInt& b) {
+    auto res = b <=> a;
+    if (res == partial_ordering::unordered || res == partial_ordering::equivalent) return res;
+    if (res == partial_ordering::less) return partial_ordering::greater;
+    return partial_ordering::less;
+}
+
+bool operator<(long a, const BigInt& b) { return (a <=> b) < 0; }
+bool operator<=(long a, const BigInt& b) { return (a <=> b) <= 0; }
+bool operator>(long a, const BigInt& b) { return (a <=> b) > 0; }
+bool operator>=(long a, const BigInt& b) { return (a <=> b) >= 0; }
+bool operator==(long a, const BigInt& b) { return (a <=> b) == 0; }
+bool operator!=(long a, const BigInt& b) { return (a <=> b) != 0; }
+
+bool operator<(size_t a, const BigInt& b) { return (a <=> b) < 0; }
+bool operator<=(size_t a, const BigInt& b) { return (a <=> b) <= 0; }
+bool operator>(size_t a, const BigInt& b) { return (a <=> b) > 0; }
+bool operator>=(size_t a, const BigInt& b) { return (a <=> b) >= 0; }
+bool operator==(size_t a, const BigInt& b) { return (a <=> b) == 0; }
+bool operator!=(size_t a, const BigInt& b) { return (a <=> b) != 0; }
+
+bool operator<(int a, const BigInt& b) { return (a <=> b) < 0; }
+bool operator<=(int a, const BigInt& b) { return (a <=> b) <= 0; }
+bool operator>(int a, const BigInt& b) { return (a <=> b) > 0; }
+bool operator>=(int a, const BigInt& b) { return (a <=> b) >= 0; }
+bool operator==(int a, const BigInt& b) { return (a <=> b) == 0; }
+bool operator!=(int a, const BigInt& b) { return (a <=> b) != 0; }
+
+bool operator<(long double a, const BigInt& b) { return (a <=> b) < 0; }
+bool operator<=(long double a, const BigInt& b) { return (a <=> b) <= 0; }
+bool operator>(long double a, const BigInt& b) { return (a <=> b) > 0; }
+bool operator>=(long double a, const BigInt& b) { return (a <=> b) >= 0; }
+bool operator==(long double a, const BigInt& b) { return (a <=> b) == 0; }
+bool operator!=(long double a, const BigInt& b) { return (a <=> b) != 0; }
+
+ostream& operator<<(ostream& out, const BigInt& a) {
+    a.WriteRawReprToStream(out);
+    return out;
+}
+
+std::string BigInt::RawRepr() const {
+    stringstream ss;
+    WriteRawReprToStream(ss);
+    return ss.str();
+}
+
+std::string to_string(const BigInt& a) { return a.RawRepr(); }
+}  // namespace dinterp
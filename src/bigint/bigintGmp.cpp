@@ -0,0 +1,434 @@
+#include "dinterp/bigint.h"
+
+#include <gmp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <compare>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+using namespace std;
+
+// BigInt on top of GMP's mpz_t, selected with -DDINTERP_BIGINT_BACKEND=gmp. Semantics follow bigint.cpp exactly:
+// division rounds towards negative infinity, conversions from floating point truncate, etc.
+
+namespace dinterp {
+
+static void assert_base_ge2(size_t base) {
+    if (!base || base == 1) throw std::invalid_argument("base cannot be 0 or 1");
+}
+
+static int Sign(int comparison) { return (comparison > 0) - (comparison < 0); }
+
+// mpz_get_str/mpz_set_str use 0-9a-z up to base 36 and 0-9A-Za-z for bases 37 to 62
+static constexpr size_t MAX_GMP_STR_BASE = 62;
+
+static char GmpDigitChar(size_t digit, size_t base) {
+    if (digit < 10) return '0' + digit;
+    if (base <= 36) return 'a' + digit - 10;
+    if (digit < 36) return 'A' + digit - 10;
+    return 'a' + digit - 36;
+}
+
+static size_t GmpCharDigit(char c, size_t base) {
+    if ('0' <= c && c <= '9') return c - '0';
+    if (base <= 36 || ('A' <= c && c <= 'Z')) return (c | 0x20) - 'a' + 10;
+    return c - 'a' + 36;
+}
+
+// Magnitude of a number that fits into 64 bits
+static uint64_t Low64(mpz_srcptr x) {
+    uint64_t res = 0;
+    mpz_export(&res, nullptr, -1, sizeof(res), 0, 0, x);
+    return res;
+}
+
+// Divide and conquer, so that long inputs in unusual bases are converted with GMP's subquadratic multiplication
+static void SetFromDigits(mpz_ptr dest, const size_t* digits, size_t n, unsigned long base) {
+    if (n <= 16) {
+        mpz_set_ui(dest, 0);
+        for (size_t i = 0; i < n; i++) {
+            mpz_mul_ui(dest, dest, base);
+            mpz_add_ui(dest, dest, digits[i]);
+        }
+        return;
+    }
+    size_t low = n / 2;
+    mpz_t high, power;
+    mpz_inits(high, power, nullptr);
+    SetFromDigits(high, digits, n - low, base);
+    SetFromDigits(dest, digits + n - low, low, base);
+    mpz_ui_pow_ui(power, base, low);
+    mpz_addmul(dest, high, power);
+    mpz_clears(high, power, nullptr);
+}
+
+static void SetFromBigEndianRepr(mpz_ptr dest, const std::vector<size_t>& bigEndianRepr, size_t base) {
+    assert_base_ge2(base);
+    if (base > (1ul << 32)) throw std::invalid_argument("base was > 2**32");
+    size_t n = bigEndianRepr.size();
+    for (size_t i = 0; i < n; i++) {
+        size_t cur = bigEndianRepr[i];
+        if (cur >= base)
+            throw std::invalid_argument("bigEndianRepr[" + to_string(i) + "] >= base (" + to_string(cur) +
+                                        " >= " + to_string(base) + ")");
+    }
+    if (base > MAX_GMP_STR_BASE) {
+        SetFromDigits(dest, bigEndianRepr.data(), n, base);
+        return;
+    }
+    if (!n) {
+        mpz_set_ui(dest, 0);
+        return;
+    }
+    string digits(n, '0');
+    for (size_t i = 0; i < n; i++) digits[i] = GmpDigitChar(bigEndianRepr[i], base);
+    mpz_set_str(dest, digits.c_str(), static_cast<int>(base));
+}
+
+BigInt::BigInt() { mpz_init(value); }
+
+BigInt::BigInt(long val) { mpz_init_set_si(value, val); }
+
+BigInt::BigInt(size_t val) { mpz_init_set_ui(value, val); }
+
+BigInt::BigInt(int val) { mpz_init_set_si(value, val); }
+
+BigInt::BigInt(const BigInt& other) { mpz_init_set(value, other.value); }
+
+BigInt::BigInt(BigInt&& other) noexcept : BigInt() { mpz_swap(value, other.value); }
+
+BigInt& BigInt::operator=(const BigInt& other) {
+    mpz_set(value, other.value);
+    return *this;
+}
+
+BigInt& BigInt::operator=(BigInt&& other) noexcept {
+    mpz_swap(value, other.value);
+    return *this;
+}
+
+BigInt::~BigInt() { mpz_clear(value); }
+
+BigInt::BigInt(const std::string& repr, size_t base) : BigInt() {
+    assert_base_ge2(base);
+    size_t n = repr.size();
+    vector<size_t> bigEndianRepr(n);
+    if (repr.empty()) return;
+    bool minus = false;
+    if (repr[0] == '-') minus = true;
+    for (size_t i = minus; i < n; i++) {
+        char cur = repr[i];
+        if ('0' <= cur && cur <= '9')
+            bigEndianRepr[i] = cur - '0';
+        else if ('a' <= cur && cur <= 'z')
+            bigEndianRepr[i] = cur - 'a' + 10;
+        else if ('A' <= cur && cur <= 'Z')
+            bigEndianRepr[i] = cur - 'A' + 10;
+        else
+            throw std::invalid_argument("repr[" + to_string(i) + "] is not an alphanumeric character ('" +
+                                        string(1, cur) + "')");
+    }
+    SetFromBigEndianRepr(value, bigEndianRepr, base);
+    if (minus) mpz_neg(value, value);
+}
+
+BigInt::BigInt(const std::vector<size_t>& bigEndianRepr, size_t base) : BigInt() {
+    SetFromBigEndianRepr(value, bigEndianRepr, base);
+}
+
+BigInt::BigInt(long double val) : BigInt() {
+    if (isnan(val) || isinf(val)) return;
+    int exp;
+    long double frac = frexpl(fabsl(val), &exp);  // |val| == frac * 2**exp, frac is in [0.5, 1)
+    if (exp <= 0) return;
+    uint64_t mantissa = static_cast<uint64_t>(ldexpl(frac, 64));
+    mpz_import(value, 1, -1, sizeof(mantissa), 0, 0, &mantissa);
+    if (exp >= 64)
+        mpz_mul_2exp(value, value, exp - 64);
+    else
+        mpz_tdiv_q_2exp(value, value, 64 - exp);
+    if (val < 0) mpz_neg(value, value);
+}
+
+BigInt& BigInt::operator=(long val) {
+    mpz_set_si(value, val);
+    return *this;
+}
+
+BigInt& BigInt::operator=(size_t val) {
+    mpz_set_ui(value, val);
+    return *this;
+}
+
+std::vector<size_t> BigInt::Repr(size_t base) const {
+    assert_base_ge2(base);
+    vector<size_t> res;
+    if (base <= MAX_GMP_STR_BASE) {
+        string digits(mpz_sizeinbase(value, static_cast<int>(base)) + 2, '\0');
+        mpz_get_str(digits.data(), static_cast<int>(base), value);
+        for (char c : digits) {
+            if (!c) break;
+            if (c != '-') res.push_back(GmpCharDigit(c, base));
+        }
+        return res;
+    }
+    BigInt cur;
+    mpz_abs(cur.value, value);
+    do {
+        res.push_back(mpz_tdiv_q_ui(cur.value, cur.value, base));
+    } while (mpz_sgn(cur.value));
+    reverse(res.begin(), res.end());
+    return res;
+}
+
+BigInt& BigInt::operator+=(const BigInt& other) {
+    mpz_add(value, value, other.value);
+    return *this;
+}
+
+BigInt BigInt::operator+(const BigInt& other) const {
+    BigInt res;
+    mpz_add(res.value, value, other.value);
+    return res;
+}
+
+BigInt& BigInt::operator-=(const BigInt& other) {
+    mpz_sub(value, value, other.value);
+    return *this;
+}
+
+BigInt BigInt::operator-(const BigInt& other) const {
+    BigInt res;
+    mpz_sub(res.value, value, other.value);
+    return res;
+}
+
+// Only remembered: mpz_mul has no parallel mode
+static atomic<size_t> mulThreads = 1;
+
+void BigInt::SetMulThreads(size_t threads) { mulThreads.store(max<size_t>(threads, 1), memory_order_relaxed); }
+
+size_t BigInt::MulThreads() { return mulThreads.load(memory_order_relaxed); }
+
+BigInt& BigInt::operator*=(const BigInt& other) {
+    mpz_mul(value, value, other.value);
+    return *this;
+}
+
+BigInt BigInt::operator*(const BigInt& other) const {
+    BigInt res;
+    mpz_mul(res.value, value, other.value);
+    return res;
+}
+
+BigInt& BigInt::operator/=(const BigInt& other) {
+    if (!other) throw ZeroDivisionException();
+    mpz_fdiv_q(value, value, other.value);
+    return *this;
+}
+
+BigInt BigInt::operator/(const BigInt& other) const {
+    if (!other) throw ZeroDivisionException();
+    BigInt res;
+    mpz_fdiv_q(res.value, value, other.value);
+    return res;
+}
+
+BigInt& BigInt::operator%=(const BigInt& other) {
+    if (!other) throw ZeroDivisionException();
+    mpz_fdiv_r(value, value, other.value);
+    return *this;
+}
+
+BigInt BigInt::operator%(const BigInt& other) const {
+    if (!other) throw ZeroDivisionException();
+    BigInt res;
+    mpz_fdiv_r(res.value, value, other.value);
+    return res;
+}
+
+optional<BigInt> BigInt::DivLeaveMod(const BigInt& other) {
+    if (!other) return {};
+    BigInt quot;
+    mpz_fdiv_qr(quot.value, value, value, other.value);
+    return quot;
+}
+
+std::optional<std::pair<BigInt, BigInt>> BigInt::DivMod(const BigInt& other) const {
+    if (!other) return {};
+    BigInt quot, rem;
+    mpz_fdiv_qr(quot.value, rem.value, value, other.value);
+    return {{move(quot), move(rem)}};
+}
+
+BigInt& BigInt::operator<<=(size_t shift) {
+    mpz_mul_2exp(value, value, shift);
+    return *this;
+}
+
+BigInt BigInt::operator<<(size_t shift) const {
+    BigInt res;
+    mpz_mul_2exp(res.value, value, shift);
+    return res;
+}
+
+BigInt& BigInt::operator>>=(size_t shift) {
+    mpz_fdiv_q_2exp(value, value, shift);
+    return *this;
+}
+
+BigInt BigInt::operator>>(size_t shift) const {
+    BigInt res;
+    mpz_fdiv_q_2exp(res.value, value, shift);
+    return res;
+}
+
+BigInt BigInt::operator&(const BigInt& other) const {
+    BigInt res;
+    mpz_and(res.value, value, other.value);
+    return res;
+}
+
+BigInt BigInt::operator|(const BigInt& other) const {
+    BigInt res;
+    mpz_ior(res.value, value, other.value);
+    return res;
+}
+
+BigInt BigInt::operator^(const BigInt& other) const {
+    BigInt res;
+    mpz_xor(res.value, value, other.value);
+    return res;
+}
+
+optional<BigInt> BigInt::Pow(const BigInt& exponent) const {
+    if (exponent.IsNegative()) return {};
+    BigInt res;
+    if (mpz_fits_ulong_p(exponent.value)) {
+        mpz_pow_ui(res.value, value, mpz_get_ui(exponent.value));
+        return res;
+    }
+    // only 0, 1 and -1 have representable powers this large
+    if (mpz_cmpabs_ui(value, 1) > 0) throw std::length_error("BigInt::Pow: the result does not fit into memory");
+    if (IsNegative() && mpz_even_p(exponent.value)) return BigInt(1);
+    return *this;
+}
+
+optional<BigInt> BigInt::ModPow(const BigInt& exponent, const BigInt& modulus) const {
+    if (exponent.IsNegative() || !modulus) return {};
+    BigInt res;
+    mpz_powm(res.value, value, exponent.value, modulus.value);  // in [0, |modulus|)
+    if (modulus.IsNegative() && res) res += modulus;              // the remainder has the sign of the divisor
+    return res;
+}
+
+BigInt BigInt::Gcd(const BigInt& other) const {
+    BigInt res;
+    mpz_gcd(res.value, value, other.value);
+    return res;
+}
+
+optional<BigInt> BigInt::ISqrt() const {
+    if (IsNegative()) return {};
+    BigInt res;
+    mpz_sqrt(res.value, value);
+    return res;
+}
+
+BigInt BigInt::operator-() const {
+    BigInt res;
+    mpz_neg(res.value, value);
+    return res;
+}
+
+BigInt& BigInt::Negate() {
+    mpz_neg(value, value);
+    return *this;
+}
+
+BigInt& BigInt::operator++() {
+    mpz_add_ui(value, value, 1);
+    return *this;
+}
+
+BigInt BigInt::operator++(int) {
+    BigInt res = *this;
+    ++*this;
+    return res;
+}
+
+BigInt& BigInt::operator--() {
+    mpz_sub_ui(value, value, 1);
+    return *this;
+}
+
+BigInt BigInt::operator--(int) {
+    BigInt res = *this;
+    --*this;
+    return res;
+}
+
+int BigInt::operator<=>(const BigInt& other) const { return Sign(mpz_cmp(value, other.value)); }
+int BigInt::operator<=>(long other) const { return Sign(mpz_cmp_si(value, other)); }
+int BigInt::operator<=>(size_t other) const { return Sign(mpz_cmp_ui(value, other)); }
+int BigInt::operator<=>(int other) const { return Sign(mpz_cmp_si(value, other)); }
+
+std::partial_ordering BigInt::operator<=>(long double other) const {
+    if (isnan(other)) return partial_ordering::unordered;
+    if (isinf(other)) {
+        if (other < 0) return partial_ordering::greater;
+        return partial_ordering::less;
+    }
+    long double whole = truncl(other);
+    int comp = *this <=> BigInt(whole);
+    if (comp < 0) return partial_ordering::less;
+    if (comp > 0) return partial_ordering::greater;
+    long double frac = other - whole;  // exact
+    if (frac > 0) return partial_ordering::less;
+    if (frac < 0) return partial_ordering::greater;
+    return partial_ordering::equivalent;
+}
+
+long BigInt::ClampToLong() const {
+    if (mpz_fits_slong_p(value)) return mpz_get_si(value);
+    if (IsNegative()) return numeric_limits<long>::min();
+    return numeric_limits<long>::max();
+}
+
+long double BigInt::ToFloat() const {
+    if (!*this) return 0.0;
+    size_t bits = SignificantBits();
+    if (bits > static_cast<size_t>(numeric_limits<long double>::max_exponent))
+        return IsNegative() ? -INFINITY : INFINITY;
+    // like the in-tree implementation, keep the 64 most significant bits and truncate the rest
+    size_t dropped = bits > 64 ? bits - 64 : 0;
+    BigInt top;
+    mpz_tdiv_q_2exp(top.value, value, dropped);
+    long double res = ldexpl(static_cast<long double>(Low64(top.value)), static_cast<int>(dropped));
+    return IsNegative() ? -res : res;
+}
+
+BigInt::operator bool() const { return mpz_sgn(value); }
+
+bool BigInt::IsNegative() const { return mpz_sgn(value) < 0; }
+
+size_t BigInt::SignificantBits() const { return mpz_sgn(value) ? mpz_sizeinbase(value, 2) : 0; }
+
+void BigInt::WriteRawReprToStream(ostream& out) const {
+    // the same chunks as the in-tree representation: 32 bits each, least significant first
+    vector<uint32_t> chunks(max<size_t>(1, (SignificantBits() + 31) / 32));
+    mpz_export(chunks.data(), nullptr, -1, sizeof(uint32_t), 0, 0, value);
+    out << "BigInt( { ";
+    bool first = true;
+    for (uint32_t i : chunks) {
+        if (!first) out << ", ";
+        first = false;
+        out << i;
+    }
+    out << " }, sign = " << IsNegative() << " }";
+}
+}  // namespace dinterp
@@ -6,6 +6,9 @@
 #include <stdexcept>
 #include <string>
 #include <vector>
+#ifdef DINTERP_BIGINT_GMP
+#include <gmp.h>
+#endif
 
 namespace dinterp {
 
@@ -15,13 +18,20 @@ public:
     ~ZeroDivisionException() override = default;
 };
 
+// The representation depends on the DINTERP_BIGINT_BACKEND CMake option: the self-contained implementation
+// (bigint.cpp) by default, or an mpz_t from GMP (bigintGmp.cpp). The public interface is the same.
 class BigInt {
 private:
+#ifdef DINTERP_BIGINT_GMP
+    mpz_t value;
+#else
     std::vector<std::uint32_t> v;
     bool sign;
     void initBigEndianRepr(const std::vector<size_t>& bigEndianRepr, size_t base);
     void normalize();
     BigInt(const std::vector<std::uint32_t>& v, bool sign);
+    BigInt bitwise(const BigInt& other, std::uint32_t (*op)(std::uint32_t, std::uint32_t)) const;
+#endif
 
 public:
     BigInt(long val);
@@ -30,13 +40,21 @@ public:
     BigInt();
     BigInt(const std::string& repr, size_t base);
     BigInt(const std::vector<size_t>& bigEndianRepr, size_t base);
+#ifdef DINTERP_BIGINT_GMP
+    BigInt(const BigInt& other);
+    BigInt(BigInt&& other) noexcept;
+    BigInt& operator=(const BigInt& other);
+    BigInt& operator=(BigInt&& other) noexcept;
+    ~BigInt();
+#else
     BigInt(const BigInt& other) = default;
     BigInt(BigInt&& other) = default;
+    BigInt& operator=(const BigInt& other) = default;
+    BigInt& operator=(BigInt&& other) = default;
+#endif
     explicit BigInt(long double val);
     BigInt& operator=(long val);
     BigInt& operator=(size_t val);
-    BigInt& operator=(const BigInt& other) = default;
-    BigInt& operator=(BigInt&& other) = default;
     std::vector<size_t> Repr(size_t base) const;
     std::string ToString(size_t base = 10) const;
     BigInt& operator+=(const BigInt& other);
@@ -45,6 +63,10 @@ public:
     BigInt operator-(const BigInt& other) const;
     BigInt& operator*=(const BigInt& other);
     BigInt operator*(const BigInt& other) const;
+    // Multiplications of huge numbers may use up to this many threads (default 1, the minimum); the product does not
+    // depend on it. The GMP backend always multiplies on the calling thread.
+    static void SetMulThreads(size_t threads);
+    static size_t MulThreads();
     BigInt& operator/=(const BigInt& other);
     BigInt operator/(const BigInt& other) const;
     BigInt& operator%=(const BigInt& other);
@@ -57,6 +79,20 @@ public:
     BigInt operator--(int);
     std::optional<std::pair<BigInt, BigInt>> DivMod(const BigInt& other) const;
     std::optional<BigInt> DivLeaveMod(const BigInt& other);
+    // Shifts are arithmetic: x >> n == floor(x / 2**n)
+    BigInt& operator<<=(size_t shift);
+    BigInt operator<<(size_t shift) const;
+    BigInt& operator>>=(size_t shift);
+    BigInt operator>>(size_t shift) const;
+    // Bitwise operators treat negative numbers as infinite two's complement sequences
+    BigInt operator&(const BigInt& other) const;
+    BigInt operator|(const BigInt& other) const;
+    BigInt operator^(const BigInt& other) const;
+    std::optional<BigInt> Pow(const BigInt& exponent) const;  // {} if exponent < 0
+    // (this ** exponent) % modulus; {} if exponent < 0 or modulus == 0
+    std::optional<BigInt> ModPow(const BigInt& exponent, const BigInt& modulus) const;
+    BigInt Gcd(const BigInt& other) const;  // non-negative; Gcd(0, 0) == 0
+    std::optional<BigInt> ISqrt() const;    // floor(sqrt(this)); {} if this < 0
     int operator<=>(const BigInt& other) const;
     int operator<=>(long other) const;
     int operator<=>(size_t other) const;
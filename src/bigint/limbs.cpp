@@ -0,0 +1,272 @@
+#include "limbs.h"
+
+#include <cstdint>
+#include <vector>
+#if defined(__x86_64__) && defined(__GNUC__)
+#define DINTERP_LIMBS_X86
+#include <immintrin.h>
+#endif
+using namespace std;
+
+namespace dinterp {
+namespace limbs {
+
+/*
+ * The vector kernels add whole blocks of limbs at once and then fix up the carries with a carry-lookahead computed on
+ * bitmasks: a lane *generates* a carry if its sum wrapped around, and *propagates* an incoming one if its sum is all
+ * ones (the two never happen together). With G and P as lane bitmasks,
+ *     C = ((G << 1) + P + carry_in) ^ P
+ * has a bit set for every lane that receives a carry, and the carry out of the block right above the last lane.
+ * Subtraction is the same with borrows: a lane generates one if a < b and propagates one if a == b.
+ *
+ * Multiplication by a limb computes 64-bit products p[i] = a[i] * b (+ dest[i]), so the result is
+ *     lo(p[i]) + hi(p[i - 1])
+ * in every lane, which is again a block addition.
+ */
+
+static uint32_t AddScalar(uint32_t* dest, const uint32_t* a, const uint32_t* b, size_t n, uint32_t carry) {
+    uint64_t buf = carry;
+    for (size_t i = 0; i < n; i++) {
+        buf += static_cast<uint64_t>(a[i]) + b[i];
+        dest[i] = static_cast<uint32_t>(buf);
+        buf >>= 32;
+    }
+    return static_cast<uint32_t>(buf);
+}
+
+static uint32_t SubScalar(uint32_t* dest, const uint32_t* a, const uint32_t* b, size_t n, uint32_t borrow) {
+    for (size_t i = 0; i < n; i++) {
+        uint64_t sub = static_cast<uint64_t>(b[i]) + borrow;
+        uint32_t ai = a[i];
+        dest[i] = static_cast<uint32_t>(ai - sub);
+        borrow = ai < sub;
+    }
+    return borrow;
+}
+
+static uint32_t MulScalar(uint32_t* dest, const uint32_t* a, size_t n, uint32_t b, uint32_t carry) {
+    uint64_t buf = carry;
+    for (size_t i = 0; i < n; i++) {
+        buf += static_cast<uint64_t>(a[i]) * b;
+        dest[i] = static_cast<uint32_t>(buf);
+        buf >>= 32;
+    }
+    return static_cast<uint32_t>(buf);
+}
+
+static uint32_t AddMulScalar(uint32_t* dest, const uint32_t* a, size_t n, uint32_t b, uint32_t carry) {
+    uint64_t buf = carry;
+    for (size_t i = 0; i < n; i++) {
+        buf += static_cast<uint64_t>(a[i]) * b + dest[i];
+        dest[i] = static_cast<uint32_t>(buf);
+        buf >>= 32;
+    }
+    return static_cast<uint32_t>(buf);
+}
+
+static const Kernels SCALAR = {"scalar", AddScalar, SubScalar, MulScalar, AddMulScalar};
+
+#ifdef DINTERP_LIMBS_X86
+
+#define AVX2 __attribute__((target("avx2")))
+#define AVX512 __attribute__((target("avx512f")))
+
+// x + y + carry in 8 lanes
+AVX2 static inline __m256i AddLanesAvx2(__m256i x, __m256i y, uint32_t& carry) {
+    const __m256i bias = _mm256_set1_epi32(INT32_MIN), ones = _mm256_set1_epi32(-1);
+    const __m256i lanebits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    __m256i s = _mm256_add_epi32(x, y);
+    // unsigned s < x
+    __m256i wrapped = _mm256_cmpgt_epi32(_mm256_xor_si256(x, bias), _mm256_xor_si256(s, bias));
+    uint32_t g = _mm256_movemask_ps(_mm256_castsi256_ps(wrapped));
+    uint32_t p = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(s, ones)));
+    uint32_t c = ((g << 1) + p + carry) ^ p;
+    carry = c >> 8;
+    __m256i receives = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(c), lanebits), lanebits);
+    return _mm256_sub_epi32(s, receives);
+}
+
+AVX2 static uint32_t AddAvx2(uint32_t* dest, const uint32_t* a, const uint32_t* b, size_t n, uint32_t carry) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), AddLanesAvx2(va, vb, carry));
+    }
+    return AddScalar(dest + i, a + i, b + i, n - i, carry);
+}
+
+AVX2 static uint32_t SubAvx2(uint32_t* dest, const uint32_t* a, const uint32_t* b, size_t n, uint32_t borrow) {
+    const __m256i bias = _mm256_set1_epi32(INT32_MIN);
+    const __m256i lanebits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i d = _mm256_sub_epi32(va, vb);
+        // unsigned a < b
+        __m256i below = _mm256_cmpgt_epi32(_mm256_xor_si256(vb, bias), _mm256_xor_si256(va, bias));
+        uint32_t g = _mm256_movemask_ps(_mm256_castsi256_ps(below));
+        uint32_t p = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, vb)));
+        uint32_t c = ((g << 1) + p + borrow) ^ p;
+        borrow = c >> 8;
+        __m256i receives = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(c), lanebits), lanebits);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), _mm256_add_epi32(d, receives));
+    }
+    return SubScalar(dest + i, a + i, b + i, n - i, borrow);
+}
+
+template <bool ACCUMULATE>
+AVX2 static uint32_t MulAvx2(uint32_t* dest, const uint32_t* a, size_t n, uint32_t b, uint32_t carry) {
+    const __m256i vb = _mm256_set1_epi64x(b), low32 = _mm256_set1_epi64x(0xFFFFFFFFu);
+    // lane 2k takes lane 2k - 1 of the odd products; lane 0 is replaced with the previous block's high half
+    const __m256i prevOdd = _mm256_setr_epi32(7, 1, 1, 3, 3, 5, 5, 7);
+    uint32_t hi = carry, addCarry = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i even = _mm256_mul_epu32(va, vb);                        // a[0] * b, a[2] * b, ... as 64-bit
+        __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(va, 32), vb);  // a[1] * b, a[3] * b, ...
+        if constexpr (ACCUMULATE) {
+            __m256i vd = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dest + i));
+            even = _mm256_add_epi64(even, _mm256_and_si256(vd, low32));
+            odd = _mm256_add_epi64(odd, _mm256_srli_epi64(vd, 32));
+        }
+        __m256i lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0b10101010);
+        __m256i his = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(odd, prevOdd), even, 0b10101010);
+        his = _mm256_blend_epi32(his, _mm256_castsi128_si256(_mm_cvtsi32_si128(static_cast<int>(hi))), 1);
+        hi = static_cast<uint32_t>(_mm256_extract_epi32(odd, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), AddLanesAvx2(lo, his, addCarry));
+    }
+    // the pending high half and carry always fit into a limb together
+    if constexpr (ACCUMULATE)
+        return AddMulScalar(dest + i, a + i, n - i, b, hi + addCarry);
+    else
+        return MulScalar(dest + i, a + i, n - i, b, hi + addCarry);
+}
+
+AVX2 static uint32_t MulAvx2Plain(uint32_t* dest, const uint32_t* a, size_t n, uint32_t b, uint32_t carry) {
+    return MulAvx2<false>(dest, a, n, b, carry);
+}
+
+AVX2 static uint32_t AddMulAvx2(uint32_t* dest, const uint32_t* a, size_t n, uint32_t b, uint32_t carry) {
+    return MulAvx2<true>(dest, a, n, b, carry);
+}
+
+// x + y + carry in 16 lanes
+AVX512 static inline __m512i AddLanesAvx512(__m512i x, __m512i y, uint32_t& carry) {
+    const __m512i ones = _mm512_set1_epi32(-1);
+    __m512i s = _mm512_add_epi32(x, y);
+    uint32_t g = _mm512_cmplt_epu32_mask(s, x);
+    uint32_t p = _mm512_cmpeq_epi32_mask(s, ones);
+    uint32_t c = ((g << 1) + p + carry) ^ p;
+    carry = c >> 16;
+    return _mm512_mask_sub_epi32(s, static_cast<__mmask16>(c), s, ones);
+}
+
+AVX512 static uint32_t AddAvx512(uint32_t* dest, const uint32_t* a, const uint32_t* b, size_t n, uint32_t carry) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_si512(dest + i, AddLanesAvx512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i), carry));
+    return AddScalar(dest + i, a + i, b + i, n - i, carry);
+}
+
+AVX512 static uint32_t SubAvx512(uint32_t* dest, const uint32_t* a, const uint32_t* b, size_t n, uint32_t borrow) {
+    const __m512i ones = _mm512_set1_epi32(-1);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i va = _mm512_loadu_si512(a + i), vb = _mm512_loadu_si512(b + i);
+        __m512i d = _mm512_sub_epi32(va, vb);
+        uint32_t g = _mm512_cmplt_epu32_mask(va, vb);
+        uint32_t p = _mm512_cmpeq_epi32_mask(va, vb);
+        uint32_t c = ((g << 1) + p + borrow) ^ p;
+        borrow = c >> 16;
+        _mm512_storeu_si512(dest + i, _mm512_mask_add_epi32(d, static_cast<__mmask16>(c), d, ones));
+    }
+    return SubScalar(dest + i, a + i, b + i, n - i, borrow);
+}
+
+template <bool ACCUMULATE>
+AVX512 static uint32_t MulAvx512(uint32_t* dest, const uint32_t* a, size_t n, uint32_t b, uint32_t carry) {
+    const __m512i vb = _mm512_set1_epi64(b), low32 = _mm512_set1_epi64(0xFFFFFFFFu);
+    const __m512i prevOdd = _mm512_setr_epi32(15, 1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13, 13, 15);
+    const __mmask16 oddLanes = 0xAAAA;
+    uint32_t hi = carry, addCarry = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i even = _mm512_mul_epu32(va, vb);
+        __m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(va, 32), vb);
+        if constexpr (ACCUMULATE) {
+            __m512i vd = _mm512_loadu_si512(dest + i);
+            even = _mm512_add_epi64(even, _mm512_and_si512(vd, low32));
+            odd = _mm512_add_epi64(odd, _mm512_srli_epi64(vd, 32));
+        }
+        __m512i lo = _mm512_mask_blend_epi32(oddLanes, even, _mm512_slli_epi64(odd, 32));
+        __m512i his = _mm512_mask_blend_epi32(oddLanes, _mm512_permutexvar_epi32(prevOdd, odd), even);
+        his = _mm512_mask_set1_epi32(his, 1, static_cast<int>(hi));
+        hi = static_cast<uint32_t>(_mm_extract_epi32(_mm512_extracti32x4_epi32(odd, 3), 3));
+        _mm512_storeu_si512(dest + i, AddLanesAvx512(lo, his, addCarry));
+    }
+    if constexpr (ACCUMULATE)
+        return AddMulScalar(dest + i, a + i, n - i, b, hi + addCarry);
+    else
+        return MulScalar(dest + i, a + i, n - i, b, hi + addCarry);
+}
+
+AVX512 static uint32_t MulAvx512Plain(uint32_t* dest, const uint32_t* a, size_t n, uint32_t b, uint32_t carry) {
+    return MulAvx512<false>(dest, a, n, b, carry);
+}
+
+AVX512 static uint32_t AddMulAvx512(uint32_t* dest, const uint32_t* a, size_t n, uint32_t b, uint32_t carry) {
+    return MulAvx512<true>(dest, a, n, b, carry);
+}
+
+static const Kernels AVX2_KERNELS = {"avx2", AddAvx2, SubAvx2, MulAvx2Plain, AddMulAvx2};
+static const Kernels AVX512_KERNELS = {"avx512", AddAvx512, SubAvx512, MulAvx512Plain, AddMulAvx512};
+
+#endif
+
+const vector<const Kernels*>& Available() {
+    static const vector<const Kernels*> available = [] {
+        vector<const Kernels*> res{&SCALAR};
+#ifdef DINTERP_LIMBS_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) res.push_back(&AVX2_KERNELS);
+        if (__builtin_cpu_supports("avx512f")) res.push_back(&AVX512_KERNELS);
+#endif
+        return res;
+    }();
+    return available;
+}
+
+// Shorter arrays are not worth an indirect call
+static constexpr size_t MIN_VECTOR_LIMBS = 16;
+
+static const Kernels& Best() {
+    static const Kernels& best = *Available().back();
+    return best;
+}
+
+uint32_t Add(uint32_t* dest, const uint32_t* a, const uint32_t* b, size_t n, uint32_t carry) {
+    if (n < MIN_VECTOR_LIMBS) return AddScalar(dest, a, b, n, carry);
+    return Best().add(dest, a, b, n, carry);
+}
+
+uint32_t Sub(uint32_t* dest, const uint32_t* a, const uint32_t* b, size_t n, uint32_t borrow) {
+    if (n < MIN_VECTOR_LIMBS) return SubScalar(dest, a, b, n, borrow);
+    return Best().sub(dest, a, b, n, borrow);
+}
+
+uint32_t Mul(uint32_t* dest, const uint32_t* a, size_t n, uint32_t b, uint32_t carry) {
+    if (n < MIN_VECTOR_LIMBS) return MulScalar(dest, a, n, b, carry);
+    return Best().mul(dest, a, n, b, carry);
+}
+
+uint32_t AddMul(uint32_t* dest, const uint32_t* a, size_t n, uint32_t b, uint32_t carry) {
+    if (n < MIN_VECTOR_LIMBS) return AddMulScalar(dest, a, n, b, carry);
+    return Best().addMul(dest, a, n, b, carry);
+}
+
+}  // namespace limbs
+}  // namespace dinterp
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dinterp {
+namespace limbs {
+
+/*
+ * Linear-time kernels over little-endian arrays of 32-bit limbs, the inner loops of BigInt's arithmetics.
+ * Each one has a portable scalar version and, on x86-64, AVX2 and AVX-512 versions; the widest one the CPU supports is
+ * chosen at runtime. All versions give identical results.
+ *
+ * `dest` may be the same array as `a` (but must not overlap it otherwise).
+ */
+
+// dest = a + b + carry; returns the carry out (0 or 1)
+std::uint32_t Add(std::uint32_t* dest, const std::uint32_t* a, const std::uint32_t* b, size_t n, std::uint32_t carry);
+// dest = a - b - borrow; returns the borrow out (0 or 1)
+std::uint32_t Sub(std::uint32_t* dest, const std::uint32_t* a, const std::uint32_t* b, size_t n, std::uint32_t borrow);
+// dest = a * b + carry; returns the high limb
+std::uint32_t Mul(std::uint32_t* dest, const std::uint32_t* a, size_t n, std::uint32_t b, std::uint32_t carry);
+// dest += a * b + carry; returns the high limb
+std::uint32_t AddMul(std::uint32_t* dest, const std::uint32_t* a, size_t n, std::uint32_t b, std::uint32_t carry);
+
+struct Kernels {
+    const char* name;
+    decltype(&Add) add;
+    decltype(&Sub) sub;
+    decltype(&Mul) mul;
+    decltype(&AddMul) addMul;
+};
+
+// Every set of kernels this CPU can run, from the scalar one to the widest; the functions above use the last one
+const std::vector<const Kernels*>& Available();
+
+}  // namespace limbs
+}  // namespace dinterp
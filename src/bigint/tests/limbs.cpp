@@ -0,0 +1,62 @@
+#include "limbs.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+using namespace std;
+using namespace dinterp;
+
+// Limb patterns that stress carry propagation: runs of all-ones and zeros between random limbs
+static vector<uint32_t> RandomLimbs(mt19937& rng, size_t n) {
+    vector<uint32_t> res(n);
+    for (auto& limb : res) {
+        switch (rng() % 4) {
+            case 0:
+                limb = 0;
+                break;
+            case 1:
+                limb = 0xFFFFFFFFu;
+                break;
+            default:
+                limb = rng();
+        }
+    }
+    return res;
+}
+
+TEST(Limbs, KernelsAgree) {
+    auto& available = limbs::Available();
+    ASSERT_STREQ(available[0]->name, "scalar");
+    const limbs::Kernels& scalar = *available[0];
+    mt19937 rng(6);
+    for (size_t k = 1; k < available.size(); k++) {
+        const limbs::Kernels& kernels = *available[k];
+        SCOPED_TRACE(kernels.name);
+        for (size_t n : {0, 1, 7, 8, 9, 15, 16, 17, 31, 32, 33, 100, 1000})
+            for (int rep = 0; rep < 20; rep++) {
+                auto a = RandomLimbs(rng, n), b = RandomLimbs(rng, n), d = RandomLimbs(rng, n);
+                uint32_t carry = rng() % 2, limb = rep % 3 ? rng() : 0xFFFFFFFFu;
+                vector<uint32_t> expected(n), actual(n);
+                EXPECT_EQ(kernels.add(actual.data(), a.data(), b.data(), n, carry),
+                          scalar.add(expected.data(), a.data(), b.data(), n, carry));
+                EXPECT_EQ(actual, expected);
+                EXPECT_EQ(kernels.sub(actual.data(), a.data(), b.data(), n, carry),
+                          scalar.sub(expected.data(), a.data(), b.data(), n, carry));
+                EXPECT_EQ(actual, expected);
+                EXPECT_EQ(kernels.mul(actual.data(), a.data(), n, limb, limb),
+                          scalar.mul(expected.data(), a.data(), n, limb, limb));
+                EXPECT_EQ(actual, expected);
+                expected = actual = d;
+                EXPECT_EQ(kernels.addMul(actual.data(), a.data(), n, limb, limb),
+                          scalar.addMul(expected.data(), a.data(), n, limb, limb));
+                EXPECT_EQ(actual, expected);
+                // in place
+                expected = actual = a;
+                EXPECT_EQ(kernels.add(actual.data(), actual.data(), b.data(), n, carry),
+                          scalar.add(expected.data(), expected.data(), b.data(), n, carry));
+                EXPECT_EQ(actual, expected);
+            }
+    }
+}
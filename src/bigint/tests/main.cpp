@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <cmath>
+#include <random>
 
 #include "arith_samples.h"
 #include "dinterp/bigint.h"
@@ -21,6 +22,27 @@ TEST(Repr, ConsStr) {
                                                       2863809288, 2821623568, 0, 0, 0}));
 }
 
+TEST(Repr, ToString) {
+    EXPECT_EQ(BigInt(0).ToString(16), "0");
+    EXPECT_EQ(BigInt(255).ToString(16), "FF");
+    EXPECT_EQ(BigInt(-255).ToString(2), "-11111111");
+    EXPECT_EQ((BigInt(1) << 70ul).ToString(8), "2" + string(23, '0'));
+    EXPECT_EQ(BigInt("-zz", 36).ToString(36), "-ZZ");
+    EXPECT_EQ(BigInt(vector<size_t>{1, 99, 0}, 100).Repr(100), (vector<size_t>{1, 99, 0}));
+    EXPECT_EQ(BigInt(-123456789l).Repr(1000), (vector<size_t>{123, 456, 789}));
+}
+
+TEST(Arith, IncDec) {
+    BigInt a = -1l;
+    EXPECT_EQ(a++, -1);
+    EXPECT_EQ(a, 0);
+    EXPECT_EQ(++a, 1);
+    EXPECT_EQ(a--, 1);
+    EXPECT_EQ(--a, -1);
+    a = 5ul;
+    EXPECT_EQ(a, 5);
+}
+
 TEST(Arith, Mul) {
     // (1x + 8)(2x + 3) = 2xx + 19x + 24
     BigInt a(vector<size_t>{1, 8}, 1ul << 32), b(vector<size_t>{2, 3}, 1ul << 32);
@@ -41,6 +63,162 @@ TEST(Arith, Fac100) {
                                   "915608941463976156518286253697920827223758251185210916864000000000000000000000000");
 }
 
+TEST(Arith, MulLarge) {
+    // operand sizes around and far above the schoolbook/Karatsuba threshold, balanced and unbalanced
+    mt19937_64 rng(42);
+    auto randomInt = [&rng](size_t chunks) {
+        vector<size_t> repr(chunks);
+        for (auto& chunk : repr) chunk = rng() & 0xFFFFFFFFu;
+        repr[0] |= 1;
+        return BigInt(repr, 1ul << 32);
+    };
+    for (size_t an : {1, 31, 32, 33, 64, 100, 257})
+        for (size_t bn : {1, 2, 31, 32, 33, 70, 300}) {
+            BigInt a = randomInt(an), b = randomInt(bn), c = randomInt(bn);
+            BigInt prod = a * b;
+            EXPECT_EQ(prod, b * a);
+            EXPECT_EQ(prod % b, 0);
+            EXPECT_EQ(prod / b, a);
+            EXPECT_EQ(a * (b + c), prod + a * c);
+            EXPECT_EQ(-a * b, -prod);
+        }
+    BigInt ones(vector<size_t>(200, 0xFFFFFFFFu), 1ul << 32);
+    BigInt square = ones * ones;  // (c - 1)^2 = c^2 - 2c + 1
+    BigInt c = ones + BigInt(1l);
+    EXPECT_EQ(square, c * c - c * BigInt(2l) + BigInt(1l));
+    BigInt acc = 1l;
+    acc *= ones;
+    acc *= ones;
+    EXPECT_EQ(acc, square);
+}
+
+TEST(Arith, MulThreads) {
+    mt19937_64 rng(7);
+    auto randomInt = [&rng](size_t chunks) {
+        vector<size_t> repr(chunks);
+        for (auto& chunk : repr) chunk = rng() & 0xFFFFFFFFu;
+        repr[0] |= 1;
+        return BigInt(repr, 1ul << 32);
+    };
+    // large enough for the parallel step to be taken a couple of levels deep, balanced and unbalanced
+    vector<pair<BigInt, BigInt>> operands = {{randomInt(20000), randomInt(20000)}, {randomInt(40000), randomInt(9000)}};
+    vector<BigInt> serial;
+    for (auto& [a, b] : operands) serial.push_back(a * b);
+    for (size_t threads : {2, 3, 8}) {
+        BigInt::SetMulThreads(threads);
+        EXPECT_EQ(BigInt::MulThreads(), threads);
+        for (size_t i = 0; i < operands.size(); i++) EXPECT_EQ(operands[i].first * operands[i].second, serial[i]);
+    }
+    BigInt::SetMulThreads(0);
+    EXPECT_EQ(BigInt::MulThreads(), 1);
+}
+
+static BigInt RandomBigInt(mt19937_64& rng, size_t chunks) {
+    vector<size_t> repr(chunks);
+    for (auto& chunk : repr) chunk = rng() & 0xFFFFFFFFu;
+    repr[0] |= 1;
+    BigInt res(repr, 1ul << 32);
+    if (rng() & 1) res.Negate();
+    return res;
+}
+
+TEST(NumberTheory, Shifts) {
+    EXPECT_EQ(BigInt(5) << 3ul, 40);
+    EXPECT_EQ(BigInt(-5) << 40ul, BigInt(-5l * (1l << 40)));
+    EXPECT_EQ(BigInt(40) >> 3ul, 5);
+    EXPECT_EQ(BigInt(-7) >> 1ul, -4);
+    EXPECT_EQ(BigInt(-8) >> 3ul, -1);
+    EXPECT_EQ(BigInt(-8) >> 1000ul, -1);
+    EXPECT_EQ(BigInt(8) >> 1000ul, 0);
+    mt19937_64 rng(1);
+    for (size_t shift : {0, 1, 31, 32, 33, 100}) {
+        BigInt a = RandomBigInt(rng, 7), p = BigInt(1) << shift;
+        EXPECT_EQ(a << shift, a * p);
+        EXPECT_EQ(a >> shift, a / p);
+    }
+}
+
+TEST(NumberTheory, Bitwise) {
+    for (long a : {0l, 1l, -1l, 6l, -6l, 0x123456789abl, -0x123456789abl})
+        for (long b : {0l, 3l, -3l, 0xf0f0f0f0f0l, -0xf0f0f0f0f0l}) {
+            EXPECT_EQ(BigInt(a) & BigInt(b), a & b);
+            EXPECT_EQ(BigInt(a) | BigInt(b), a | b);
+            EXPECT_EQ(BigInt(a) ^ BigInt(b), a ^ b);
+        }
+    mt19937_64 rng(2);
+    for (int i = 0; i < 20; i++) {
+        BigInt a = RandomBigInt(rng, 1 + rng() % 9), b = RandomBigInt(rng, 1 + rng() % 9);
+        EXPECT_EQ((a & b) + (a | b), a + b);
+        EXPECT_EQ(a ^ b, (a | b) - (a & b));
+        EXPECT_EQ(a ^ b ^ b, a);
+    }
+}
+
+TEST(NumberTheory, Pow) {
+    EXPECT_EQ(BigInt(3).Pow(BigInt(0)), 1);
+    EXPECT_EQ(BigInt(3).Pow(BigInt(5)), 243);
+    EXPECT_EQ(BigInt(-2).Pow(BigInt(63)), numeric_limits<long>::min());
+    EXPECT_EQ(BigInt(-1).Pow(BigInt("1" + string(50, '0'), 10) + BigInt(1)), -1);
+    EXPECT_FALSE(BigInt(2).Pow(BigInt(-1)));
+    BigInt expected = 1l, base = BigInt("123456789123456789", 10);
+    for (int i = 0; i < 77; i++) expected *= base;
+    EXPECT_EQ(base.Pow(BigInt(77)), expected);
+}
+
+TEST(NumberTheory, ModPow) {
+    EXPECT_EQ(BigInt(4).ModPow(BigInt(13), BigInt(497)), 445);
+    EXPECT_EQ(BigInt(-4).ModPow(BigInt(3), BigInt(10)), 6);
+    EXPECT_EQ(BigInt(2).ModPow(BigInt(0), BigInt(-3)), -2);
+    EXPECT_EQ(BigInt(2).ModPow(BigInt(10), BigInt(1)), 0);
+    EXPECT_FALSE(BigInt(2).ModPow(BigInt(-1), BigInt(7)));
+    EXPECT_FALSE(BigInt(2).ModPow(BigInt(1), BigInt(0)));
+    // Fermat's little theorem for the Mersenne prime 2**127 - 1
+    BigInt p = (BigInt(1) << 127ul) - BigInt(1);
+    EXPECT_EQ(BigInt("98765432109876543210", 10).ModPow(p - BigInt(1), p), 1);
+    mt19937_64 rng(3);
+    for (int i = 0; i < 10; i++) {
+        BigInt a = RandomBigInt(rng, 1 + rng() % 6), m = RandomBigInt(rng, 1 + rng() % 4);
+        BigInt e = BigInt(static_cast<long>(rng() % 40));
+        EXPECT_EQ(a.ModPow(e, m), *a.Pow(e) % m);
+    }
+}
+
+TEST(NumberTheory, Gcd) {
+    EXPECT_EQ(BigInt(0).Gcd(BigInt(0)), 0);
+    EXPECT_EQ(BigInt(12).Gcd(BigInt(-18)), 6);
+    EXPECT_EQ(BigInt(-7).Gcd(BigInt(0)), 7);
+    mt19937_64 rng(4);
+    for (int i = 0; i < 20; i++) {
+        BigInt g = RandomBigInt(rng, 1 + rng() % 5);
+        BigInt a = RandomBigInt(rng, 1 + rng() % 12), b = RandomBigInt(rng, 1 + rng() % 12);
+        BigInt expected = a, rest = b;
+        while (rest) {
+            expected %= rest;
+            swap(expected, rest);
+        }
+        if (expected.IsNegative()) expected.Negate();
+        BigInt actual = a.Gcd(b);
+        EXPECT_EQ(actual, expected);
+        EXPECT_EQ((a * g).Gcd(b * g), actual * (g.IsNegative() ? -g : g));
+    }
+}
+
+TEST(NumberTheory, ISqrt) {
+    EXPECT_FALSE(BigInt(-1).ISqrt());
+    EXPECT_EQ(BigInt(0).ISqrt(), 0);
+    EXPECT_EQ(BigInt(1).ISqrt(), 1);
+    EXPECT_EQ(BigInt(15).ISqrt(), 3);
+    EXPECT_EQ(BigInt(16).ISqrt(), 4);
+    mt19937_64 rng(5);
+    for (int i = 0; i < 20; i++) {
+        BigInt a = RandomBigInt(rng, 1 + rng() % 10);
+        if (a.IsNegative()) a.Negate();
+        BigInt r = *a.ISqrt();
+        EXPECT_LE(r * r, a);
+        EXPECT_GT((r + BigInt(1)) * (r + BigInt(1)), a);
+    }
+}
+
 TEST(Repr, Float) {
     EXPECT_EQ(BigInt(0.8l), 0);
     EXPECT_EQ(BigInt(-0.8l), 0);
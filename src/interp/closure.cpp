@@ -3,28 +3,35 @@
 #include "dinterp/interp/execution.h"
 #include "dinterp/interp/runtimeContext.h"
 #include "dinterp/interp/varScopes.h"
-#include "dinterp/syntax.h"
 using namespace std;
 
 namespace dinterp {
 namespace runtime {
 
-Closure::Closure(const interp::ScopeStack& values, const ast::ClosureDefinition& def)
-    : params(def.Params), initialScope(make_shared<interp::ScopeStack>()), code(def.Definition), funcType(def.Type) {
-    for (const string& name : def.CapturedExternals) initialScope->Declare(*values.Lookup(name));
+Closure::Closure(const interp::ScopeStack& values, const shared_ptr<const interp::LoweredCode>& code,
+                 interp::CodeIndex function)
+    : initialScope(make_shared<interp::ScopeStack>()), code(code), function(function) {
+    for (const string& name : code->Functions[function].CapturedExternals) initialScope->Declare(*values.Lookup(name));
 }
 
 shared_ptr<RuntimeValue> Closure::UserCall(interp::RuntimeContext& context,
                                            const vector<shared_ptr<RuntimeValue>>& args) const {
-    size_t n = params.size();
-    if (args.size() != n)
+    if (args.size() != code->Functions[function].Params.size())
         throw runtime_error("Wrong number arguments supplied to a user call (interpreter's validation is broken)");
-    auto scope = make_shared<interp::ScopeStack>(initialScope);
-    for (size_t i = 0; i < n; i++) scope->Declare(make_shared<interp::Variable>(params[i], args[i]));
-    interp::Executor exec(context, scope);
-    auto longBody = dynamic_pointer_cast<ast::LongFuncBody>(code);
-    if (longBody) {
-        exec.VisitBody(*longBody->funcBody);
+    return Run(context, initialScope, code, function, args);
+}
+
+shared_ptr<RuntimeValue> Closure::Run(interp::RuntimeContext& context, const shared_ptr<interp::ScopeStack>& outer,
+                                      const shared_ptr<const interp::LoweredCode>& code, interp::CodeIndex function,
+                                      const vector<shared_ptr<RuntimeValue>>& args) {
+    auto& func = code->Functions[function];
+    if (context.StepsLeft && !context.TakeStep(func.Pos)) return nullptr;
+    size_t n = func.Params.size();
+    auto scope = make_shared<interp::ScopeStack>(outer);
+    for (size_t i = 0; i < n; i++) scope->Declare(make_shared<interp::Variable>(func.Params[i], args[i]));
+    interp::Executor exec(context, code, scope);
+    if (!func.ReturnsExpression) {
+        exec.Execute(func.Body);
         switch (context.State.StateKind()) {
             case interp::RuntimeState::Kind::Throwing:
                 return nullptr;
@@ -39,23 +46,24 @@ shared_ptr<RuntimeValue> Closure::UserCall(interp::RuntimeContext& context,
             }
         }
     }
-    dynamic_cast<ast::ShortFuncBody&>(*code).expressionToReturn->AcceptVisitor(exec);
-    if (context.State.IsThrowing()) return nullptr;
+    auto res = exec.Evaluate(func.Body);
 #ifdef DINTERP_DEBUG
     {
         auto kind = context.State.StateKind();
-        if (kind != interp::RuntimeState::Kind::Running)
+        if (kind != interp::RuntimeState::Kind::Running && kind != interp::RuntimeState::Kind::Throwing)
             throw runtime_error("After evaluation of a short-form function body, the state was " +
                                 to_string(static_cast<int>(kind)));
     }
 #endif
-    return exec.ExpressionValue();
+    if (!res) return nullptr;
+    if (context.MemoryLeft && !context.TakeMemory(*res, code->Nodes[func.Body].pos)) return nullptr;
+    return res;
 }
 
-shared_ptr<FuncType> Closure::FunctionType() const { return funcType; }
+shared_ptr<FuncType> Closure::FunctionType() const { return code->Functions[function].Type; }
 
 void Closure::DoPrintSelf(ostream& out, [[maybe_unused]] set<shared_ptr<const RuntimeValue>>& recGuard) const {
-    out << "<closure: " << funcType->Name() << ">";
+    out << "<closure: " << FunctionType()->Name() << ">";
 }
 
 }  // namespace runtime
@@ -0,0 +1,61 @@
+#include "dinterp/interp/evaluator.h"
+
+#include <algorithm>
+#include <exception>
+#include <sstream>
+
+#include "dinterp/interp/closure.h"
+#include "dinterp/interp/lowered.h"
+#include "dinterp/interp/runtimeContext.h"
+#include "dinterp/interp/varScopes.h"
+using namespace std;
+
+namespace dinterp {
+namespace interp {
+
+static constexpr size_t STEPS_PER_CALL = 100000;
+static constexpr size_t MEMORY_PER_CALL = 1 << 24;
+static constexpr size_t CALL_DEPTH = 256;
+static constexpr size_t TOTAL_STEPS = 10000000;
+
+BoundedEvaluator::BoundedEvaluator() : stepsLeft(TOTAL_STEPS) {}
+
+shared_ptr<runtime::RuntimeValue> BoundedEvaluator::Evaluate(
+    const ast::ClosureDefinition& closure, const vector<pair<string, shared_ptr<runtime::RuntimeValue>>>& captured,
+    const vector<shared_ptr<runtime::RuntimeValue>>& args) {
+    if (!stepsLeft) return nullptr;
+    // the closure cannot read input, since `input` is not a known value
+    istringstream input;
+    ostringstream output;
+    RuntimeContext context(input, output, CALL_DEPTH, 0);
+    size_t steps = min(STEPS_PER_CALL, stepsLeft);
+    context.StepsLeft = steps;
+    context.MemoryLeft = MEMORY_PER_CALL;
+    auto scope = make_shared<ScopeStack>();
+    vector<shared_ptr<Variable>> variables;
+    for (auto& [name, value] : captured) {
+        variables.push_back(make_shared<Variable>(name, value));
+        scope->Declare(variables.back());
+    }
+    shared_ptr<runtime::RuntimeValue> res;
+    try {
+        auto& [definition, code] = lowered[&closure];
+        if (!code) {
+            definition = closure.shared_from_this();
+            code = LoweredCode::FromClosure(closure);
+        }
+        res = runtime::Closure::Run(context, scope, code, code->Root, args);
+    } catch (const exception&) {
+        // such as running out of memory in a step that the budget does not bound: the runtime reports it if it happens
+        // there as well
+        res = nullptr;
+    }
+    stepsLeft -= steps - *context.StepsLeft;
+    if (!output.str().empty()) return nullptr;
+    for (size_t i = 0; i < captured.size(); i++)
+        if (variables[i]->Content() != captured[i].second) return nullptr;
+    return res;
+}
+
+}  // namespace interp
+}  // namespace dinterp
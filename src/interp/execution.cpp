@@ -2,89 +2,110 @@
 
 #include <algorithm>
 #include <memory>
+#include <sstream>
 #include <stdexcept>
+#include <utility>
 
 #include "dinterp/interp/closure.h"
 #include "dinterp/interp/runtimeContext.h"
-#include "dinterp/interp/unaryOpExec.h"
+#include "dinterp/interp/userCallable.h"
 #include "dinterp/locators/locator.h"
 #include "dinterp/runtime/derror.h"
+#include "dinterp/runtime/types.h"
 #include "dinterp/runtime/values.h"
 #include "dinterp/syntax.h"
-#include "dinterp/syntaxext/precomputed.h"
 using namespace std;
 
 namespace dinterp {
 namespace interp {
 
-Executor::Executor(RuntimeContext& context, const std::shared_ptr<ScopeStack>& scopes)
-    : context(context), scopes(scopes) {}
+using Op = LoweredCode::Op;
 
-const std::shared_ptr<runtime::RuntimeValue>& Executor::ExpressionValue() const {
-    if (!optExprValue) throw runtime_error("Accessed Executor::ExpressionValue(), but it was `nullptr`.");
-    return optExprValue;
-}
+Executor::Executor(RuntimeContext& context, const std::shared_ptr<const LoweredCode>& code,
+                   const std::shared_ptr<ScopeStack>& scopes)
+    : context(context), code(code), lowered(*code), scopes(scopes) {}
 
-optional<shared_ptr<runtime::RuntimeValue>> Executor::ExecuteExpressionInThis(const shared_ptr<ast::Expression>& expr) {
-    expr->AcceptVisitor(*this);
-    if (!context.State.IsRunning()) {
-        optExprValue.reset();
-        return {};
-    }
-    auto val = ExpressionValue();
-    optExprValue.reset();
-    return val;
+shared_ptr<runtime::RuntimeValue> Executor::Evaluate(CodeIndex expression) {
+    auto value = Compute(expression);
+    if (!context.State.IsRunning()) return nullptr;
+    if (!value) throw runtime_error("Evaluated an expression, but it left no value.");
+    return value;
 }
 
-void Executor::ExecuteOperators(const std::vector<std::shared_ptr<ast::Expression>>& operands,
-                                const std::vector<OperatorKind>& ops) {
+shared_ptr<runtime::RuntimeValue> Executor::ExecuteOperators(const Node& node) {
+    using OperatorKind = LoweredCode::ArithmeticOperator;
     const char* const OPNAMES[] = {"+", "-", "*", "/"};
-    locators::SpanLocator cur = operands[0]->pos;
-    shared_ptr<runtime::RuntimeValue> val;
-    {
-        auto optVal = ExecuteExpressionInThis(operands[0]);
-        if (!optVal) return;
-        val = *optVal;
-    }
-    size_t n = ops.size();
+    auto target = exchange(inPlaceTarget, nullptr);
+    auto operands = lowered.ChildrenOf(node);
+    const uint8_t* operators = lowered.Operators.data() + node.data;
+    size_t n = operands.size() - 1;
+    locators::SpanLocator cur = lowered.Nodes[operands[0]].pos;
+    auto val = Evaluate(operands[0]);
+    if (!val) return nullptr;
     for (size_t i = 0; i < n; i++) {
-        auto optRHS = ExecuteExpressionInThis(operands[i + 1]);
-        if (!optRHS) return;
-        cur = locators::SpanLocator(cur, operands[i + 1]->pos);
+        auto rhs = Evaluate(operands[i + 1]);
+        if (!rhs) return nullptr;
+        cur = locators::SpanLocator(cur, lowered.Nodes[operands[i + 1]].pos);
+        // Nobody else can observe `val` if it is an intermediate result, or if its only other owner is the variable
+        // the whole chain is being assigned to and no more operands are left to evaluate
+        bool exclusive = val.use_count() == 1 ||
+                         (i == n - 1 && target && target->Content() == val && val.use_count() == 2);
+        auto op = static_cast<OperatorKind>(operators[i]);
+        // a sum or a product is at most about as large as its operands together, and in a bounded run it is refused
+        // before it is built if that does not fit
+        if (context.MemoryLeft && (op == OperatorKind::Plus || op == OperatorKind::Times) &&
+            !context.FitsInMemory(RuntimeContext::ApproximateSize(*val) + RuntimeContext::ApproximateSize(*rhs), cur))
+            return nullptr;
+        if (exclusive) {
+            bool done = false;
+            switch (op) {
+                case OperatorKind::Plus:
+                    done = val->BinaryPlusInPlace(*rhs);
+                    break;
+                case OperatorKind::Minus:
+                    done = val->BinaryMinusInPlace(*rhs);
+                    break;
+                case OperatorKind::Times:
+                    done = val->BinaryMulInPlace(*rhs);
+                    break;
+                case OperatorKind::Divide:
+                    break;
+            }
+            if (done) continue;
+        }
         runtime::RuntimeValueResult res;
-        switch (ops[i]) {
+        switch (op) {
             case OperatorKind::Plus:
-                res = val->BinaryPlus(**optRHS);
+                res = val->BinaryPlus(*rhs);
                 break;
             case OperatorKind::Minus:
-                res = val->BinaryMinus(**optRHS);
+                res = val->BinaryMinus(*rhs);
                 break;
             case OperatorKind::Times:
-                res = val->BinaryMul(**optRHS);
+                res = val->BinaryMul(*rhs);
                 break;
             case OperatorKind::Divide:
-                res = val->BinaryDiv(**optRHS);
+                res = val->BinaryDiv(*rhs);
                 break;
         }
         if (!res) {
             context.SetThrowingState(
-                runtime::DRuntimeError(string("Operator \"") + OPNAMES[static_cast<int>(ops[i])] +
+                runtime::DRuntimeError(string("Operator \"") + OPNAMES[static_cast<int>(op)] +
                                        "\" is not supported between \"" + val->TypeOfValue()->Name() + "\" and \"" +
-                                       optRHS.value()->TypeOfValue()->Name() + "\""),
+                                       rhs->TypeOfValue()->Name() + "\""),
                 cur);
-            return;
+            return nullptr;
         }
         if (res->index()) {
             context.SetThrowingState(get<1>(*res), cur);
-            return;
+            return nullptr;
         }
         val = get<0>(*res);
     }
-    optExprValue = val;
+    return val;
 }
 
-void Executor::ExecuteLogicalOperators(LogicalOperatorKind kind,
-                                       const std::vector<std::shared_ptr<ast::Expression>>& operands) {
+shared_ptr<runtime::RuntimeValue> Executor::ExecuteLogicalOperators(LogicalOperatorKind kind, const Node& node) {
     const char* const OPNAMES[] = {"and", "or", "xor"};
     optional<bool> stopValue;
     switch (kind) {
@@ -97,169 +118,528 @@ void Executor::ExecuteLogicalOperators(LogicalOperatorKind kind,
         case LogicalOperatorKind::Xor:
             break;
     }
+    auto operands = lowered.ChildrenOf(node);
     shared_ptr<runtime::BoolValue> val;
-    auto curpos = operands[0]->pos;
+    auto curpos = lowered.Nodes[operands[0]].pos;
     {
-        auto optVal = ExecuteExpressionInThis(operands[0]);
-        if (!optVal) return;
-        val = dynamic_pointer_cast<runtime::BoolValue>(*optVal);
+        auto first = Evaluate(operands[0]);
+        if (!first) return nullptr;
+        val = dynamic_pointer_cast<runtime::BoolValue>(first);
         if (!val) {
             context.SetThrowingState(runtime::DRuntimeError(string("Operator \"") + OPNAMES[static_cast<int>(kind)] +
                                                             "\" expects boolean operands, but got \"" +
-                                                            optVal.value()->TypeOfValue()->Name() + "\""),
+                                                            first->TypeOfValue()->Name() + "\""),
                                      curpos);
-            return;
+            return nullptr;
         }
     }
     size_t n = operands.size();
     for (size_t i = 1; i < n && (!stopValue || *stopValue != val->Value()); i++) {
-        curpos = locators::SpanLocator(curpos, operands[i]->pos);
-        auto optRHS = ExecuteExpressionInThis(operands[i]);
-        if (!optRHS) return;
+        curpos = locators::SpanLocator(curpos, lowered.Nodes[operands[i]].pos);
+        auto rhs = Evaluate(operands[i]);
+        if (!rhs) return nullptr;
         runtime::RuntimeValueResult res;
         switch (kind) {
             case LogicalOperatorKind::And:
-                res = val->BinaryAnd(**optRHS);
+                res = val->BinaryAnd(*rhs);
                 break;
             case LogicalOperatorKind::Or:
-                res = val->BinaryOr(**optRHS);
+                res = val->BinaryOr(*rhs);
                 break;
             case LogicalOperatorKind::Xor:
-                res = val->BinaryXor(**optRHS);
+                res = val->BinaryXor(*rhs);
                 break;
         }
         if (!res) {
             context.SetThrowingState(runtime::DRuntimeError(string("Operator \"") + OPNAMES[static_cast<int>(kind)] +
                                                             "\" is not applicable to \"" + val->TypeOfValue()->Name() +
-                                                            "\" and \"" + optRHS.value()->TypeOfValue()->Name() + "\""),
+                                                            "\" and \"" + rhs->TypeOfValue()->Name() + "\""),
                                      curpos);
-            return;
+            return nullptr;
         }
         if (res->index()) {
             context.SetThrowingState(get<1>(*res), curpos);
-            return;
+            return nullptr;
         }
         val = dynamic_pointer_cast<runtime::BoolValue>(get<0>(*res));
     }
-    optExprValue = val;
+    return val;
 }
 
-#define DISALLOWED_VISIT(name) \
-    void Executor::Visit##name(ast::name&) { throw runtime_error("Executor cannot visit " #name); }
+shared_ptr<runtime::RuntimeValue> Executor::ExecuteRelation(const Node& node) {
+    auto operands = lowered.ChildrenOf(node);
+    const uint8_t* operators = lowered.Operators.data() + node.data;
+    auto lhs = Evaluate(operands[0]);
+    if (!lhs) return nullptr;
+    size_t n = operands.size() - 1;
+    for (size_t i = 0; i < n; i++) {
+        auto op = static_cast<ast::BinaryRelationOperator>(operators[i]);
+        auto rhs = Evaluate(operands[i + 1]);
+        if (!rhs) return nullptr;
+        auto comp = lhs->BinaryComparison(*rhs);
+        if (!comp) {
+            context.SetThrowingState(
+                runtime::DRuntimeError("Objects of types \"" + lhs->TypeOfValue()->Name() + "\" and \"" +
+                                       rhs->TypeOfValue()->Name() + "\" are incomparable"),
+                locators::SpanLocator(lowered.Nodes[operands[i]].pos, lowered.Nodes[operands[i + 1]].pos));
+            return nullptr;
+        }
+        bool result = false;
+        switch (op) {
+            case ast::BinaryRelationOperator::Less:
+                result = *comp < 0;
+                break;
+            case ast::BinaryRelationOperator::LessEq:
+                result = *comp <= 0;
+                break;
+            case ast::BinaryRelationOperator::Greater:
+                result = *comp > 0;
+                break;
+            case ast::BinaryRelationOperator::GreaterEq:
+                result = *comp >= 0;
+                break;
+            case ast::BinaryRelationOperator::Equal:
+                result = *comp == 0;
+                break;
+            case ast::BinaryRelationOperator::NotEqual:
+                result = *comp != 0;
+                break;
+        }
+        if (!result) return make_shared<runtime::BoolValue>(false);
+        lhs = std::move(rhs);
+    }
+    return make_shared<runtime::BoolValue>(true);
+}
 
-void Executor::VisitBody(ast::Body& node) {
-    auto prevScopes = scopes;
-    scopes = make_shared<ScopeStack>(scopes);
-    for (auto& stmt : node.statements) {
-        stmt->AcceptVisitor(*this);
+shared_ptr<runtime::RuntimeValue> Executor::ExecuteUnary(const Node& node) {
+    auto children = lowered.ChildrenOf(node);
+    auto val = Evaluate(children[0]);
+    if (!val) return nullptr;
+    auto pos = lowered.Nodes[children[0]].pos;
+    for (auto op : children.subspan(1))
+        if (!ApplyOperator(lowered.Nodes[op], val, pos)) return nullptr;
+    return val;
+}
+
+bool Executor::AccessFieldByIndex(shared_ptr<runtime::RuntimeValue>& value, locators::SpanLocator& pos,
+                                  const runtime::RuntimeValue& index, const locators::SpanLocator& accessorPos) {
+    auto res = value->Field(index);
+    if (!res) {
+        stringstream ss;
+        index.PrintSelf(ss);
+        context.SetThrowingState(runtime::DRuntimeError("Object (of type \"" + value->TypeOfValue()->Name() +
+                                                        "\") has no indexed field \"" + ss.str() +
+                                                        "\" (index of type \"" + index.TypeOfValue()->Name() + "\")"),
+                                 accessorPos);
+        return false;
+    }
+    if (res->index()) {
+        context.SetThrowingState(get<1>(*res), accessorPos);
+        return false;
+    }
+    value = get<0>(*res);
+    pos = locators::SpanLocator(pos, accessorPos);
+    return true;
+}
+
+bool Executor::ApplyCall(const Node& call, shared_ptr<runtime::RuntimeValue>& value, locators::SpanLocator& pos) {
+    auto argNodes = lowered.ChildrenOf(call);
+    vector<shared_ptr<runtime::RuntimeValue>> args;
+    args.reserve(argNodes.size());
+    for (auto arg : argNodes) {
+        auto val = Evaluate(arg);
+        if (!val) return false;
+        args.push_back(std::move(val));
+    }
+    pos = locators::SpanLocator(pos, call.pos);
+    auto userfunc = dynamic_cast<interp::UserCallable*>(value.get());
+    if (userfunc) {
+        auto ftype = userfunc->FunctionType();
+        if (auto argtypes = ftype->ArgTypes()) {
+            size_t n = argtypes->size();
+            if (args.size() != n) {
+                context.SetThrowingState(
+                    runtime::DRuntimeError("Function accepts " + to_string(n) + " arguments, but " +
+                                           to_string(args.size()) + " were given"),
+                    call.pos);
+                return false;
+            }
+        }
+        if (!context.Stack.Push(pos)) {
+            context.SetThrowingState(runtime::DRuntimeError("Stack overflow!"), pos);
+            return false;
+        }
+        auto ret = userfunc->UserCall(context, args);
+        context.Stack.Pop();
+        if (context.State.IsThrowing()) return false;
+#ifdef DINTERP_DEBUG
+        if (!ret) throw runtime_error("User-callable function returned nullptr");
+#endif
+        value = ret;
+        return true;
+    }
+    auto func = dynamic_cast<runtime::FuncValue*>(value.get());
+    if (func) {
+        // a bounded run computes the calls ahead, so it refuses the ones that are too large for that
+        if (context.MemoryLeft && !func->CanPrecompute(args)) {
+            context.SetThrowingState(runtime::DRuntimeError("Out of memory"), pos);
+            return false;
+        }
+        auto res = func->Call(args);
+        if (res) {
+            if (res->index()) {
+                context.SetThrowingState(get<1>(*res), pos);
+                return false;
+            }
+            value = get<0>(*res);
+            return true;
+        }
+    }
+    context.SetThrowingState(
+        runtime::DRuntimeError("Cannot call this object of type \"" + value->TypeOfValue()->Name() + "\""), pos);
+    return false;
+}
+
+bool Executor::ApplyOperator(const Node& op, shared_ptr<runtime::RuntimeValue>& value, locators::SpanLocator& pos) {
+    switch (op.op) {
+        case Op::Prefix: {
+            const char* const OPNAMES[] = {"unary +", "unary -"};
+            auto kind = static_cast<ast::PrefixOperator::PrefixOperatorKind>(op.kind);
+            runtime::RuntimeValueResult res =
+                kind == ast::PrefixOperator::PrefixOperatorKind::Plus ? value->UnaryPlus() : value->UnaryMinus();
+            if (!res) {
+                context.SetThrowingState(
+                    runtime::DRuntimeError("Object (of type \"" + value->TypeOfValue()->Name() +
+                                           "\") does not support the " + OPNAMES[op.kind] + " operator"),
+                    op.pos);
+                return false;
+            }
+            if (res->index()) {
+                context.SetThrowingState(get<1>(*res), op.pos);
+                return false;
+            }
+            value = get<0>(*res);
+            pos = locators::SpanLocator(pos, op.pos);
+            return true;
+        }
+        case Op::Typecheck: {
+            unique_ptr<runtime::Type> type;
+            switch (static_cast<ast::TypeId>(op.kind)) {
+                case ast::TypeId::Int:
+                    type = make_unique<runtime::IntegerType>();
+                    break;
+                case ast::TypeId::Real:
+                    type = make_unique<runtime::RealType>();
+                    break;
+                case ast::TypeId::String:
+                    type = make_unique<runtime::StringType>();
+                    break;
+                case ast::TypeId::Bool:
+                    type = make_unique<runtime::BoolType>();
+                    break;
+                case ast::TypeId::None:
+                    type = make_unique<runtime::NoneType>();
+                    break;
+                case ast::TypeId::Func:
+                    type = make_unique<runtime::FuncType>();
+                    break;
+                case ast::TypeId::Tuple:
+                    type = make_unique<runtime::TupleType>();
+                    break;
+                case ast::TypeId::List:
+                    type = make_unique<runtime::ArrayType>();
+                    break;
+            }
+            value = make_shared<runtime::BoolValue>(value->TypeOfValue()->TypeEq(*type));
+            pos = locators::SpanLocator(pos, op.pos);
+            return true;
+        }
+        case Op::Call:
+            return ApplyCall(op, value, pos);
+        case Op::Field: {
+            const string& name = lowered.Names[op.data];
+            auto res = value->Field(name);
+            if (!res) {
+                context.SetThrowingState(runtime::DRuntimeError("Object (of type \"" + value->TypeOfValue()->Name() +
+                                                                "\") had no field \"" + name + "\""),
+                                         op.pos);
+                return false;
+            }
+            if (res->index()) {
+                context.SetThrowingState(get<1>(*res), op.pos);
+                return false;
+            }
+            value = get<0>(*res);
+            pos = locators::SpanLocator(pos, op.pos);
+            return true;
+        }
+        case Op::IntField:
+            return AccessFieldByIndex(value, pos, *lowered.Constants[op.data], op.pos);
+        case Op::ParenField: {
+            auto index = Evaluate(lowered.Children[op.first]);
+            if (!index) return false;
+            return AccessFieldByIndex(value, pos, *index, op.pos);
+        }
+        case Op::Index: {
+            auto subscript = Evaluate(lowered.Children[op.first]);
+            if (!subscript) return false;
+            auto res = value->Subscript(*subscript);
+            if (!res) {
+                context.SetThrowingState(runtime::DRuntimeError("Object (of type \"" + value->TypeOfValue()->Name() +
+                                                                "\") does not support subscripts"),
+                                         op.pos);
+                return false;
+            }
+            if (res->index()) {
+                context.SetThrowingState(get<1>(*res), op.pos);
+                return false;
+            }
+            value = get<0>(*res);
+            pos = locators::SpanLocator(pos, op.pos);
+            return true;
+        }
+        default:
+            throw runtime_error("Executor cannot apply a node that is not an operator");
+    }
+}
+
+shared_ptr<runtime::RuntimeValue> Executor::ExecuteTuple(const Node& node) {
+    auto elements = lowered.ChildrenOf(node);
+    vector<pair<optional<string>, shared_ptr<runtime::RuntimeValue>>> vals;
+    vals.reserve(elements.size());
+    for (auto index : elements) {
+        const Node& elem = lowered.Nodes[index];
+        if (elem.kind) {
+            context.SetThrowingState(runtime::DRuntimeError("Field name duplicated"), elem.pos);
+            return nullptr;
+        }
+        optional<string> name;
+        if (elem.data != LoweredCode::NO_NAME) name.emplace(lowered.Names[elem.data]);
+        auto val = Evaluate(lowered.Children[elem.first]);
+        if (!val) return nullptr;
+        vals.emplace_back(std::move(name), std::move(val));
+    }
+    return make_shared<runtime::TupleValue>(vals);
+}
+
+shared_ptr<runtime::RuntimeValue> Executor::ExecuteInlined(const Node& node) {
+    auto argNodes = lowered.ChildrenOf(node);
+    vector<shared_ptr<runtime::RuntimeValue>> args;
+    args.reserve(argNodes.size());
+    for (auto arg : argNodes) {
+        auto val = Evaluate(arg);
+        if (!val) return nullptr;
+        args.push_back(std::move(val));
+    }
+    if (!context.Stack.Push(node.pos)) {
+        context.SetThrowingState(runtime::DRuntimeError("Stack overflow!"), node.pos);
+        return nullptr;
+    }
+    auto ret = runtime::Closure::Run(context, scopes, code, node.data, args);
+    context.Stack.Pop();
+    return ret;
+}
+
+shared_ptr<runtime::RuntimeValue> Executor::Compute(CodeIndex index) {
+    const Node& node = lowered.Nodes[index];
+    switch (node.op) {
+        case Op::Xor:
+            return ExecuteLogicalOperators(LogicalOperatorKind::Xor, node);
+        case Op::Or:
+            return ExecuteLogicalOperators(LogicalOperatorKind::Or, node);
+        case Op::And:
+            return ExecuteLogicalOperators(LogicalOperatorKind::And, node);
+        case Op::Relation:
+            return ExecuteRelation(node);
+        case Op::Arithmetic:
+            return ExecuteOperators(node);
+        case Op::Unary:
+            return ExecuteUnary(node);
+        case Op::Not: {
+            auto operand = lowered.Children[node.first];
+            auto val = Evaluate(operand);
+            if (!val) return nullptr;
+            auto res = val->UnaryNot();
+            if (!res) {
+                context.SetThrowingState(
+                    runtime::DRuntimeError("The unary not operator does not support an operand of type \"" +
+                                           val->TypeOfValue()->Name() + "\""),
+                    lowered.Nodes[operand].pos);
+                return nullptr;
+            }
+            if (res->index()) {
+                context.SetThrowingState(get<1>(*res), node.pos);
+                return nullptr;
+            }
+            return get<0>(*res);
+        }
+        case Op::Ident: {
+            const string& name = lowered.Names[node.data];
+            auto var = scopes->Lookup(name);
+            if (!var) {
+                context.SetThrowingState(
+                    runtime::DRuntimeError("Referencing an undeclared variable: \"" + name + "\""), node.pos);
+                return nullptr;
+            }
+            return var.value()->Content();
+        }
+        case Op::Parentheses:
+            return Compute(lowered.Children[node.first]);
+        case Op::Tuple:
+            return ExecuteTuple(node);
+        case Op::Constant:
+            return lowered.Constants[node.data];
+        case Op::Array: {
+            auto items = lowered.ChildrenOf(node);
+            vector<shared_ptr<runtime::RuntimeValue>> vals;
+            vals.reserve(items.size());
+            for (auto item : items) {
+                auto val = Evaluate(item);
+                if (!val) return nullptr;
+                vals.push_back(std::move(val));
+            }
+            return make_shared<runtime::ArrayValue>(vals);
+        }
+        case Op::Closure:
+            return make_shared<runtime::Closure>(*scopes, code, node.data);
+        case Op::Hoisted: {
+            // declared as none before the loop, and never none once evaluated
+            auto var = scopes->Lookup(lowered.Names[node.data]).value();
+            if (dynamic_cast<const runtime::NoneValue*>(var->Content().get())) {
+                auto val = Evaluate(lowered.Children[node.first]);
+                if (!val) return nullptr;
+                var->Assign(val);
+            }
+            return var->Content();
+        }
+        case Op::Inlined:
+            return ExecuteInlined(node);
+        default:
+            throw runtime_error("Executor cannot evaluate a node that is not an expression");
+    }
+}
+
+void Executor::ExecuteBody(const Node& node) {
+    // an empty body takes a step as well, for the loops around it
+    if (context.StepsLeft && !context.TakeStep(node.pos)) return;
+    // a body that declares nothing needs no scope of its own
+    shared_ptr<ScopeStack> prevScopes;
+    if (node.kind) {
+        prevScopes = scopes;
+        scopes = make_shared<ScopeStack>(scopes);
+    }
+    for (auto stmt : lowered.ChildrenOf(node)) {
+        if (context.StepsLeft && !context.TakeStep(lowered.Nodes[stmt].pos)) break;
+        Execute(stmt);
         if (!context.State.IsRunning()) break;
     }
-    scopes = prevScopes;
+    if (node.kind) scopes = std::move(prevScopes);
 }
 
-void Executor::VisitVarStatement(ast::VarStatement& node) {
-    for (auto& def : node.definitions) {
-        if (scopes->Lookup(def.first->identifier)) {
-            auto span = def.first->span;
-            context.SetThrowingState(
-                runtime::DRuntimeError("Variable \"" + def.first->identifier + "\" was already declared"),
-                locators::SpanLocator(node.pos.File(), span.position, span.length));
+void Executor::ExecuteVar(const Node& node) {
+    for (auto index : lowered.ChildrenOf(node)) {
+        const Node& def = lowered.Nodes[index];
+        const string& name = lowered.Names[def.data];
+        if (scopes->Lookup(name)) {
+            context.SetThrowingState(runtime::DRuntimeError("Variable \"" + name + "\" was already declared"),
+                                     def.pos);
             return;
         }
         shared_ptr<runtime::RuntimeValue> val;
-        if (!def.second)
+        if (!def.count)
             val = make_shared<runtime::NoneValue>();
         else {
-            auto optVal = ExecuteExpressionInThis(*def.second);
-            if (!optVal) return;
-            val = *optVal;
+            val = Evaluate(lowered.Children[def.first]);
+            if (!val) return;
+            if (context.MemoryLeft && !context.TakeMemory(*val, node.pos)) return;
         }
-        scopes->Declare(make_shared<Variable>(def.first->identifier, val));
+        scopes->Declare(make_shared<Variable>(name, val));
     }
 }
 
-void Executor::VisitIfStatement(ast::IfStatement& node) {
-    auto optcond = ExecuteExpressionInThis(node.condition);
-    if (!optcond) return;
-    auto condval = dynamic_pointer_cast<runtime::BoolValue>(*optcond);
+void Executor::ExecuteIf(const Node& node) {
+    auto children = lowered.ChildrenOf(node);
+    auto cond = Evaluate(children[0]);
+    if (!cond) return;
+    auto condval = dynamic_cast<const runtime::BoolValue*>(cond.get());
     if (!condval) {
         context.SetThrowingState(runtime::DRuntimeError("if condition must be a boolean value, but \"" +
-                                                        optcond.value()->TypeOfValue()->Name() + "\" was provided"),
-                                 node.condition->pos);
+                                                        cond->TypeOfValue()->Name() + "\" was provided"),
+                                 lowered.Nodes[children[0]].pos);
         return;
     }
     if (condval->Value())
-        VisitBody(*node.doIfTrue);
-    else if (node.doIfFalse)
-        VisitBody(**node.doIfFalse);
+        ExecuteBody(lowered.Nodes[children[1]]);
+    else if (children.size() > 2)
+        ExecuteBody(lowered.Nodes[children[2]]);
 }
 
-void Executor::VisitShortIfStatement(ast::ShortIfStatement& node) {
-    auto optcond = ExecuteExpressionInThis(node.condition);
-    if (!optcond) return;
-    auto condval = dynamic_pointer_cast<runtime::BoolValue>(*optcond);
+void Executor::ExecuteShortIf(const Node& node) {
+    auto children = lowered.ChildrenOf(node);
+    auto cond = Evaluate(children[0]);
+    if (!cond) return;
+    auto condval = dynamic_cast<const runtime::BoolValue*>(cond.get());
     if (!condval) {
         context.SetThrowingState(runtime::DRuntimeError("short-if condition must be a boolean value, but \"" +
-                                                        optcond.value()->TypeOfValue()->Name() + "\" was provided"),
-                                 node.condition->pos);
+                                                        cond->TypeOfValue()->Name() + "\" was provided"),
+                                 lowered.Nodes[children[0]].pos);
         return;
     }
     if (condval->Value()) {
         auto prevScopes = scopes;
         scopes = make_shared<ScopeStack>(scopes);
-        node.doIfTrue->AcceptVisitor(*this);
+        Execute(children[1]);
         scopes = prevScopes;
     }
 }
 
-void Executor::VisitWhileStatement(ast::WhileStatement& node) {
+void Executor::ExecuteWhile(const Node& node) {
+    auto children = lowered.ChildrenOf(node);
+    const Node& action = lowered.Nodes[children[1]];
     while (true) {
-        auto optcond = ExecuteExpressionInThis(node.condition);
-        if (!optcond) return;
-        auto condval = dynamic_pointer_cast<runtime::BoolValue>(*optcond);
+        auto cond = Evaluate(children[0]);
+        if (!cond) return;
+        auto condval = dynamic_cast<const runtime::BoolValue*>(cond.get());
         if (!condval) {
             context.SetThrowingState(runtime::DRuntimeError("while condition must be a boolean value, but \"" +
-                                                            optcond.value()->TypeOfValue()->Name() + "\" was provided"),
-                                     node.condition->pos);
+                                                            cond->TypeOfValue()->Name() + "\" was provided"),
+                                     lowered.Nodes[children[0]].pos);
             return;
         }
         if (!condval->Value()) break;
-        VisitBody(*node.action);
+        ExecuteBody(action);
         if (context.State.IsRunning()) continue;
         if (context.State.IsExiting()) context.State = RuntimeState::Running();
         break;
     }
 }
 
-void Executor::VisitForStatement(ast::ForStatement& node) {
+void Executor::ExecuteFor(const Node& node) {
+    auto children = lowered.ChildrenOf(node);
+    const Node& action = lowered.Nodes[children.back()];
     optional<shared_ptr<Variable>> cyclevar;
-    if (node.optVariableName)
-        cyclevar = make_shared<Variable>(node.optVariableName.value()->identifier, make_shared<runtime::NoneValue>());
+    if (node.kind & LoweredCode::HasVariable)
+        cyclevar = make_shared<Variable>(lowered.Names[node.data], make_shared<runtime::NoneValue>());
 
-    shared_ptr<runtime::RuntimeValue> startOrList;
-    {
-        auto optStartOrList = ExecuteExpressionInThis(node.startOrList);
-        if (!optStartOrList) return;
-        startOrList = *optStartOrList;
-    }
+    auto startOrList = Evaluate(children[0]);
+    if (!startOrList) return;
     optional<variant<pair<BigInt, BigInt>, vector<shared_ptr<runtime::RuntimeValue>>, size_t>> range;
-    if (node.end) {
+    if (node.kind & LoweredCode::HasEnd) {
         auto intstart = dynamic_pointer_cast<runtime::IntegerValue>(startOrList);
         if (!intstart) {
             context.SetThrowingState(
                 runtime::DRuntimeError("Starting bound was of type \"" + startOrList->TypeOfValue()->Name() +
                                        "\", expected an integer"),
-                node.startOrList->pos);
+                lowered.Nodes[children[0]].pos);
             return;
         }
-        auto end = ExecuteExpressionInThis(*node.end);
+        auto end = Evaluate(children[1]);
         if (!end) return;
-        auto intend = dynamic_pointer_cast<runtime::IntegerValue>(*end);
+        auto intend = dynamic_pointer_cast<runtime::IntegerValue>(end);
         if (!intend) {
-            context.SetThrowingState(
-                runtime::DRuntimeError("Ending bound was of type \"" + end.value()->TypeOfValue()->Name() +
-                                       "\", expected an integer"),
-                node.end.value()->pos);
+            context.SetThrowingState(runtime::DRuntimeError("Ending bound was of type \"" +
+                                                            end->TypeOfValue()->Name() + "\", expected an integer"),
+                                     lowered.Nodes[children[1]].pos);
             return;
         }
         range.emplace(make_pair(intstart->Value(), intend->Value()));
@@ -284,7 +664,7 @@ void Executor::VisitForStatement(ast::ForStatement& node) {
                 context.SetThrowingState(
                     runtime::DRuntimeError("Expected an iterable type (array or tuple), but got \"" +
                                            startOrList->TypeOfValue()->Name()),
-                    node.startOrList->pos);
+                    lowered.Nodes[children[0]].pos);
                 return;
             }
         }
@@ -302,7 +682,7 @@ void Executor::VisitForStatement(ast::ForStatement& node) {
             auto cur = start;
             while (true) {
                 if (cyclevar) cyclevar.value()->Assign(make_shared<runtime::IntegerValue>(cur));
-                VisitBody(*node.action);
+                ExecuteBody(action);
                 if (!context.State.IsRunning()) {
                     if (context.State.IsExiting()) context.State = RuntimeState::Running();
                     break;
@@ -319,7 +699,7 @@ void Executor::VisitForStatement(ast::ForStatement& node) {
             auto& items = get<1>(*range);
             for (auto& item : items) {
                 cyclevar.value()->Assign(item);
-                VisitBody(*node.action);
+                ExecuteBody(action);
                 if (!context.State.IsRunning()) {
                     if (context.State.IsExiting()) context.State = RuntimeState::Running();
                     break;
@@ -330,7 +710,7 @@ void Executor::VisitForStatement(ast::ForStatement& node) {
         case 2: {  // iterating several times without a variable
             size_t n = get<2>(*range);
             for (size_t i = 0; i < n; ++i) {
-                VisitBody(*node.action);
+                ExecuteBody(action);
                 if (!context.State.IsRunning()) {
                     if (context.State.IsExiting()) context.State = RuntimeState::Running();
                     break;
@@ -342,9 +722,10 @@ void Executor::VisitForStatement(ast::ForStatement& node) {
     scopes = prevScopes;
 }
 
-void Executor::VisitLoopStatement(ast::LoopStatement& node) {
+void Executor::ExecuteLoop(const Node& node) {
+    const Node& body = lowered.Nodes[lowered.Children[node.first]];
     while (true) {
-        VisitBody(*node.body);
+        ExecuteBody(body);
         if (!context.State.IsRunning()) {
             if (context.State.IsExiting()) context.State = RuntimeState::Running();
             break;
@@ -352,41 +733,30 @@ void Executor::VisitLoopStatement(ast::LoopStatement& node) {
     }
 }
 
-void Executor::VisitExitStatement(ast::ExitStatement&) { context.State = RuntimeState::Exiting(); }
-
-void Executor::VisitAssignStatement(ast::AssignStatement& node) {
-    shared_ptr<runtime::RuntimeValue> val;
-    {
-        auto optVal = ExecuteExpressionInThis(node.src);
-        if (!optVal) return;
-        val = *optVal;
-    }
-    auto optvariable = scopes->Lookup(node.dest->baseIdent->identifier);
-    auto _span = node.dest->baseIdent->span;
-    locators::SpanLocator curpos(node.pos.File(), _span.position, _span.length);
+void Executor::ExecuteAssign(const Node& node) {
+    auto children = lowered.ChildrenOf(node);
+    const Node& dest = lowered.Nodes[children[1]];
+    const string& name = lowered.Names[dest.data];
+    if (node.kind) inPlaceTarget = scopes->Lookup(name).value_or(nullptr);
+    auto val = Evaluate(children[0]);
+    if (!val) return;
+    if (context.MemoryLeft && !context.TakeMemory(*val, node.pos)) return;
+    auto optvariable = scopes->Lookup(name);
+    locators::SpanLocator curpos = dest.pos;
     if (!optvariable) {
-        context.SetThrowingState(
-            runtime::DRuntimeError("Variable not declared: \"" + node.dest->baseIdent->identifier + "\""), curpos);
+        context.SetThrowingState(runtime::DRuntimeError("Variable not declared: \"" + name + "\""), curpos);
         return;
     }
-    if (node.dest->accessorChain.empty()) {
+    auto accessors = children.subspan(2);
+    if (accessors.empty()) {
         optvariable.value()->Assign(val);
         return;
     }
-    size_t n = node.dest->accessorChain.size() - 1;
     auto curobj = optvariable.value()->Content();
-    if (n) {
-        UnaryOpExecutor exec(context, scopes, curobj, curpos);
-        for (size_t i = 0; i < n; ++i) {
-            node.dest->accessorChain[i]->AcceptVisitor(exec);
-            if (context.State.IsThrowing()) return;
-        }
-        curobj = exec.Value();
-        curpos = exec.Position();
-    }
-    auto lastAccessor = node.dest->accessorChain.back();
-    auto indexAcc = dynamic_pointer_cast<ast::IndexAccessor>(lastAccessor);
-    if (indexAcc) {
+    for (auto accessor : accessors.first(accessors.size() - 1))
+        if (!ApplyOperator(lowered.Nodes[accessor], curobj, curpos)) return;
+    const Node& lastAccessor = lowered.Nodes[accessors.back()];
+    if (lastAccessor.op == Op::Index) {
         auto arr = dynamic_pointer_cast<runtime::ArrayValue>(curobj);
         if (!arr) {
             context.SetThrowingState(runtime::DRuntimeError("Can only assign by subscript to arrays, tried with \"" +
@@ -394,12 +764,12 @@ void Executor::VisitAssignStatement(ast::AssignStatement& node) {
                                      curpos);
             return;
         }
-        auto indObj = ExecuteExpressionInThis(indexAcc->expressionInBrackets);
+        auto indObj = Evaluate(lowered.Children[lastAccessor.first]);
         if (!indObj) return;
-        auto intSubscript = dynamic_pointer_cast<runtime::IntegerValue>(*indObj);
+        auto intSubscript = dynamic_cast<const runtime::IntegerValue*>(indObj.get());
         if (!intSubscript) {
             context.SetThrowingState(runtime::DRuntimeError("Subscript must be an integer, but it was \"" +
-                                                            indObj.value()->TypeOfValue()->Name() + "\""),
+                                                            indObj->TypeOfValue()->Name() + "\""),
                                      curpos);
             return;
         }
@@ -414,282 +784,95 @@ void Executor::VisitAssignStatement(ast::AssignStatement& node) {
                                  curpos);
         return;
     }
-    auto namedAcc = dynamic_pointer_cast<ast::IdentMemberAccessor>(lastAccessor);
-    if (namedAcc) {
-        if (tuple->AssignNamedField(namedAcc->name->identifier, val)) return;
-        context.SetThrowingState(runtime::DRuntimeError("No field named \"" + namedAcc->name->identifier + "\""),
-                                 namedAcc->pos);
+    if (lastAccessor.op == Op::Field) {
+        const string& field = lowered.Names[lastAccessor.data];
+        if (tuple->AssignNamedField(field, val)) return;
+        context.SetThrowingState(runtime::DRuntimeError("No field named \"" + field + "\""), lastAccessor.pos);
         return;
     }
     BigInt index;
-    auto paren = dynamic_pointer_cast<ast::ParenMemberAccessor>(lastAccessor);
-    if (paren) {
-        auto indObj = ExecuteExpressionInThis(paren->expr);
+    if (lastAccessor.op == Op::ParenField) {
+        auto indObj = Evaluate(lowered.Children[lastAccessor.first]);
         if (!indObj) return;
-        auto intSubscript = dynamic_pointer_cast<runtime::IntegerValue>(*indObj);
+        auto intSubscript = dynamic_cast<const runtime::IntegerValue*>(indObj.get());
         if (!intSubscript) {
             context.SetThrowingState(runtime::DRuntimeError("Field index must be an integer, but it was \"" +
-                                                            indObj.value()->TypeOfValue()->Name() + "\""),
+                                                            indObj->TypeOfValue()->Name() + "\""),
                                      curpos);
             return;
         }
         index = intSubscript->Value();
     } else
-        index = dynamic_cast<ast::IntLiteralMemberAccessor&>(*lastAccessor).index->value;
+        index = dynamic_cast<const runtime::IntegerValue&>(*lowered.Constants[lastAccessor.data]).Value();
     if (tuple->AssignIndexedField(index, val)) return;
     context.SetThrowingState(runtime::DRuntimeError("Field index out of range: " + index.ToString()),
-                             lastAccessor->pos);
+                             lastAccessor.pos);
 }
 
-void Executor::VisitPrintStatement(ast::PrintStatement& node) {
-    for (auto& expr : node.expressions) {
-        auto val = ExecuteExpressionInThis(expr);
+void Executor::ExecutePrint(const Node& node) {
+    for (auto expr : lowered.ChildrenOf(node)) {
+        auto val = Evaluate(expr);
         if (!val) return;
-        val.value()->PrintSelf(*context.Output);
+        val->PrintSelf(*context.Output);
     }
     context.Output->flush();
 }
 
-void Executor::VisitReturnStatement(ast::ReturnStatement& node) {
+void Executor::ExecuteReturn(const Node& node) {
     shared_ptr<runtime::RuntimeValue> ret;
-    if (!node.returnValue)
+    if (!node.count)
         ret = make_shared<runtime::NoneValue>();
     else {
-        auto opt = ExecuteExpressionInThis(*node.returnValue);
-        if (!opt) return;
-        ret = *opt;
+        ret = Evaluate(lowered.Children[node.first]);
+        if (!ret) return;
+        if (context.MemoryLeft && !context.TakeMemory(*ret, node.pos)) return;
     }
     context.State = RuntimeState::Returning(ret);
 }
 
-void Executor::VisitExpressionStatement(ast::ExpressionStatement& node) {
-    node.expr->AcceptVisitor(*this);
-    optExprValue.reset();
-}
-
-DISALLOWED_VISIT(CommaExpressions)
-DISALLOWED_VISIT(CommaIdents)
-DISALLOWED_VISIT(IdentMemberAccessor)
-DISALLOWED_VISIT(IntLiteralMemberAccessor)
-DISALLOWED_VISIT(ParenMemberAccessor)
-DISALLOWED_VISIT(IndexAccessor)
-DISALLOWED_VISIT(Reference)
-
-void Executor::VisitXorOperator(ast::XorOperator& node) {
-    ExecuteLogicalOperators(LogicalOperatorKind::Xor, node.operands);
-}
-
-void Executor::VisitOrOperator(ast::OrOperator& node) {
-    ExecuteLogicalOperators(LogicalOperatorKind::Or, node.operands);
-}
-
-void Executor::VisitAndOperator(ast::AndOperator& node) {
-    ExecuteLogicalOperators(LogicalOperatorKind::And, node.operands);
-}
-
-void Executor::VisitBinaryRelation(ast::BinaryRelation& node) {
-    shared_ptr<runtime::RuntimeValue> lhs;
-    {
-        auto optLHS = ExecuteExpressionInThis(node.operands[0]);
-        if (!optLHS) return;
-        lhs = *optLHS;
-    }
-    size_t n = node.operators.size();
-    for (size_t i = 0; i < n; i++) {
-        auto op = node.operators[i];
-        auto optRHS = ExecuteExpressionInThis(node.operands[i + 1]);
-        if (!optRHS) return;
-        auto comp = lhs->BinaryComparison(**optRHS);
-        if (!comp) {
-            context.SetThrowingState(
-                runtime::DRuntimeError("Objects of types \"" + lhs->TypeOfValue()->Name() + "\" and \"" +
-                                       optRHS.value()->TypeOfValue()->Name() + "\" are incomparable"),
-                locators::SpanLocator(node.operands[i]->pos, node.operands[i + 1]->pos));
-            return;
-        }
-        bool result = false;
-        switch (op) {
-            case ast::BinaryRelationOperator::Less:
-                result = *comp < 0;
-                break;
-            case ast::BinaryRelationOperator::LessEq:
-                result = *comp <= 0;
-                break;
-            case ast::BinaryRelationOperator::Greater:
-                result = *comp > 0;
-                break;
-            case ast::BinaryRelationOperator::GreaterEq:
-                result = *comp >= 0;
-                break;
-            case ast::BinaryRelationOperator::Equal:
-                result = *comp == 0;
-                break;
-            case ast::BinaryRelationOperator::NotEqual:
-                result = *comp != 0;
-                break;
-        }
-        if (!result) {
-            optExprValue = make_shared<runtime::BoolValue>(false);
-            return;
-        }
-        lhs = *optRHS;
-    }
-    optExprValue = make_shared<runtime::BoolValue>(true);
-}
-
-void Executor::VisitSum(ast::Sum& node) {
-    vector<OperatorKind> ops(node.operators.size());
-    ranges::transform(node.operators, ops.begin(), [](ast::Sum::SumOperator op) {
-        return op == ast::Sum::SumOperator::Plus ? OperatorKind::Plus : OperatorKind::Minus;
-    });
-    ExecuteOperators(node.terms, ops);
-}
-
-void Executor::VisitTerm(ast::Term& node) {
-    vector<OperatorKind> ops(node.operators.size());
-    ranges::transform(node.operators, ops.begin(), [](ast::Term::TermOperator op) {
-        return op == ast::Term::TermOperator::Times ? OperatorKind::Times : OperatorKind::Divide;
-    });
-    ExecuteOperators(node.unaries, ops);
-}
-
-void Executor::VisitUnary(ast::Unary& node) {
-    shared_ptr<runtime::RuntimeValue> val;
-    {
-        auto opt = ExecuteExpressionInThis(node.expr);
-        if (!opt) return;
-        val = *opt;
-    }
-    auto preiter = node.prefixOps.rbegin();
-    auto preend = node.prefixOps.rend();
-    auto postiter = node.postfixOps.begin();
-    auto postend = node.postfixOps.end();
-    UnaryOpExecutor unaryexec(context, scopes, val, node.expr->pos);
-    while (true) {
-        bool executePrefix = true;
-        if (preiter != preend) {
-            if (postiter != postend) executePrefix = (*preiter)->precedence() < (*postiter)->precedence();
-        } else if (postiter != postend)
-            executePrefix = false;
-        else
+void Executor::Execute(CodeIndex statement) {
+    const Node& node = lowered.Nodes[statement];
+    switch (node.op) {
+        case Op::Body:
+            ExecuteBody(node);
             break;
-        shared_ptr<ast::ASTNode> operation =
-            executePrefix ? static_cast<shared_ptr<ast::ASTNode>>(*(preiter++)) : *(postiter++);
-        operation->AcceptVisitor(unaryexec);
-        if (context.State.IsThrowing()) return;
-    }
-    optExprValue = unaryexec.Value();
-}
-
-void Executor::VisitUnaryNot(ast::UnaryNot& node) {
-    auto opt = ExecuteExpressionInThis(node.nested);
-    if (!opt) return;
-    auto res = opt.value()->UnaryNot();
-    if (!res) {
-        context.SetThrowingState(
-            runtime::DRuntimeError("The unary not operator does not support an operand of type \"" +
-                                   opt.value()->TypeOfValue()->Name() + "\""),
-            node.nested->pos);
-        return;
-    }
-    if (res->index()) {
-        context.SetThrowingState(get<1>(*res), node.pos);
-        return;
-    }
-    optExprValue = get<0>(*res);
-}
-
-DISALLOWED_VISIT(PrefixOperator)
-DISALLOWED_VISIT(TypecheckOperator)
-DISALLOWED_VISIT(Call)
-DISALLOWED_VISIT(AccessorOperator)
-
-void Executor::VisitPrimaryIdent(ast::PrimaryIdent& node) {
-    auto var = scopes->Lookup(node.name->identifier);
-    if (!var) {
-        context.SetThrowingState(
-            runtime::DRuntimeError("Referencing an undeclared variable: \"" + node.name->identifier + "\""), node.pos);
-        return;
-    }
-    optExprValue = var.value()->Content();
-}
-
-void Executor::VisitParenthesesExpression(ast::ParenthesesExpression& node) { node.expr->AcceptVisitor(*this); }
-
-DISALLOWED_VISIT(TupleLiteralElement)
-
-void Executor::VisitTupleLiteral(ast::TupleLiteral& node) {
-    size_t n = node.elements.size();
-    set<string> seenNames;
-    vector<pair<optional<string>, shared_ptr<runtime::RuntimeValue>>> vals;
-    vals.reserve(n);
-    for (auto& elem : node.elements) {
-        optional<string> name;
-        if (elem->ident) {
-            if (!seenNames.insert(elem->ident.value()->identifier).second) {
-                auto span = elem->ident.value()->span;
-                context.SetThrowingState(runtime::DRuntimeError("Field name duplicated"),
-                                         locators::SpanLocator(node.pos.File(), span.position, span.length));
-                return;
-            }
-            name.emplace(elem->ident.value()->identifier);
-        }
-        auto opt = ExecuteExpressionInThis(elem->expression);
-        if (!opt) return;
-        vals.emplace_back(name, *opt);
-    }
-    optExprValue = make_shared<runtime::TupleValue>(vals);
-}
-
-DISALLOWED_VISIT(ShortFuncBody)
-DISALLOWED_VISIT(LongFuncBody)
-DISALLOWED_VISIT(FuncLiteral)  // must be replaced with a ClosureDefinition by the semantic analyzer
-
-void Executor::VisitTokenLiteral(ast::TokenLiteral& node) {
-    switch (node.kind) {
-        case ast::TokenLiteral::TokenLiteralKind::False:
-            optExprValue = make_shared<runtime::BoolValue>(false);
+        case Op::Var:
+            ExecuteVar(node);
             break;
-        case ast::TokenLiteral::TokenLiteralKind::True:
-            optExprValue = make_shared<runtime::BoolValue>(true);
+        case Op::If:
+            ExecuteIf(node);
             break;
-        case ast::TokenLiteral::TokenLiteralKind::String:
-            optExprValue = make_shared<runtime::StringValue>(dynamic_cast<StringLiteral&>(*node.token).value);
+        case Op::ShortIf:
+            ExecuteShortIf(node);
             break;
-        case ast::TokenLiteral::TokenLiteralKind::Int:
-            optExprValue = make_shared<runtime::IntegerValue>(dynamic_cast<IntegerToken&>(*node.token).value);
+        case Op::While:
+            ExecuteWhile(node);
             break;
-        case ast::TokenLiteral::TokenLiteralKind::Real:
-            optExprValue = make_shared<runtime::RealValue>(dynamic_cast<RealToken&>(*node.token).value);
+        case Op::For:
+            ExecuteFor(node);
             break;
-        case ast::TokenLiteral::TokenLiteralKind::None:
-            optExprValue = make_shared<runtime::NoneValue>();
+        case Op::Loop:
+            ExecuteLoop(node);
             break;
+        case Op::Exit:
+            context.State = RuntimeState::Exiting();
+            break;
+        case Op::Assign:
+            ExecuteAssign(node);
+            break;
+        case Op::Print:
+            ExecutePrint(node);
+            break;
+        case Op::Return:
+            ExecuteReturn(node);
+            break;
+        case Op::Evaluate:
+            Compute(lowered.Children[node.first]);
+            break;
+        default:
+            throw runtime_error("Executor cannot execute a node that is not a statement");
     }
 }
 
-void Executor::VisitArrayLiteral(ast::ArrayLiteral& node) {
-    size_t n = node.items.size();
-    vector<shared_ptr<runtime::RuntimeValue>> vals;
-    vals.reserve(n);
-    for (auto& elem : node.items) {
-        auto opt = ExecuteExpressionInThis(elem);
-        if (!opt) return;
-        vals.emplace_back(*opt);
-    }
-    optExprValue = make_shared<runtime::ArrayValue>(vals);
-}
-
-void Executor::VisitCustom(ast::ASTNode& node) {
-    auto precomp = dynamic_cast<ast::PrecomputedValue*>(&node);
-    if (precomp) {
-        optExprValue = precomp->Value;
-        return;
-    }
-    auto closdef = dynamic_cast<ast::ClosureDefinition*>(&node);
-    if (!closdef) throw runtime_error("Custom node not recognized by Executor");
-    optExprValue = make_shared<runtime::Closure>(scopes, *closdef);
-}
-
 }  // namespace interp
 }  // namespace dinterp
@@ -1,10 +1,11 @@
 #pragma once
 #include "interp/closure.h"
+#include "interp/evaluator.h"
 #include "interp/execution.h"
 #include "interp/input.h"
+#include "interp/lowered.h"
 #include "interp/runner.h"
 #include "interp/runtimeContext.h"
-#include "interp/unaryOpExec.h"
 #include "interp/userCallable.h"
 #include "interp/varScopes.h"
 #include "interp/variable.h"
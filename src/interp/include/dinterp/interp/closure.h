@@ -1,6 +1,6 @@
 #pragma once
 #include "dinterp/runtime/values.h"
-#include "dinterp/syntaxext/precomputed.h"
+#include "lowered.h"
 #include "runtimeContext.h"
 #include "userCallable.h"
 #include "varScopes.h"
@@ -9,13 +9,21 @@ namespace dinterp {
 namespace runtime {
 
 class Closure : public interp::UserCallable {
-    std::vector<std::string> params;
     std::shared_ptr<interp::ScopeStack> initialScope;
-    std::shared_ptr<ast::FuncBody> code;
-    std::shared_ptr<runtime::FuncType> funcType;
+    std::shared_ptr<const interp::LoweredCode> code;
+    interp::CodeIndex function;
 
 public:
-    Closure(const interp::ScopeStack& values, const ast::ClosureDefinition& def);
+    // The closure of the function `function` of `code`, capturing its externals from `values`
+    Closure(const interp::ScopeStack& values, const std::shared_ptr<const interp::LoweredCode>& code,
+            interp::CodeIndex function);
+    // Runs the body of the function `function` of `code` with the arguments bound to the parameters, in a new scope
+    // on top of `outer`. Returns nullptr if it throws
+    static std::shared_ptr<RuntimeValue> Run(interp::RuntimeContext& context,
+                                             const std::shared_ptr<interp::ScopeStack>& outer,
+                                             const std::shared_ptr<const interp::LoweredCode>& code,
+                                             interp::CodeIndex function,
+                                             const std::vector<std::shared_ptr<RuntimeValue>>& args);
     std::shared_ptr<RuntimeValue> UserCall(interp::RuntimeContext& context,
                                            const std::vector<std::shared_ptr<RuntimeValue>>& args) const override;
     std::shared_ptr<FuncType> FunctionType() const override;
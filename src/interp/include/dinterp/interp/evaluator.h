@@ -0,0 +1,33 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "dinterp/semantic/callEvaluator.h"
+#include "lowered.h"
+
+namespace dinterp {
+namespace interp {
+
+// Evaluates the pure calls found by the semantic analysis with the interpreter, each under a budget of steps, memory
+// and call depth; the calls that run out of it are left to the runtime. All the evaluations of one analysis also
+// share a budget of steps, so that it stays fast however many calls it finds
+class BoundedEvaluator : public semantic::ICallEvaluator {
+    size_t stepsLeft;
+    // The code of each closure evaluated, lowered on its first call. The closure is kept with it, so that no other
+    // closure takes its address
+    std::unordered_map<const ast::ClosureDefinition*,
+                       std::pair<std::shared_ptr<const ast::ASTNode>, std::shared_ptr<const LoweredCode>>>
+        lowered;
+
+public:
+    BoundedEvaluator();
+    std::shared_ptr<runtime::RuntimeValue> Evaluate(
+        const ast::ClosureDefinition& closure,
+        const std::vector<std::pair<std::string, std::shared_ptr<runtime::RuntimeValue>>>& captured,
+        const std::vector<std::shared_ptr<runtime::RuntimeValue>>& args) override;
+    virtual ~BoundedEvaluator() override = default;
+};
+
+}  // namespace interp
+}  // namespace dinterp
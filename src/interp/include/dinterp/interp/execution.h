@@ -1,70 +1,57 @@
 #pragma once
+#include <memory>
+
+#include "dinterp/locators/locator.h"
 #include "dinterp/runtime/values.h"
-#include "dinterp/syntax.h"
+#include "lowered.h"
 #include "runtimeContext.h"
 #include "varScopes.h"
 
 namespace dinterp {
 namespace interp {
 
-class Executor : public ast::IASTVisitor {
+// Runs the statements and evaluates the expressions of a `LoweredCode` in a stack of scopes
+class Executor {
+    using Node = LoweredCode::Node;
     RuntimeContext& context;
+    std::shared_ptr<const LoweredCode> code;
+    const LoweredCode& lowered;
     std::shared_ptr<ScopeStack> scopes;
-    std::shared_ptr<runtime::RuntimeValue> optExprValue;
-    std::optional<std::shared_ptr<runtime::RuntimeValue>> ExecuteExpressionInThis(
-        const std::shared_ptr<ast::Expression>& expr);
-    enum class OperatorKind { Plus, Minus, Times, Divide };
+    // Set by `x := <sum or term>` for the outermost operator chain of the source: the last operation may then reuse
+    // x's current value in place, since x is about to be overwritten with the result anyway
+    std::shared_ptr<Variable> inPlaceTarget;
     enum class LogicalOperatorKind { And, Or, Xor };
-    void ExecuteOperators(const std::vector<std::shared_ptr<ast::Expression>>& operands,
-                          const std::vector<OperatorKind>& ops);
-    void ExecuteLogicalOperators(LogicalOperatorKind kind,
-                                 const std::vector<std::shared_ptr<ast::Expression>>& operands);
+
+    // nullptr if the runtime stopped running (or the expression left no value)
+    std::shared_ptr<runtime::RuntimeValue> Compute(CodeIndex index);
+    std::shared_ptr<runtime::RuntimeValue> ExecuteOperators(const Node& node);
+    std::shared_ptr<runtime::RuntimeValue> ExecuteLogicalOperators(LogicalOperatorKind kind, const Node& node);
+    std::shared_ptr<runtime::RuntimeValue> ExecuteRelation(const Node& node);
+    std::shared_ptr<runtime::RuntimeValue> ExecuteUnary(const Node& node);
+    std::shared_ptr<runtime::RuntimeValue> ExecuteTuple(const Node& node);
+    std::shared_ptr<runtime::RuntimeValue> ExecuteInlined(const Node& node);
+    // Applies the prefix or postfix operator `op` to `value`, which spans `pos`; false if it throws
+    bool ApplyOperator(const Node& op, std::shared_ptr<runtime::RuntimeValue>& value, locators::SpanLocator& pos);
+    bool AccessFieldByIndex(std::shared_ptr<runtime::RuntimeValue>& value, locators::SpanLocator& pos,
+                            const runtime::RuntimeValue& index, const locators::SpanLocator& accessorPos);
+    bool ApplyCall(const Node& call, std::shared_ptr<runtime::RuntimeValue>& value, locators::SpanLocator& pos);
+    void ExecuteBody(const Node& node);
+    void ExecuteVar(const Node& node);
+    void ExecuteIf(const Node& node);
+    void ExecuteShortIf(const Node& node);
+    void ExecuteWhile(const Node& node);
+    void ExecuteFor(const Node& node);
+    void ExecuteLoop(const Node& node);
+    void ExecuteAssign(const Node& node);
+    void ExecutePrint(const Node& node);
+    void ExecuteReturn(const Node& node);
 
 public:
-    Executor(RuntimeContext& context, const std::shared_ptr<ScopeStack>& scopes);
-    const std::shared_ptr<runtime::RuntimeValue>& ExpressionValue() const;  // throws if no expression visited
-    void VisitBody(ast::Body& node) override;
-    void VisitVarStatement(ast::VarStatement& node) override;
-    void VisitIfStatement(ast::IfStatement& node) override;
-    void VisitShortIfStatement(ast::ShortIfStatement& node) override;
-    void VisitWhileStatement(ast::WhileStatement& node) override;
-    void VisitForStatement(ast::ForStatement& node) override;
-    void VisitLoopStatement(ast::LoopStatement& node) override;
-    void VisitExitStatement(ast::ExitStatement& node) override;
-    void VisitAssignStatement(ast::AssignStatement& node) override;
-    void VisitPrintStatement(ast::PrintStatement& node) override;
-    void VisitReturnStatement(ast::ReturnStatement& node) override;
-    void VisitExpressionStatement(ast::ExpressionStatement& node) override;
-    void VisitCommaExpressions(ast::CommaExpressions& node) override;
-    void VisitCommaIdents(ast::CommaIdents& node) override;
-    void VisitIdentMemberAccessor(ast::IdentMemberAccessor& node) override;
-    void VisitIntLiteralMemberAccessor(ast::IntLiteralMemberAccessor& node) override;
-    void VisitParenMemberAccessor(ast::ParenMemberAccessor& node) override;
-    void VisitIndexAccessor(ast::IndexAccessor& node) override;
-    void VisitReference(ast::Reference& node) override;
-    void VisitXorOperator(ast::XorOperator& node) override;
-    void VisitOrOperator(ast::OrOperator& node) override;
-    void VisitAndOperator(ast::AndOperator& node) override;
-    void VisitBinaryRelation(ast::BinaryRelation& node) override;
-    void VisitSum(ast::Sum& node) override;
-    void VisitTerm(ast::Term& node) override;
-    void VisitUnary(ast::Unary& node) override;
-    void VisitUnaryNot(ast::UnaryNot& node) override;
-    void VisitPrefixOperator(ast::PrefixOperator& node) override;
-    void VisitTypecheckOperator(ast::TypecheckOperator& node) override;
-    void VisitCall(ast::Call& node) override;
-    void VisitAccessorOperator(ast::AccessorOperator& node) override;
-    void VisitPrimaryIdent(ast::PrimaryIdent& node) override;
-    void VisitParenthesesExpression(ast::ParenthesesExpression& node) override;
-    void VisitTupleLiteralElement(ast::TupleLiteralElement& node) override;
-    void VisitTupleLiteral(ast::TupleLiteral& node) override;
-    void VisitShortFuncBody(ast::ShortFuncBody& node) override;
-    void VisitLongFuncBody(ast::LongFuncBody& node) override;
-    void VisitFuncLiteral(ast::FuncLiteral& node) override;
-    void VisitTokenLiteral(ast::TokenLiteral& node) override;
-    void VisitArrayLiteral(ast::ArrayLiteral& node) override;
-    void VisitCustom(ast::ASTNode& node) override;
-    virtual ~Executor() override = default;
+    Executor(RuntimeContext& context, const std::shared_ptr<const LoweredCode>& code,
+             const std::shared_ptr<ScopeStack>& scopes);
+    void Execute(CodeIndex statement);
+    // nullptr if the runtime stopped running; throws if the expression left no value
+    std::shared_ptr<runtime::RuntimeValue> Evaluate(CodeIndex expression);
 };
 
 }  // namespace interp
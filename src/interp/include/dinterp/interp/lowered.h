@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "dinterp/locators/locator.h"
+#include "dinterp/runtime/types.h"
+#include "dinterp/runtime/values.h"
+#include "dinterp/syntaxext/precomputed.h"
+
+namespace dinterp {
+namespace interp {
+
+// The index of a node, a name, a constant or a function of a `LoweredCode`
+using CodeIndex = std::uint32_t;
+
+/*
+ * The checked syntax tree in the form that the interpreter runs. All the nodes are in one vector, each followed by its
+ * subtrees, and refer to their children by 32-bit indices instead of pointers; the bodies of the closures come after the
+ * code that defines them. What the tree walk used to find out from the types of the nodes is settled here: the order in
+ * which the prefix and postfix operators of an unary apply, whether a body declares variables and whether an assignment
+ * may update the variable's value in place.
+ *
+ * The code is shared by the closures it defines, which run their bodies from it.
+ */
+class LoweredCode {
+public:
+    enum class Op : std::uint8_t {
+        // Statements
+        Body,         // children: the statements; `kind` is 1 if it declares variables
+        Var,          // children: `Declare`s
+        Declare,      // `data`: the name, `pos`: the name; children: the initializer, if any
+        If,           // children: the condition, the body, the `else` body if any
+        ShortIf,      // children: the condition, the statement
+        While,        // children: the condition, the body
+        For,          // `kind`: `ForFlags`; `data`: the name of the variable; children: the start, the end, the body
+        Loop,         // children: the body
+        Exit,         //
+        Assign,       // `kind` is 1 if it may update in place; children: the value, the `Ident` assigned, accessors
+        Print,        // children: the expressions
+        Return,       // children: the value, if any
+        Evaluate,     // children: the expression
+        // Expressions
+        Xor,          // children: the operands
+        Or,           //
+        And,          //
+        Relation,     // `data`: the first of the `ast::BinaryRelationOperator`s in `Operators`; children: the operands
+        Arithmetic,   // `data`: the first of the `ArithmeticOperator`s in `Operators`; children: the operands
+        Unary,        // children: the operand, then the operators in the order they apply
+        Not,          // children: the operand
+        Ident,        // `data`: the name
+        Parentheses,  // children: the expression
+        Tuple,        // children: `TupleElement`s
+        TupleElement, // `data`: the name or NO_NAME, `pos`: the name; children: the value
+        Constant,     // `data`: the constant
+        Array,        // children: the items
+        Closure,      // `data`: the function
+        Hoisted,      // `data`: the name of the variable that keeps the value; children: the expression
+        Inlined,      // `data`: the function called; children: the arguments
+        // The operators of an unary, applied to the value before them
+        Prefix,       // `kind`: the `ast::PrefixOperator::PrefixOperatorKind`
+        Typecheck,    // `kind`: the `ast::TypeId`
+        Call,         // children: the arguments
+        Field,        // `data`: the name
+        IntField,     // `data`: the index, as a constant
+        ParenField,   // children: the index
+        Index,        // children: the subscript
+    };
+    enum class ArithmeticOperator : std::uint8_t { Plus, Minus, Times, Divide };
+    enum ForFlags : std::uint8_t { HasVariable = 1, HasEnd = 2 };
+    static constexpr CodeIndex NO_NAME = ~CodeIndex(0);
+
+    struct Node {
+        locators::SpanLocator pos;
+        Op op;
+        std::uint8_t kind = 0;
+        CodeIndex first = 0;  // the first child in `Children`
+        CodeIndex count = 0;  // the number of children
+        CodeIndex data = 0;
+    };
+
+    struct Function {
+        std::shared_ptr<runtime::FuncType> Type;
+        std::vector<std::string> Params;
+        std::vector<std::string> CapturedExternals;
+        locators::SpanLocator Pos;
+        // The body of the function, or the expression it returns if that is all its body does
+        CodeIndex Body;
+        bool ReturnsExpression;
+    };
+
+    std::vector<Node> Nodes;
+    std::vector<CodeIndex> Children;
+    std::vector<std::uint8_t> Operators;
+    std::vector<std::string> Names;
+    std::vector<std::shared_ptr<runtime::RuntimeValue>> Constants;
+    std::vector<Function> Functions;
+    CodeIndex Root = 0;  // the program's body, or the function that was lowered
+
+    std::span<const CodeIndex> ChildrenOf(const Node& node) const {
+        return {Children.data() + node.first, node.count};
+    }
+    // The tree must be checked: a `FuncLiteral` left in it throws `std::runtime_error`
+    static std::shared_ptr<const LoweredCode> FromProgram(ast::Body& program);
+    static std::shared_ptr<const LoweredCode> FromClosure(const ast::ClosureDefinition& closure);
+};
+
+}  // namespace interp
+}  // namespace dinterp
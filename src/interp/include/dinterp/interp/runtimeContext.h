@@ -1,5 +1,6 @@
 #pragma once
 #include <iostream>
+#include <optional>
 #include <variant>
 #include <vector>
 
@@ -79,9 +80,21 @@ public:
     CallStack Stack;
     const size_t StackTraceMaxEntries;
     RuntimeState State;
+    // The budget of a bounded run, unlimited if not set: each statement and each call takes a step, and each value
+    // stored in a variable or returned takes about its size in bytes from the memory
+    std::optional<size_t> StepsLeft;
+    std::optional<size_t> MemoryLeft;
     RuntimeContext(std::istream& input, std::ostream& output, size_t callStackCapacity, size_t stackTraceMaxEntries);
     CallStackTrace MakeStackTrace() const;
     void SetThrowingState(const runtime::DRuntimeError& error, const locators::SpanLocator& pos);
+    // Both return false and set the throwing state when the budget runs out. Only needed when it is set
+    bool TakeStep(const locators::SpanLocator& pos);
+    bool TakeMemory(const runtime::RuntimeValue& value, const locators::SpanLocator& pos);
+    // The same for a value of about `size` bytes that is yet to be built, without taking the memory: it is taken when
+    // the value is stored
+    bool FitsInMemory(size_t size, const locators::SpanLocator& pos);
+    // About the number of bytes that the memory budget counts for a value
+    static size_t ApproximateSize(const runtime::RuntimeValue& value);
 };
 
 }  // namespace interp
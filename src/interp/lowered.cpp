@@ -0,0 +1,402 @@
+#include "dinterp/interp/lowered.h"
+
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "dinterp/syntax.h"
+using namespace std;
+
+namespace dinterp {
+namespace interp {
+
+using Op = LoweredCode::Op;
+
+// Lowers the nodes it visits into `code`, leaving the index of the last node made in `result`; the bodies of the
+// closures are lowered by `Finish`, after the code that defines them
+class Lowerer : public ast::IASTVisitor {
+    LoweredCode& code;
+    CodeIndex result = 0;
+    unordered_map<string, CodeIndex> names;
+    unordered_map<const ast::ClosureDefinition*, CodeIndex> functions;
+    vector<const ast::ClosureDefinition*> pending;  // by function index
+
+    CodeIndex Add(const locators::SpanLocator& pos, Op op, uint8_t kind = 0, CodeIndex data = 0) {
+        if (code.Nodes.size() == numeric_limits<CodeIndex>::max()) throw length_error("The program is too large");
+        code.Nodes.push_back({pos, op, kind, 0, 0, data});
+        return code.Nodes.size() - 1;
+    }
+    void SetChildren(CodeIndex node, const vector<CodeIndex>& children) {
+        code.Nodes[node].first = code.Children.size();
+        code.Nodes[node].count = children.size();
+        code.Children.insert(code.Children.end(), children.begin(), children.end());
+    }
+    template <typename Nodes>
+    vector<CodeIndex> LowerAll(const Nodes& nodes) {
+        vector<CodeIndex> res;
+        res.reserve(nodes.size());
+        for (auto& node : nodes) res.push_back(Lower(*node));
+        return res;
+    }
+    // A node whose children are `children`, made before them so that it precedes its subtrees
+    template <typename Nodes>
+    void AddWithChildren(const locators::SpanLocator& pos, Op op, const Nodes& children, CodeIndex data = 0) {
+        auto node = Add(pos, op, 0, data);
+        SetChildren(node, LowerAll(children));
+        result = node;
+    }
+    CodeIndex Name(const string& name) {
+        auto [iter, added] = names.emplace(name, code.Names.size());
+        if (added) code.Names.push_back(name);
+        return iter->second;
+    }
+    CodeIndex Constant(const shared_ptr<runtime::RuntimeValue>& value) {
+        code.Constants.push_back(value);
+        return code.Constants.size() - 1;
+    }
+    static locators::SpanLocator IdentPos(const locators::SpanLocator& around, const IdentifierToken& ident) {
+        return locators::SpanLocator(around.File(), ident.span.position, ident.span.length);
+    }
+
+public:
+    Lowerer(LoweredCode& code) : code(code) {}
+
+    CodeIndex Lower(ast::ASTNode& node) {
+        node.AcceptVisitor(*this);
+        return result;
+    }
+
+    // The function of a closure, lowered the first time it is met
+    CodeIndex Function(const ast::ClosureDefinition& closure) {
+        auto [iter, added] = functions.emplace(&closure, code.Functions.size());
+        if (added) {
+            code.Functions.push_back({closure.Type, closure.Params, closure.CapturedExternals, closure.Definition->pos,
+                                      0, false});
+            pending.push_back(&closure);
+        }
+        return iter->second;
+    }
+
+    // Lowers the bodies of the functions met so far, and of the ones met in them
+    void Finish() {
+        for (size_t i = 0; i < pending.size(); i++) {
+            auto& definition = *pending[i]->Definition;
+            CodeIndex body;
+            bool returnsExpression = true;
+            if (auto longBody = dynamic_cast<ast::LongFuncBody*>(&definition)) {
+                auto& statements = longBody->funcBody->statements;
+                // a checked short-form function is a body that only returns its expression, which needs no scope of
+                // its own
+                auto onlyReturn =
+                    statements.size() == 1 ? dynamic_cast<ast::ReturnStatement*>(statements[0].get()) : nullptr;
+                if (onlyReturn && onlyReturn->returnValue)
+                    body = Lower(**onlyReturn->returnValue);
+                else {
+                    body = Lower(*longBody->funcBody);
+                    returnsExpression = false;
+                }
+            } else
+                body = Lower(*dynamic_cast<ast::ShortFuncBody&>(definition).expressionToReturn);
+            code.Functions[i].Body = body;
+            code.Functions[i].ReturnsExpression = returnsExpression;
+        }
+    }
+
+    void VisitBody(ast::Body& node) override {
+        auto body = Add(node.pos, Op::Body);
+        for (auto& stmt : node.statements)
+            if (dynamic_cast<const ast::VarStatement*>(stmt.get())) code.Nodes[body].kind = 1;
+        SetChildren(body, LowerAll(node.statements));
+        result = body;
+    }
+
+    void VisitVarStatement(ast::VarStatement& node) override {
+        auto var = Add(node.pos, Op::Var);
+        vector<CodeIndex> declarations;
+        for (auto& [name, init] : node.definitions) {
+            auto declaration = Add(IdentPos(node.pos, *name), Op::Declare, 0, Name(name->identifier));
+            if (init) SetChildren(declaration, {Lower(**init)});
+            declarations.push_back(declaration);
+        }
+        SetChildren(var, declarations);
+        result = var;
+    }
+
+    void VisitIfStatement(ast::IfStatement& node) override {
+        auto stmt = Add(node.pos, Op::If);
+        vector<CodeIndex> children = {Lower(*node.condition), Lower(*node.doIfTrue)};
+        if (node.doIfFalse) children.push_back(Lower(**node.doIfFalse));
+        SetChildren(stmt, children);
+        result = stmt;
+    }
+
+    void VisitShortIfStatement(ast::ShortIfStatement& node) override {
+        auto stmt = Add(node.pos, Op::ShortIf);
+        SetChildren(stmt, {Lower(*node.condition), Lower(*node.doIfTrue)});
+        result = stmt;
+    }
+
+    void VisitWhileStatement(ast::WhileStatement& node) override {
+        auto stmt = Add(node.pos, Op::While);
+        SetChildren(stmt, {Lower(*node.condition), Lower(*node.action)});
+        result = stmt;
+    }
+
+    void VisitForStatement(ast::ForStatement& node) override {
+        uint8_t flags = (node.optVariableName ? LoweredCode::HasVariable : 0) | (node.end ? LoweredCode::HasEnd : 0);
+        auto stmt = Add(node.pos, Op::For, flags,
+                        node.optVariableName ? Name(node.optVariableName.value()->identifier) : 0);
+        vector<CodeIndex> children = {Lower(*node.startOrList)};
+        if (node.end) children.push_back(Lower(**node.end));
+        children.push_back(Lower(*node.action));
+        SetChildren(stmt, children);
+        result = stmt;
+    }
+
+    void VisitLoopStatement(ast::LoopStatement& node) override {
+        auto stmt = Add(node.pos, Op::Loop);
+        SetChildren(stmt, {Lower(*node.body)});
+        result = stmt;
+    }
+
+    void VisitExitStatement(ast::ExitStatement& node) override { result = Add(node.pos, Op::Exit); }
+
+    void VisitAssignStatement(ast::AssignStatement& node) override {
+        auto& dest = *node.dest;
+        // the last operation of `x := <sum or term>` may reuse x's value, which is about to be overwritten anyway
+        bool inPlace = dest.accessorChain.empty() &&
+                       (dynamic_cast<ast::Sum*>(node.src.get()) || dynamic_cast<ast::Term*>(node.src.get()));
+        auto stmt = Add(node.pos, Op::Assign, inPlace);
+        vector<CodeIndex> children = {Lower(*node.src),
+                                      Add(IdentPos(node.pos, *dest.baseIdent), Op::Ident, 0,
+                                          Name(dest.baseIdent->identifier))};
+        for (auto& accessor : dest.accessorChain) children.push_back(Lower(*accessor));
+        SetChildren(stmt, children);
+        result = stmt;
+    }
+
+    void VisitPrintStatement(ast::PrintStatement& node) override {
+        AddWithChildren(node.pos, Op::Print, node.expressions);
+    }
+
+    void VisitReturnStatement(ast::ReturnStatement& node) override {
+        auto stmt = Add(node.pos, Op::Return);
+        if (node.returnValue) SetChildren(stmt, {Lower(**node.returnValue)});
+        result = stmt;
+    }
+
+    void VisitExpressionStatement(ast::ExpressionStatement& node) override {
+        auto stmt = Add(node.pos, Op::Evaluate);
+        SetChildren(stmt, {Lower(*node.expr)});
+        result = stmt;
+    }
+
+    void VisitCommaExpressions(ast::CommaExpressions&) override {
+        throw runtime_error("Cannot lower CommaExpressions");
+    }
+    void VisitCommaIdents(ast::CommaIdents&) override { throw runtime_error("Cannot lower CommaIdents"); }
+
+    void VisitIdentMemberAccessor(ast::IdentMemberAccessor& node) override {
+        result = Add(node.pos, Op::Field, 0, Name(node.name->identifier));
+    }
+
+    void VisitIntLiteralMemberAccessor(ast::IntLiteralMemberAccessor& node) override {
+        result = Add(node.pos, Op::IntField, 0, Constant(make_shared<runtime::IntegerValue>(node.index->value)));
+    }
+
+    void VisitParenMemberAccessor(ast::ParenMemberAccessor& node) override {
+        auto accessor = Add(node.pos, Op::ParenField);
+        SetChildren(accessor, {Lower(*node.expr)});
+        result = accessor;
+    }
+
+    void VisitIndexAccessor(ast::IndexAccessor& node) override {
+        auto accessor = Add(node.pos, Op::Index);
+        SetChildren(accessor, {Lower(*node.expressionInBrackets)});
+        result = accessor;
+    }
+
+    void VisitReference(ast::Reference&) override { throw runtime_error("Cannot lower Reference"); }
+
+    void VisitXorOperator(ast::XorOperator& node) override { AddWithChildren(node.pos, Op::Xor, node.operands); }
+    void VisitOrOperator(ast::OrOperator& node) override { AddWithChildren(node.pos, Op::Or, node.operands); }
+    void VisitAndOperator(ast::AndOperator& node) override { AddWithChildren(node.pos, Op::And, node.operands); }
+
+    void VisitBinaryRelation(ast::BinaryRelation& node) override {
+        CodeIndex operators = code.Operators.size();
+        for (auto op : node.operators) code.Operators.push_back(static_cast<uint8_t>(op));
+        AddWithChildren(node.pos, Op::Relation, node.operands, operators);
+    }
+
+    void VisitSum(ast::Sum& node) override {
+        CodeIndex operators = code.Operators.size();
+        for (auto op : node.operators)
+            code.Operators.push_back(static_cast<uint8_t>(op == ast::Sum::SumOperator::Plus
+                                                              ? LoweredCode::ArithmeticOperator::Plus
+                                                              : LoweredCode::ArithmeticOperator::Minus));
+        AddWithChildren(node.pos, Op::Arithmetic, node.terms, operators);
+    }
+
+    void VisitTerm(ast::Term& node) override {
+        CodeIndex operators = code.Operators.size();
+        for (auto op : node.operators)
+            code.Operators.push_back(static_cast<uint8_t>(op == ast::Term::TermOperator::Times
+                                                              ? LoweredCode::ArithmeticOperator::Times
+                                                              : LoweredCode::ArithmeticOperator::Divide));
+        AddWithChildren(node.pos, Op::Arithmetic, node.unaries, operators);
+    }
+
+    void VisitUnary(ast::Unary& node) override {
+        auto unary = Add(node.pos, Op::Unary);
+        vector<CodeIndex> children = {Lower(*node.expr)};
+        // the prefix operators apply from the innermost one, merged with the postfix ones by precedence
+        auto preiter = node.prefixOps.rbegin();
+        auto preend = node.prefixOps.rend();
+        auto postiter = node.postfixOps.begin();
+        auto postend = node.postfixOps.end();
+        while (true) {
+            bool lowerPrefix = true;
+            if (preiter != preend) {
+                if (postiter != postend) lowerPrefix = (*preiter)->precedence() < (*postiter)->precedence();
+            } else if (postiter != postend)
+                lowerPrefix = false;
+            else
+                break;
+            ast::ASTNode& operation = lowerPrefix ? static_cast<ast::ASTNode&>(**(preiter++)) : **(postiter++);
+            children.push_back(Lower(operation));
+        }
+        SetChildren(unary, children);
+        result = unary;
+    }
+
+    void VisitUnaryNot(ast::UnaryNot& node) override {
+        auto unaryNot = Add(node.pos, Op::Not);
+        SetChildren(unaryNot, {Lower(*node.nested)});
+        result = unaryNot;
+    }
+
+    void VisitPrefixOperator(ast::PrefixOperator& node) override {
+        result = Add(node.pos, Op::Prefix, static_cast<uint8_t>(node.kind));
+    }
+
+    void VisitTypecheckOperator(ast::TypecheckOperator& node) override {
+        result = Add(node.pos, Op::Typecheck, static_cast<uint8_t>(node.typeId));
+    }
+
+    void VisitCall(ast::Call& node) override { AddWithChildren(node.pos, Op::Call, node.args); }
+
+    void VisitAccessorOperator(ast::AccessorOperator& node) override { node.accessor->AcceptVisitor(*this); }
+
+    void VisitPrimaryIdent(ast::PrimaryIdent& node) override {
+        result = Add(node.pos, Op::Ident, 0, Name(node.name->identifier));
+    }
+
+    void VisitParenthesesExpression(ast::ParenthesesExpression& node) override {
+        auto paren = Add(node.pos, Op::Parentheses);
+        SetChildren(paren, {Lower(*node.expr)});
+        result = paren;
+    }
+
+    void VisitTupleLiteralElement(ast::TupleLiteralElement&) override {
+        throw runtime_error("Cannot lower TupleLiteralElement outside of a tuple");
+    }
+
+    void VisitTupleLiteral(ast::TupleLiteral& node) override {
+        auto tuple = Add(node.pos, Op::Tuple);
+        set<string> seenNames;
+        vector<CodeIndex> elements;
+        for (auto& elem : node.elements) {
+            CodeIndex element;
+            if (elem->ident) {
+                auto& ident = *elem->ident.value();
+                // a repeated name is reported when the element is reached
+                bool duplicated = !seenNames.insert(ident.identifier).second;
+                element = Add(IdentPos(node.pos, ident), Op::TupleElement, duplicated, Name(ident.identifier));
+            } else
+                element = Add(elem->pos, Op::TupleElement, 0, LoweredCode::NO_NAME);
+            SetChildren(element, {Lower(*elem->expression)});
+            elements.push_back(element);
+        }
+        SetChildren(tuple, elements);
+        result = tuple;
+    }
+
+    void VisitShortFuncBody(ast::ShortFuncBody&) override {
+        throw runtime_error("Cannot lower ShortFuncBody outside of a closure");
+    }
+    void VisitLongFuncBody(ast::LongFuncBody&) override {
+        throw runtime_error("Cannot lower LongFuncBody outside of a closure");
+    }
+    void VisitFuncLiteral(ast::FuncLiteral&) override {
+        // must be replaced with a ClosureDefinition by the semantic analyzer
+        throw runtime_error("Cannot lower FuncLiteral");
+    }
+
+    void VisitTokenLiteral(ast::TokenLiteral& node) override {
+        shared_ptr<runtime::RuntimeValue> value;
+        switch (node.kind) {
+            case ast::TokenLiteral::TokenLiteralKind::False:
+                value = make_shared<runtime::BoolValue>(false);
+                break;
+            case ast::TokenLiteral::TokenLiteralKind::True:
+                value = make_shared<runtime::BoolValue>(true);
+                break;
+            case ast::TokenLiteral::TokenLiteralKind::String:
+                value = make_shared<runtime::StringValue>(dynamic_cast<StringLiteral&>(*node.token).value);
+                break;
+            case ast::TokenLiteral::TokenLiteralKind::Int:
+                value = make_shared<runtime::IntegerValue>(dynamic_cast<IntegerToken&>(*node.token).value);
+                break;
+            case ast::TokenLiteral::TokenLiteralKind::Real:
+                value = make_shared<runtime::RealValue>(dynamic_cast<RealToken&>(*node.token).value);
+                break;
+            case ast::TokenLiteral::TokenLiteralKind::None:
+                value = make_shared<runtime::NoneValue>();
+                break;
+        }
+        result = Add(node.pos, Op::Constant, 0, Constant(value));
+    }
+
+    void VisitArrayLiteral(ast::ArrayLiteral& node) override { AddWithChildren(node.pos, Op::Array, node.items); }
+
+    void VisitCustom(ast::ASTNode& node) override {
+        if (auto precomp = dynamic_cast<ast::PrecomputedValue*>(&node)) {
+            result = Add(node.pos, Op::Constant, 0, Constant(precomp->Value));
+            return;
+        }
+        if (auto hoisted = dynamic_cast<ast::HoistedValue*>(&node)) {
+            auto value = Add(node.pos, Op::Hoisted, 0, Name(hoisted->Name));
+            SetChildren(value, {Lower(*hoisted->Expr)});
+            result = value;
+            return;
+        }
+        if (auto inlined = dynamic_cast<ast::InlinedCall*>(&node)) {
+            AddWithChildren(node.pos, Op::Inlined, inlined->Args, Function(*inlined->Callee));
+            return;
+        }
+        auto closdef = dynamic_cast<ast::ClosureDefinition*>(&node);
+        if (!closdef) throw runtime_error("Custom node not recognized by the lowering");
+        result = Add(node.pos, Op::Closure, 0, Function(*closdef));
+    }
+};
+
+shared_ptr<const LoweredCode> LoweredCode::FromProgram(ast::Body& program) {
+    auto code = make_shared<LoweredCode>();
+    Lowerer lowerer(*code);
+    code->Root = lowerer.Lower(program);
+    lowerer.Finish();
+    return code;
+}
+
+shared_ptr<const LoweredCode> LoweredCode::FromClosure(const ast::ClosureDefinition& closure) {
+    auto code = make_shared<LoweredCode>();
+    Lowerer lowerer(*code);
+    code->Root = lowerer.Function(closure);
+    lowerer.Finish();
+    return code;
+}
+
+}  // namespace interp
+}  // namespace dinterp
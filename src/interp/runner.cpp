@@ -2,6 +2,7 @@
 
 #include "dinterp/interp/execution.h"
 #include "dinterp/interp/input.h"
+#include "dinterp/interp/lowered.h"
 #include "dinterp/interp/varScopes.h"
 using namespace std;
 
@@ -11,8 +12,9 @@ namespace interp {
 void Run(interp::RuntimeContext& context, ast::Body& program) {
     auto scopes = make_shared<ScopeStack>();
     scopes->Declare(make_shared<Variable>("input", make_shared<interp::InputFunction>()));
-    Executor exec(context, scopes);
-    program.AcceptVisitor(exec);
+    auto code = LoweredCode::FromProgram(program);
+    Executor exec(context, code, scopes);
+    exec.Execute(code->Root);
 }
 
 }  // namespace interp
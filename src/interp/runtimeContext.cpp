@@ -1,6 +1,7 @@
 #include "dinterp/interp/runtimeContext.h"
 
 #include "dinterp/locators/locator.h"
+#include "dinterp/runtime/types.h"
 using namespace std;
 
 namespace dinterp {
@@ -170,5 +171,44 @@ void RuntimeContext::SetThrowingState(const runtime::DRuntimeError& error, const
     State = RuntimeState::Throwing(error, pos, MakeStackTrace());
 }
 
+bool RuntimeContext::TakeStep(const locators::SpanLocator& pos) {
+    if (!StepsLeft) return true;
+    if (*StepsLeft == 0) {
+        SetThrowingState(runtime::DRuntimeError("Out of steps"), pos);
+        return false;
+    }
+    --*StepsLeft;
+    return true;
+}
+
+// The elements of arrays and tuples are counted when they are stored
+size_t RuntimeContext::ApproximateSize(const runtime::RuntimeValue& value) {
+    const size_t REFERENCE = sizeof(shared_ptr<runtime::RuntimeValue>);
+    if (auto integer = dynamic_cast<const runtime::IntegerValue*>(&value))
+        return REFERENCE + integer->Value().SignificantBits() / 8;
+    if (auto str = dynamic_cast<const runtime::StringValue*>(&value)) return REFERENCE + str->Value().size();
+    if (auto arr = dynamic_cast<const runtime::ArrayValue*>(&value)) return REFERENCE * (1 + 2 * arr->Value.size());
+    if (auto tuple = dynamic_cast<const runtime::TupleValue*>(&value))
+        return REFERENCE * (1 + tuple->Values().size());
+    return REFERENCE;
+}
+
+bool RuntimeContext::TakeMemory(const runtime::RuntimeValue& value, const locators::SpanLocator& pos) {
+    if (!MemoryLeft) return true;
+    size_t size = ApproximateSize(value);
+    if (*MemoryLeft < size) {
+        SetThrowingState(runtime::DRuntimeError("Out of memory"), pos);
+        return false;
+    }
+    *MemoryLeft -= size;
+    return true;
+}
+
+bool RuntimeContext::FitsInMemory(size_t size, const locators::SpanLocator& pos) {
+    if (!MemoryLeft || size <= *MemoryLeft) return true;
+    SetThrowingState(runtime::DRuntimeError("Out of memory"), pos);
+    return false;
+}
+
 }  // namespace interp
 }  // namespace dinterp
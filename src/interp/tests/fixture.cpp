@@ -3,6 +3,7 @@
 #include <sstream>
 
 #include "dinterp/complog/CompilationMessage.h"
+#include "dinterp/interp/evaluator.h"
 #include "dinterp/interp/runner.h"
 #include "dinterp/interp/runtimeContext.h"
 #include "dinterp/lexer.h"
@@ -21,20 +22,21 @@ void Sample::ReadFile(const char* name, bool compiles) {
     ss << fs.rdbuf();
     filename = name;
     file = make_shared<locators::CodeFile>(name, ss.str());
-    auto opttks = Lexer::tokenize(file, log, false);
+    auto opttks = Lexer::tokenizeCompact(file, log, false);
     if (!opttks) {
         if (!compiles) return;
         log.WriteToStream(cerr, complog::CompilationMessage::FormatOptions::All(100));
         FAIL() << "Lexer error\n";
     }
-    auto optprog = SyntaxAnalyzer::analyze(*opttks, file, log);
+    auto optprog = SyntaxAnalyzer::analyze(std::move(*opttks), file, log);
     if (!optprog) {
         if (!compiles) return;
         log.WriteToStream(cerr, complog::CompilationMessage::FormatOptions::All(100));
         FAIL() << "Syntax error\n";
     }
     program = *optprog;
-    if (!semantic::Analyze(log, program)) {
+    BoundedEvaluator evaluator;
+    if (!semantic::Analyze(log, program, &evaluator)) {
         if (!compiles) return;
         log.WriteToStream(cerr, complog::CompilationMessage::FormatOptions::All(100));
         FAIL() << "Semantic error\n";
@@ -64,3 +66,17 @@ void Sample::RunAndExpectCrash(const char* input) {
     interp::Run(context, *program);
     ASSERT_TRUE(context.State.IsThrowing());
 }
+
+void Sample::RunAndExpectCrashAt(const char* input, const char* output, const char* position, const char* caller) {
+    istringstream sin(input);
+    ostringstream sout;
+    RuntimeContext context(sin, sout, 1000, 10);
+    interp::Run(context, *program);
+    ASSERT_TRUE(context.State.IsThrowing());
+    ASSERT_EQ(sout.str(), output);
+    auto& detail = context.State.GetError();
+    EXPECT_EQ(detail.Position.Excerpt(), position);
+    ostringstream trace;
+    detail.StackTrace.WriteToStream(trace);
+    EXPECT_NE(trace.str().find(caller), string::npos) << trace.str();
+}
@@ -17,6 +17,8 @@ public:
     void ReadFile(const char* name, bool compiles);
     void RunAndExpect(const char* input, const char* output);
     void RunAndExpectCrash(const char* input);
+    // Expects the program to print `output`, then to fail at the code `position` with `caller` in the stack trace
+    void RunAndExpectCrashAt(const char* input, const char* output, const char* position, const char* caller);
 };
 
 }  // namespace interp
@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
+#include "dinterp/interp/lowered.h"
+#include "dinterp/runtime/values.h"
+#include "dinterp/syntaxext/precomputed.h"
 #include "fixture.h"
 
 using namespace std;
@@ -309,6 +314,110 @@ false
 )");
 }
 
+TEST_F(Sample, ExtraIntMethods) {
+    ReadFile("samples/extra/intmethods.d", true);
+    RunAndExpect("", R"(1267650600228229401496703205376
+688423210
+6 1000000000000000
+-4 92233720368547758080
+8 14 -13
+16
+)");
+}
+
+TEST_F(Sample, ExtraHugeInts) {
+    ReadFile("samples/extra/hugeints.d", true);
+    // the calls whose results would be too large are left to the runtime, which fails them before computing anything
+    auto& sts = program->statements;
+    vector<shared_ptr<ast::Statement>> badstatements(sts.end() - 2, sts.end());
+    sts.erase(sts.end() - 2, sts.end());
+    RunAndExpect("", "1 0 0\n");
+    for (auto& stmt : badstatements) {
+        sts.push_back(stmt);
+        RunAndExpectCrash("");
+        sts.pop_back();
+    }
+}
+
+TEST_F(Sample, ExtraLowered) {
+    ReadFile("samples/extra/lowered.d", true);
+    RunAndExpect("abc", "38 -7\n");
+    auto code = LoweredCode::FromProgram(*program);
+    ASSERT_EQ(code->Nodes[code->Root].op, LoweredCode::Op::Body);
+    // each node precedes its subtrees, and the bodies of the closures come after the program
+    for (CodeIndex i = 0; i < code->Nodes.size(); i++)
+        for (auto child : code->ChildrenOf(code->Nodes[i])) {
+            EXPECT_GT(child, i);
+            EXPECT_LT(child, code->Nodes.size());
+        }
+    ASSERT_FALSE(code->Functions.empty());
+    for (auto& function : code->Functions) {
+        EXPECT_GT(function.Body, code->Root);
+        EXPECT_LT(function.Body, code->Nodes.size());
+    }
+    // `sq` returns an expression, `add` runs a body that declares a variable
+    EXPECT_TRUE(ranges::any_of(code->Functions, [](const LoweredCode::Function& function) {
+        return function.ReturnsExpression && function.Params.size() == 1;
+    }));
+    EXPECT_TRUE(ranges::any_of(code->Functions, [&](const LoweredCode::Function& function) {
+        auto& body = code->Nodes[function.Body];
+        return !function.ReturnsExpression && body.op == LoweredCode::Op::Body && body.kind;
+    }));
+}
+
+TEST_F(Sample, ExtraInPlace) {
+    ReadFile("samples/extra/inplace.d", true);
+    RunAndExpect("", R"(6 5
+30 10
+1024 1
+11
+112345 1
+)");
+}
+
+TEST_F(Sample, ExtraHoisted) {
+    ReadFile("samples/extra/hoisted.d", true);
+    RunAndExpect("abc", R"(81
+195
+abc!abc!abc!
+)");
+}
+
+TEST_F(Sample, ExtraShared) {
+    ReadFile("samples/extra/shared.d", true);
+    RunAndExpect("abc", R"(34 34 9
+41 16
+30
+20 70
+38 70 71
+66 70 72
+94 70 73
+)");
+}
+
+TEST_F(Sample, ExtraInlined) {
+    ReadFile("samples/extra/inlined.d", true);
+    // the error is in the body of `half`, and the call is still in the stack trace
+    RunAndExpectCrashAt("abc", "100 7 3\n6\n12\n", "12 / x", "print half(j)");
+}
+
+TEST_F(Sample, ExtraEvaluated) {
+    ReadFile("samples/extra/evaluated.d", true);
+    auto initializer = [this](size_t index) {
+        return dynamic_cast<ast::VarStatement&>(*program->statements[index]).definitions[0].second.value();
+    };
+    // the calls without effects that finish within the budget are replaced with their results
+    auto weighted = dynamic_pointer_cast<ast::PrecomputedValue>(initializer(7));
+    ASSERT_TRUE(weighted);
+    EXPECT_EQ(dynamic_cast<runtime::IntegerValue&>(*weighted->Value).Value(), 1641);
+    EXPECT_TRUE(dynamic_pointer_cast<ast::PrecomputedValue>(initializer(8)));
+    EXPECT_FALSE(dynamic_pointer_cast<ast::PrecomputedValue>(initializer(9)));
+    // the joined string is never stored, but it is refused before it is built
+    auto wide = dynamic_cast<ast::PrintStatement&>(*program->statements.back()).expressions[0];
+    EXPECT_FALSE(dynamic_pointer_cast<ast::PrecomputedValue>(wide));
+    RunAndExpect("", "1641 *** 33554432\n9 2\n7!\n7\nfalse\n33554495\n");
+}
+
 int main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
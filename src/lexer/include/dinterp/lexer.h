@@ -1,7 +1,9 @@
 #pragma once
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -68,7 +70,7 @@ public:
 class Token {
 public:
     Span span;
-    enum class Type {
+    enum class Type : std::uint8_t {
         tkGreater,
         tkGreaterEq,
         tkLess,
@@ -153,8 +155,50 @@ public:
     virtual ~StringLiteral() override = default;
 };
 
+// The tokens of a file as parallel arrays: a type, a span and a payload index per token. Identifiers and string
+// literals refer to a table of strings in which equal identifiers (or equal string literals) share one entry; integer
+// and real literals refer to tables of values.
+class TokenBuffer {
+private:
+    std::vector<Token::Type> types;
+    std::vector<Span> spans;
+    std::vector<std::uint32_t> payloads;
+    std::vector<std::string> strings;
+    std::vector<BigInt> integers;
+    std::vector<long double> reals;
+
+public:
+    size_t Size() const;
+    Token::Type TypeAt(size_t index) const;
+    const Span& SpanAt(size_t index) const;
+    // Only for tkIdent tokens
+    const std::string& Identifier(size_t index) const;
+    // Only for tkStringLiteral tokens
+    const std::string& StringValue(size_t index) const;
+    // Only for tkIntLiteral tokens
+    const BigInt& IntValue(size_t index) const;
+    // Only for tkRealLiteral tokens
+    long double RealValue(size_t index) const;
+
+    void Add(Token::Type type, const Span& span);
+    // Adds an entry to the string table, returns its index
+    std::uint32_t AddString(std::string value);
+    // `type` is tkIdent or tkStringLiteral; `stringIndex` was returned by AddString
+    void AddWithString(Token::Type type, const Span& span, std::uint32_t stringIndex);
+    void AddInt(const Span& span, BigInt value);
+    void AddReal(const Span& span, long double value);
+
+    // Adapters to the object-per-token representation
+    std::shared_ptr<Token> MakeToken(size_t index) const;
+    std::vector<std::shared_ptr<Token>> MakeTokens() const;
+    static TokenBuffer FromTokens(const std::vector<std::shared_ptr<Token>>& tokens);
+};
+
 class Lexer {
 public:
+    static std::optional<TokenBuffer> tokenizeCompact(const std::shared_ptr<const locators::CodeFile>& file,
+                                                      complog::ICompilationLog& log, bool skipShebang);
+    // The same tokens, one object each
     static std::optional<std::vector<std::shared_ptr<Token>>> tokenize(
         const std::shared_ptr<const locators::CodeFile>& file, complog::ICompilationLog& log, bool skipShebang);
 };
@@ -1,7 +1,10 @@
 #include "dinterp/lexer.h"
 
-#include <algorithm>
+#include <array>
 #include <cctype>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 
 #include "dinterp/complog/CompilationLog.h"
@@ -134,7 +137,7 @@ string Token::TypeToString(Token::Type type) {
     return "<?>";
 }
 
-static bool checkComments(size_t& i, size_t n, const string& code) {
+static bool checkComments(size_t& i, size_t n, string_view code) {
     if (i + 1 < n && code[i] == '/' && code[i + 1] == '/') {
         while (i < n && code[i] != '\n') {
             i++;
@@ -144,9 +147,23 @@ static bool checkComments(size_t& i, size_t n, const string& code) {
     return false;
 }
 
+namespace {
+// Collects tokens into a TokenBuffer, interning identifiers and string literals by their text in the source
+struct TokenSink {
+    TokenBuffer buffer;
+    unordered_map<string_view, uint32_t> interned;
+
+    void AddWithString(Token::Type type, const Span& span, string_view source, string value) {
+        auto [it, inserted] = interned.try_emplace(source.substr(span.position, span.length), 0);
+        if (inserted) it->second = buffer.AddString(std::move(value));
+        buffer.AddWithString(type, span, it->second);
+    }
+};
+}  // namespace
+
 static bool checkStringLiterals(size_t& i, size_t n, const shared_ptr<const locators::CodeFile>& file,
-                                vector<shared_ptr<Token>>& tokens, complog::ICompilationLog& log) {
-    const std::string& code = file->AllText();
+                                TokenSink& tokens, complog::ICompilationLog& log) {
+    string_view code = file->AllText();
     if (code[i] != '"') return false;
     size_t position = i;
     string value;
@@ -182,22 +199,28 @@ static bool checkStringLiterals(size_t& i, size_t n, const shared_ptr<const loca
         return false;
     }
     i++;
-    auto token = make_shared<StringLiteral>();
-    token->type = Token::Type::tkStringLiteral;
-    token->span = {position, i - position};
-    token->value = value;
-    tokens.push_back(token);
+    tokens.AddWithString(Token::Type::tkStringLiteral, {position, i - position}, code, std::move(value));
     return true;
 }
 
-static bool checkNumbers(size_t& i, size_t n, const string& code, vector<shared_ptr<Token>>& tokens) {
+static bool checkNumbers(size_t& i, size_t n, string_view code, TokenSink& tokens) {
     if (!isdigit(code[i])) return false;
     size_t position = i;
+    // digits are accumulated in 19-digit chunks, so short literals never touch BigInt arithmetics
+    static constexpr uint64_t MAX_CHUNK_SCALE = 10'000'000'000'000'000'000ull;
     BigInt value = 0;
+    uint64_t chunk = 0, scale = 1;
     while (i < n && isdigit(code[i])) {
-        value = value * BigInt(10) + BigInt(code[i] - '0');
+        if (scale == MAX_CHUNK_SCALE) {
+            value = value * BigInt(scale) + BigInt(chunk);
+            chunk = 0;
+            scale = 1;
+        }
+        chunk = chunk * 10 + (code[i] - '0');
+        scale *= 10;
         i++;
     }
+    value = value ? value * BigInt(scale) + BigInt(chunk) : BigInt(chunk);
     if (i < n && code[i] == '.' && i + 1 < n && isdigit(code[i + 1])) {
         long double realValue = value.ToFloat();
         long double fraction = 0.1;
@@ -207,92 +230,167 @@ static bool checkNumbers(size_t& i, size_t n, const string& code, vector<shared_
             fraction *= 0.1;
             i++;
         }
-        auto token = make_shared<RealToken>();
-        token->type = Token::Type::tkRealLiteral;
-        token->span = {position, i - position};
-        token->value = realValue;
-        tokens.push_back(token);
-    } else {
-        auto token = make_shared<IntegerToken>();
-        token->type = Token::Type::tkIntLiteral;
-        token->span = {position, i - position};
-        token->value = value;
-        tokens.push_back(token);
-    }
+        tokens.buffer.AddReal({position, i - position}, realValue);
+    } else
+        tokens.buffer.AddInt({position, i - position}, std::move(value));
     return true;
 }
 
-static Token::Type alphabeticTokens[] = {
-    /*19*/ Token::Type::tkVar,
-    /*20*/ Token::Type::tkWhile,
-    /*21*/ Token::Type::tkFor,
-    /*22*/ Token::Type::tkIf,
-    /*23*/ Token::Type::tkThen,
-    /*24*/ Token::Type::tkEnd,
-    /*26*/ Token::Type::tkExit,
-    /*27*/ Token::Type::tkPrint,
-    /*29*/ Token::Type::tkIn,
-    /*30*/ Token::Type::tkElse,
-    /*31*/ Token::Type::tkLoop,
-    /*34*/ Token::Type::tkAnd,
-    /*35*/ Token::Type::tkOr,
-    /*36*/ Token::Type::tkNot,
-    /*37*/ Token::Type::tkXor,
-    /*38*/ Token::Type::tkInt,
-    /*39*/ Token::Type::tkReal,
-    /*40*/ Token::Type::tkBool,
-    /*41*/ Token::Type::tkString,
-    /*42*/ Token::Type::tkNone,
-    /*43*/ Token::Type::tkFunc,
-    /*44*/ Token::Type::tkTrue,
-    /*45*/ Token::Type::tkFalse,
-    /*46*/ Token::Type::tkIs,
-    /*47*/ Token::Type::tkReturn,
-};  // VERY IMPORTANT that this is sorted
-
-static bool isAlphabeticToken(Token::Type tktype) {  // O(log sizeof(alphabeticTokens))
-    constexpr size_t N = sizeof(alphabeticTokens) / sizeof(alphabeticTokens[0]);
-    auto found = std::lower_bound(alphabeticTokens, alphabeticTokens + N, tktype) - alphabeticTokens;
-    return found < static_cast<long>(N) && alphabeticTokens[found] == tktype;
+static bool isWordChar(char ch) { return isLatin(ch) || isdigit(ch) || ch == '_'; }
+
+namespace {
+struct Keyword {
+    string_view word;
+    Token::Type type;
+};
+}  // namespace
+
+static constexpr Keyword KEYWORDS[] = {
+    {"var", Token::Type::tkVar},
+    {"while", Token::Type::tkWhile},
+    {"for", Token::Type::tkFor},
+    {"if", Token::Type::tkIf},
+    {"then", Token::Type::tkThen},
+    {"end", Token::Type::tkEnd},
+    {"exit", Token::Type::tkExit},
+    {"print", Token::Type::tkPrint},
+    {"else", Token::Type::tkElse},
+    {"loop", Token::Type::tkLoop},
+    {"and", Token::Type::tkAnd},
+    {"or", Token::Type::tkOr},
+    {"not", Token::Type::tkNot},
+    {"xor", Token::Type::tkXor},
+    {"real", Token::Type::tkReal},
+    {"string", Token::Type::tkString},
+    {"bool", Token::Type::tkBool},
+    {"none", Token::Type::tkNone},
+    {"func", Token::Type::tkFunc},
+    {"true", Token::Type::tkTrue},
+    {"false", Token::Type::tkFalse},
+    {"is", Token::Type::tkIs},
+    {"return", Token::Type::tkReturn},
+    {"int", Token::Type::tkInt},
+    {"in", Token::Type::tkIn},
+};
+
+// A perfect hash of the keywords: every keyword gets its own slot. If a new keyword collides with another one,
+// KEYWORD_TABLE fails to compile, and the constants in keywordHash need to be adjusted.
+static constexpr size_t KEYWORD_SLOTS = 64;
+
+static constexpr size_t keywordHash(string_view word) {
+    return (word.size() * 4 + static_cast<unsigned char>(word.front()) * 47 + static_cast<unsigned char>(word.back())) %
+           KEYWORD_SLOTS;
 }
 
-static bool checkToken(size_t& i, size_t n, const string& code, vector<shared_ptr<Token>>& tokens) {
-    for (const pair<string, Token::Type>& tok : Token::typeChars) {
-        if (i + tok.first.length() <= n && equal(tok.first.begin(), tok.first.end(), code.begin() + i)) {
-            auto tktype = tok.second;
-            if (isAlphabeticToken(tktype) && i + tok.first.length() < n) {
-                char nx = code[i + tok.first.length()];
-                if (isLatin(nx) || isdigit(nx) || nx == '_') continue;
-            }
-            auto token = make_shared<Token>();
-            token->type = tok.second;
-            token->span = {i, tok.first.length()};
-            tokens.push_back(token);
-            i += tok.first.length();
-            return true;
-        }
+static constexpr array<Keyword, KEYWORD_SLOTS> KEYWORD_TABLE = [] {
+    array<Keyword, KEYWORD_SLOTS> table{};
+    for (auto& keyword : KEYWORDS) {
+        auto& slot = table[keywordHash(keyword.word)];
+        if (!slot.word.empty()) throw "two keywords share a slot of KEYWORD_TABLE";
+        slot = keyword;
     }
-    return false;
+    return table;
+}();
+
+static optional<Token::Type> findKeyword(string_view word) {
+    auto& slot = KEYWORD_TABLE[keywordHash(word)];
+    if (slot.word == word) return slot.type;
+    return {};
+}
+
+// Operators and punctuation, dispatched on the first character; the longest match wins
+static bool checkOperator(size_t& i, size_t n, string_view code, TokenSink& tokens) {
+    auto next = [&](char ch) { return i + 1 < n && code[i + 1] == ch; };
+    Token::Type type;
+    size_t length = 1;
+    switch (code[i]) {
+        case ',':
+            type = Token::Type::tkComma;
+            break;
+        case '+':
+            type = Token::Type::tkPlus;
+            break;
+        case '-':
+            type = Token::Type::tkMinus;
+            break;
+        case '*':
+            type = Token::Type::tkTimes;
+            break;
+        case '\n':
+            type = Token::Type::tkNewLine;
+            break;
+        case '[':
+            type = Token::Type::tkOpenBracket;
+            break;
+        case ']':
+            type = Token::Type::tkClosedBracket;
+            break;
+        case '(':
+            type = Token::Type::tkOpenParenthesis;
+            break;
+        case ')':
+            type = Token::Type::tkClosedParenthesis;
+            break;
+        case '{':
+            type = Token::Type::tkOpenCurlyBrace;
+            break;
+        case '}':
+            type = Token::Type::tkClosedCurlyBrace;
+            break;
+        case ';':
+            type = Token::Type::tkSemicolon;
+            break;
+        case ':':
+            if (!next('=')) return false;
+            type = Token::Type::tkAssign;
+            length = 2;
+            break;
+        case '.':
+            length = next('.') ? 2 : 1;
+            type = length == 2 ? Token::Type::tkRange : Token::Type::tkDot;
+            break;
+        case '=':
+            length = next('>') ? 2 : 1;
+            type = length == 2 ? Token::Type::tkArrow : Token::Type::tkEqual;
+            break;
+        case '>':
+            length = next('=') ? 2 : 1;
+            type = length == 2 ? Token::Type::tkGreaterEq : Token::Type::tkGreater;
+            break;
+        case '<':
+            length = next('=') ? 2 : 1;
+            type = length == 2 ? Token::Type::tkLessEq : Token::Type::tkLess;
+            break;
+        case '/':
+            length = next('=') ? 2 : 1;
+            type = length == 2 ? Token::Type::tkNotEqual : Token::Type::tkDivide;
+            break;
+        default:
+            return false;
+    }
+    tokens.buffer.Add(type, {i, length});
+    i += length;
+    return true;
 }
 
-static bool checkIdentifierToken(size_t& i, size_t n, const string& code, vector<shared_ptr<Token>>& tokens) {
+// A keyword or an identifier: the whole word is scanned once, then looked up among the keywords
+static bool checkWord(size_t& i, size_t n, string_view code, TokenSink& tokens) {
     if (!isLatin(code[i]) && code[i] != '_') return false;
     size_t position = i;
-    while (i < n && (isLatin(code[i]) || isdigit(code[i]) || code[i] == '_')) i++;
-    string value = code.substr(position, i - position);
-    auto token = make_shared<IdentifierToken>();
-    token->type = Token::Type::tkIdent;
-    token->span = {position, i - position};
-    token->identifier = value;
-    tokens.push_back(token);
+    while (i < n && isWordChar(code[i])) i++;
+    string_view word(code.data() + position, i - position);
+    if (auto keyword = findKeyword(word))
+        tokens.buffer.Add(*keyword, {position, word.size()});
+    else
+        tokens.AddWithString(Token::Type::tkIdent, {position, word.size()}, code, string(word));
     return true;
 }
 
-optional<vector<shared_ptr<Token>>> Lexer::tokenize(const shared_ptr<const locators::CodeFile>& file,
-                                                    complog::ICompilationLog& log, bool skipShebang) {
-    vector<shared_ptr<Token>> tokens;
+optional<TokenBuffer> Lexer::tokenizeCompact(const shared_ptr<const locators::CodeFile>& file,
+                                             complog::ICompilationLog& log, bool skipShebang) {
+    TokenSink tokens;
     size_t i = 0;
-    const std::string& code = file->AllText();
+    string_view code = file->AllText();
     size_t n = code.length();
     if (skipShebang && code.starts_with("#!")) {
         while (i < n && code[i] != '\n') ++i;
@@ -306,15 +404,19 @@ optional<vector<shared_ptr<Token>>> Lexer::tokenize(const shared_ptr<const locat
         if (checkComments(i, n, code)) continue;
         if (checkStringLiterals(i, n, file, tokens, log)) continue;
         if (checkNumbers(i, n, code, tokens)) continue;
-        if (checkToken(i, n, code, tokens)) continue;
-        if (checkIdentifierToken(i, n, code, tokens)) continue;
+        if (checkOperator(i, n, code, tokens)) continue;
+        if (checkWord(i, n, code, tokens)) continue;
         log.Log(make_shared<LexerError>(locators::Locator(file, i)));
         return {};
     }
-    auto eof = make_shared<Token>();
-    eof->type = Token::Type::tkEof;
-    eof->span = {n, 0};
-    tokens.push_back(eof);
-    return tokens;
+    tokens.buffer.Add(Token::Type::tkEof, {n, 0});
+    return std::move(tokens.buffer);
+}
+
+optional<vector<shared_ptr<Token>>> Lexer::tokenize(const shared_ptr<const locators::CodeFile>& file,
+                                                    complog::ICompilationLog& log, bool skipShebang) {
+    auto buffer = tokenizeCompact(file, log, skipShebang);
+    if (!buffer) return {};
+    return buffer->MakeTokens();
 }
 }  // namespace dinterp
@@ -47,3 +47,21 @@ TEST(goodtests, biginttest) {
     EXPECT_NEAR(dynamic_pointer_cast<RealToken>(tokens[3])->value,
                 193041934932402394293492034902903409230923953402934568938455.9, 10);
 }
+
+TEST(goodtests, bigintChunks) {
+    // literals are read in 19-digit chunks; check the lengths around the chunk boundaries
+    for (size_t digits : {1, 18, 19, 20, 37, 38, 39, 40, 57}) {
+        string literal;
+        for (size_t i = 0; i < digits; i++) literal += static_cast<char>('9' - i % 10);
+        auto file = make_shared<locators::CodeFile>("Test.d", literal + " 0" + literal);
+        complog::AccumulatedCompilationLog log;
+        auto maybeTokens = Lexer::tokenize(file, log, false);
+        ASSERT_TRUE(maybeTokens.has_value());
+        ASSERT_EQ(maybeTokens->size(), 3ul);
+        for (size_t i = 0; i < 2; i++) {
+            auto token = dynamic_pointer_cast<IntegerToken>((*maybeTokens)[i]);
+            ASSERT_NE(token, nullptr);
+            EXPECT_EQ(token->value, BigInt(literal, 10)) << literal;
+        }
+    }
+}
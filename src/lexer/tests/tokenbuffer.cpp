@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "dinterp/complog/CompilationLog.h"
+#include "dinterp/lexer.h"
+using namespace std;
+using namespace dinterp;
+
+static const char* CODE = R"%%(var abc := "x", abc, "x", 12, 2.5
+abc := abcd + "y")%%";
+
+TEST(goodtests, tokenBuffer) {
+    shared_ptr<locators::CodeFile> file = make_shared<locators::CodeFile>("Test1.d", CODE);
+    complog::AccumulatedCompilationLog log;
+    auto maybeBuffer = Lexer::tokenizeCompact(file, log, false);
+    ASSERT_TRUE(maybeBuffer.has_value());
+    auto& buffer = *maybeBuffer;
+    ASSERT_EQ(buffer.Size(), 19ul);
+    EXPECT_EQ(buffer.TypeAt(0), Token::Type::tkVar);
+    EXPECT_EQ(buffer.TypeAt(1), Token::Type::tkIdent);
+    EXPECT_EQ(buffer.SpanAt(1), (Span{4, 3}));
+    EXPECT_EQ(buffer.Identifier(1), "abc");
+    EXPECT_EQ(buffer.StringValue(3), "x");
+    EXPECT_EQ(buffer.IntValue(9), 12);
+    EXPECT_NEAR(buffer.RealValue(11), 2.5, 1e-12);
+    EXPECT_EQ(buffer.Identifier(15), "abcd");
+    EXPECT_EQ(buffer.StringValue(17), "y");
+    // equal identifiers and equal string literals share their strings
+    EXPECT_EQ(&buffer.Identifier(1), &buffer.Identifier(5));
+    EXPECT_EQ(&buffer.Identifier(1), &buffer.Identifier(13));
+    EXPECT_EQ(&buffer.StringValue(3), &buffer.StringValue(7));
+    EXPECT_NE(&buffer.Identifier(1), &buffer.Identifier(15));
+    EXPECT_EQ(buffer.TypeAt(18), Token::Type::tkEof);
+
+    // the adapters give the same tokens both ways
+    auto tokens = buffer.MakeTokens();
+    auto maybeTokens = Lexer::tokenize(file, log, false);
+    ASSERT_TRUE(maybeTokens.has_value());
+    ASSERT_EQ(tokens.size(), maybeTokens->size());
+    auto roundTrip = TokenBuffer::FromTokens(tokens);
+    ASSERT_EQ(roundTrip.Size(), buffer.Size());
+    for (size_t i = 0; i < tokens.size(); i++) {
+        EXPECT_EQ(tokens[i]->type, buffer.TypeAt(i));
+        EXPECT_EQ(tokens[i]->span, buffer.SpanAt(i));
+        EXPECT_EQ((*maybeTokens)[i]->type, buffer.TypeAt(i));
+        EXPECT_EQ(roundTrip.TypeAt(i), buffer.TypeAt(i));
+        EXPECT_EQ(roundTrip.SpanAt(i), buffer.SpanAt(i));
+    }
+    EXPECT_EQ(dynamic_pointer_cast<IdentifierToken>(tokens[15])->identifier, "abcd");
+    EXPECT_EQ(dynamic_pointer_cast<StringLiteral>(tokens[17])->value, "y");
+    EXPECT_EQ(dynamic_pointer_cast<IntegerToken>(tokens[9])->value, 12);
+    EXPECT_EQ(dynamic_pointer_cast<RealToken>(tokens[11])->value, buffer.RealValue(11));
+    EXPECT_EQ(roundTrip.Identifier(15), "abcd");
+    EXPECT_EQ(roundTrip.IntValue(9), 12);
+}
@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "dinterp/complog/CompilationLog.h"
+#include "dinterp/lexer.h"
+using namespace std;
+using namespace dinterp;
+
+// Token::typeChars (used for messages) and the lexer's own tables must agree
+TEST(goodtests, typeChars) {
+    for (auto& [text, type] : Token::typeChars) {
+        for (string suffix : {"", " ", "\n"}) {
+            auto file = make_shared<locators::CodeFile>("Test.d", text + suffix);
+            complog::AccumulatedCompilationLog log;
+            auto maybeTokens = Lexer::tokenize(file, log, false);
+            ASSERT_TRUE(maybeTokens.has_value()) << text;
+            ASSERT_GE(maybeTokens->size(), 2ul) << text;
+            EXPECT_EQ((*maybeTokens)[0]->type, type) << text;
+            EXPECT_EQ((*maybeTokens)[0]->span, (Span{0, text.size()})) << text;
+        }
+    }
+}
+
+TEST(goodtests, keywordPrefixes) {
+    // words that start or end like keywords are identifiers
+    for (string word : {"integer", "in_", "_if", "for1", "iff", "i", "returns", "Var", "nonE", "xo", "ands"}) {
+        auto file = make_shared<locators::CodeFile>("Test.d", word);
+        complog::AccumulatedCompilationLog log;
+        auto maybeTokens = Lexer::tokenize(file, log, false);
+        ASSERT_TRUE(maybeTokens.has_value()) << word;
+        ASSERT_EQ(maybeTokens->size(), 2ul) << word;
+        auto ident = dynamic_pointer_cast<IdentifierToken>((*maybeTokens)[0]);
+        ASSERT_NE(ident, nullptr) << word;
+        EXPECT_EQ(ident->identifier, word);
+    }
+}
@@ -0,0 +1,121 @@
+#include "dinterp/lexer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+using namespace std;
+
+namespace dinterp {
+size_t TokenBuffer::Size() const { return types.size(); }
+
+Token::Type TokenBuffer::TypeAt(size_t index) const { return types[index]; }
+
+const Span& TokenBuffer::SpanAt(size_t index) const { return spans[index]; }
+
+const string& TokenBuffer::Identifier(size_t index) const { return strings[payloads[index]]; }
+
+const string& TokenBuffer::StringValue(size_t index) const { return strings[payloads[index]]; }
+
+const BigInt& TokenBuffer::IntValue(size_t index) const { return integers[payloads[index]]; }
+
+long double TokenBuffer::RealValue(size_t index) const { return reals[payloads[index]]; }
+
+void TokenBuffer::Add(Token::Type type, const Span& span) {
+    types.push_back(type);
+    spans.push_back(span);
+    payloads.push_back(0);
+}
+
+uint32_t TokenBuffer::AddString(string value) {
+    strings.push_back(std::move(value));
+    return strings.size() - 1;
+}
+
+void TokenBuffer::AddWithString(Token::Type type, const Span& span, uint32_t stringIndex) {
+    types.push_back(type);
+    spans.push_back(span);
+    payloads.push_back(stringIndex);
+}
+
+void TokenBuffer::AddInt(const Span& span, BigInt value) {
+    types.push_back(Token::Type::tkIntLiteral);
+    spans.push_back(span);
+    payloads.push_back(integers.size());
+    integers.push_back(std::move(value));
+}
+
+void TokenBuffer::AddReal(const Span& span, long double value) {
+    types.push_back(Token::Type::tkRealLiteral);
+    spans.push_back(span);
+    payloads.push_back(reals.size());
+    reals.push_back(value);
+}
+
+shared_ptr<Token> TokenBuffer::MakeToken(size_t index) const {
+    shared_ptr<Token> res;
+    switch (types[index]) {
+        case Token::Type::tkIdent: {
+            auto token = make_shared<IdentifierToken>();
+            token->identifier = Identifier(index);
+            res = token;
+            break;
+        }
+        case Token::Type::tkStringLiteral: {
+            auto token = make_shared<StringLiteral>();
+            token->value = StringValue(index);
+            res = token;
+            break;
+        }
+        case Token::Type::tkIntLiteral: {
+            auto token = make_shared<IntegerToken>();
+            token->value = IntValue(index);
+            res = token;
+            break;
+        }
+        case Token::Type::tkRealLiteral: {
+            auto token = make_shared<RealToken>();
+            token->value = RealValue(index);
+            res = token;
+            break;
+        }
+        default:
+            res = make_shared<Token>();
+    }
+    res->type = types[index];
+    res->span = spans[index];
+    return res;
+}
+
+vector<shared_ptr<Token>> TokenBuffer::MakeTokens() const {
+    vector<shared_ptr<Token>> res;
+    res.reserve(Size());
+    for (size_t i = 0; i < Size(); i++) res.push_back(MakeToken(i));
+    return res;
+}
+
+TokenBuffer TokenBuffer::FromTokens(const vector<shared_ptr<Token>>& tokens) {
+    TokenBuffer res;
+    for (auto& token : tokens) {
+        switch (token->type) {
+            case Token::Type::tkIdent:
+                res.AddWithString(token->type, token->span,
+                                  res.AddString(dynamic_pointer_cast<IdentifierToken>(token)->identifier));
+                break;
+            case Token::Type::tkStringLiteral:
+                res.AddWithString(token->type, token->span,
+                                  res.AddString(dynamic_pointer_cast<StringLiteral>(token)->value));
+                break;
+            case Token::Type::tkIntLiteral:
+                res.AddInt(token->span, dynamic_pointer_cast<IntegerToken>(token)->value);
+                break;
+            case Token::Type::tkRealLiteral:
+                res.AddReal(token->span, dynamic_pointer_cast<RealToken>(token)->value);
+                break;
+            default:
+                res.Add(token->type, token->span);
+        }
+    }
+    return res;
+}
+}  // namespace dinterp
@@ -1,6 +1,20 @@
 #include "dinterp/locators/CodeFile.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 using namespace std;
 
 namespace dinterp {
@@ -8,28 +22,71 @@ namespace locators {
 CodeContext::CodeContext(const string& text, size_t pointerPositionWithinText)
     : Text(text), PointerWithinText(pointerPositionWithinText) {}
 
-CodeFile::CodeFile(const string& filename, const string& content, const vector<size_t> eolns)
-    : filename(filename), content(content), eolns(eolns) {}
-vector<size_t> CodeFile::FindEolns(const string& text) {
+CodeFile::CodeFile(const string& filename, void* mapping, size_t mappingSize)
+    : filename(filename),
+      mapping(mapping),
+      mappingSize(mappingSize),
+      text(static_cast<const char*>(mapping), mappingSize) {}
+CodeFile::CodeFile(const string& filename, string content)
+    : filename(filename), content(std::move(content)), text(this->content) {}
+CodeFile::~CodeFile() {
+    if (hasId) FileRegistry::Release(id);
+    if (mapping) munmap(mapping, mappingSize);
+}
+
+shared_ptr<CodeFile> CodeFile::MapFile(const string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping != MAP_FAILED) return shared_ptr<CodeFile>(new CodeFile(filename, mapping, st.st_size));
+    } else
+        close(fd);
+    ifstream in(filename);
+    if (!in) return nullptr;
+    stringstream sstr;
+    sstr << in.rdbuf();
+    return make_shared<CodeFile>(filename, std::move(sstr).str());
+}
+
+vector<size_t> CodeFile::FindEolns(string_view text) {
     vector<size_t> res;
-    size_t i = 0;
-    while (true) {
-        i = text.find('\n', i);
-        if (i == string::npos) break;
-        res.push_back(i++);
+    const char* data = text.data();
+    size_t n = text.size(), i = 0;
+#ifdef __SSE2__
+    // 16 bytes at a time: a bitmask of the line feeds in each block
+    const __m128i eoln = _mm_set1_epi8('\n');
+    for (; i + 16 <= n; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, eoln));
+        while (mask) {
+            res.push_back(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
     }
+#endif
+    for (; i < n; i++)
+        if (data[i] == '\n') res.push_back(i);
     return res;
 }
-CodeFile::CodeFile(const string& filename, const string& content) : CodeFile(filename, content, FindEolns(content)) {}
+const vector<size_t>& CodeFile::Eolns() const {
+    call_once(eolnsFound, [this] { eolns = FindEolns(text); });
+    return eolns;
+}
 pair<size_t, size_t> CodeFile::LineCol(size_t pos) const {
     size_t line = Line(pos);
     return {line, pos - LineStartPosition(line)};
 }
-size_t CodeFile::Line(size_t pos) const { return lower_bound(eolns.begin(), eolns.end(), pos) - eolns.begin(); }
+size_t CodeFile::Line(size_t pos) const {
+    auto& eolns = Eolns();
+    return lower_bound(eolns.begin(), eolns.end(), pos) - eolns.begin();
+}
 size_t CodeFile::Column(size_t pos) const { return pos - LineStartPosition(Line(pos)); }
 size_t CodeFile::Position(size_t line, size_t col) const { return LineStartPosition(line) + col; }
 size_t CodeFile::LineStartPosition(size_t line) const {
-    if (line) return eolns[line - 1] + 1;
+    if (line) return Eolns()[line - 1] + 1;
     return 0;
 }
 const string& CodeFile::FileName() const { return filename; }
@@ -38,18 +95,63 @@ CodeContext CodeFile::Context(size_t pos, size_t toleft, size_t toright) const {
     size_t linelen = LineLength(line);
     toleft = min(toleft, col);
     toright = min(toright, linelen - col);
-    return {content.substr(pos - toleft, toleft + toright), toleft};
+    return {string(text.substr(pos - toleft, toleft + toright)), toleft};
 }
 size_t CodeFile::LineLength(size_t line) const {
-    return (line == eolns.size() ? content.size() : eolns[line]) - LineStartPosition(line);
+    auto& eolns = Eolns();
+    return (line == eolns.size() ? text.size() : eolns[line]) - LineStartPosition(line);
 }
-size_t CodeFile::LineCount() const { return eolns.size() + 1; }
-const string& CodeFile::AllText() const { return content; }
+size_t CodeFile::LineCount() const { return Eolns().size() + 1; }
+string_view CodeFile::AllText() const { return text; }
 std::string CodeFile::LineTextWithoutLineFeed(size_t line) const {
-    line = min(line, eolns.size());
+    line = min(line, Eolns().size());
     size_t start = LineStartPosition(line);
     size_t len = LineLength(line);
-    return content.substr(start, len);
+    return string(text.substr(start, len));
+}
+FileId CodeFile::Id() const {
+    call_once(registered, [this] {
+        id = FileRegistry::Register(*this);
+        hasId = true;
+    });
+    return id;
+}
+
+// Chunk `c` holds the ids from FIRST_CHUNK_SIZE * (2^c - 1) on, and there are enough chunks for all 32-bit ids
+static constexpr size_t FIRST_CHUNK_SIZE = 64;
+static constexpr size_t CHUNK_COUNT = 27;
+using FileSlot = atomic<const CodeFile*>;
+static mutex registryMutex;  // taken by Register only
+static atomic<FileSlot*> chunks[CHUNK_COUNT];
+static size_t registeredCount = 0;
+
+static FileSlot& SlotOf(size_t id, bool allocate) {
+    size_t chunk = bit_width(id / FIRST_CHUNK_SIZE + 1) - 1;
+    size_t offset = id - FIRST_CHUNK_SIZE * ((size_t(1) << chunk) - 1);
+    FileSlot* slots = chunks[chunk].load(memory_order_acquire);
+    if (!slots && allocate) {
+        slots = new FileSlot[FIRST_CHUNK_SIZE << chunk]();
+        chunks[chunk].store(slots, memory_order_release);
+    }
+    return slots[offset];
+}
+
+FileId FileRegistry::Register(const CodeFile& file) {
+    if (file.AllText().size() > numeric_limits<uint32_t>::max())
+        throw length_error("The file " + file.FileName() + " is too large, the limit is 4 GiB");
+    lock_guard lock(registryMutex);
+    if (registeredCount > numeric_limits<uint32_t>::max()) throw length_error("Too many files were loaded");
+    size_t id = registeredCount++;
+    SlotOf(id, true).store(&file, memory_order_release);
+    return static_cast<FileId>(id);
+}
+void FileRegistry::Release(FileId id) { SlotOf(static_cast<size_t>(id), false).store(nullptr, memory_order_release); }
+const CodeFile& FileRegistry::Get(FileId id) {
+    auto file = SlotOf(static_cast<size_t>(id), false).load(memory_order_acquire);
+    if (!file)
+        throw logic_error("The file with id " + to_string(static_cast<size_t>(id)) +
+                          " was looked up after it was destroyed");
+    return *file;
 }
 }  // namespace locators
 }  // namespace dinterp
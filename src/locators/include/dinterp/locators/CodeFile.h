@@ -1,5 +1,9 @@
 #pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace dinterp {
@@ -10,15 +14,34 @@ struct CodeContext {
     CodeContext(const std::string& text, size_t pointerPositionWithinText);
 };
 
+// Identifies a registered `CodeFile` (see FileRegistry); locators store it instead of a pointer to the file
+enum class FileId : std::uint32_t {};
+
+// The text is either owned or a read-only memory mapping of the file (see MapFile). The line index is built on the
+// first query about lines, so a file that never needs one (no diagnostics) is only scanned by the lexer.
 class CodeFile {
     const std::string filename;
     const std::string content;
-    const std::vector<size_t> eolns;
-    CodeFile(const std::string& filename, const std::string& content, const std::vector<size_t> eolns);
-    static std::vector<size_t> FindEolns(const std::string& text);
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    std::string_view text;
+    mutable std::vector<size_t> eolns;
+    mutable std::once_flag eolnsFound;
+    mutable FileId id;
+    mutable bool hasId = false;
+    mutable std::once_flag registered;
+    CodeFile(const std::string& filename, void* mapping, size_t mappingSize);
+    const std::vector<size_t>& Eolns() const;
+    static std::vector<size_t> FindEolns(std::string_view text);
 
 public:
-    CodeFile(const std::string& filename, const std::string& content);
+    CodeFile(const std::string& filename, std::string content);
+    CodeFile(const CodeFile&) = delete;
+    CodeFile& operator=(const CodeFile&) = delete;
+    ~CodeFile();
+    // Maps the file into memory, or reads it if it cannot be mapped (e.g. a pipe); nullptr if it cannot be opened,
+    // with errno telling why
+    static std::shared_ptr<CodeFile> MapFile(const std::string& filename);
     std::pair<size_t, size_t> LineCol(size_t pos) const;
     size_t Line(size_t pos) const;
     size_t Column(size_t pos) const;
@@ -28,8 +51,28 @@ public:
     CodeContext Context(size_t pos, size_t toleft, size_t toright) const;
     size_t LineLength(size_t line) const;
     size_t LineCount() const;
-    const std::string& AllText() const;
+    std::string_view AllText() const;
     std::string LineTextWithoutLineFeed(size_t line) const;
+    // Registers the file on the first call
+    FileId Id() const;
+};
+
+/*
+ * Every file that locators refer to. A file is registered the first time its id is asked for, and released when it is
+ * destroyed, so a locator only needs the id, and looking the file up is left to the code that formats diagnostics.
+ * The file is not kept alive by the registry: whoever owns it keeps it as long as the locators into it are used.
+ *
+ * The entries are stored in chunks that are never moved or freed, each twice as large as the one before, so `Get` is a
+ * couple of loads without a lock; only registering takes one. The ids are not reused. Thread-safe.
+ */
+class FileRegistry {
+public:
+    // Throws `std::length_error` if the file is too large for 32-bit positions or if there are too many files
+    static FileId Register(const CodeFile& file);
+    // Called by the destructor of a registered file
+    static void Release(FileId id);
+    // Throws `std::logic_error` if the file was destroyed
+    static const CodeFile& Get(FileId id);
 };
 }  // namespace locators
 }  // namespace dinterp
@@ -1,16 +1,20 @@
 #pragma once
+#include <cstdint>
 #include <memory>
 
 #include "CodeFile.h"
 
 namespace dinterp {
 namespace locators {
+// Locators are small values (8 and 12 bytes) that are cheap to copy and merge; the file is only looked up in the
+// registry when a locator is formatted or its text is needed
 class Locator {
-    size_t pos;
-    std::shared_ptr<const CodeFile> file;
+    FileId file;
+    std::uint32_t pos;
 
 public:
     Locator(const std::shared_ptr<const CodeFile>& file, size_t pos);
+    Locator(FileId file, size_t pos);
     std::string Pretty() const;
     size_t Position() const;
     size_t Line() const;
@@ -18,16 +22,17 @@ public:
     std::pair<size_t, size_t> LineCol() const;
     const std::string& FileName() const;
     CodeContext Context(size_t toleft, size_t toright) const;
-    const std::shared_ptr<const CodeFile>& File() const;
+    FileId File() const;
     void WritePrettyExcerpt(std::ostream& out, size_t suggested_width) const;
 };
 
 class SpanLocator {
-    size_t pos, length;
-    std::shared_ptr<const CodeFile> file;
+    FileId file;
+    std::uint32_t pos, length;
 
 public:
     SpanLocator(const std::shared_ptr<const CodeFile>& file, size_t pos, size_t length);
+    SpanLocator(FileId file, size_t pos, size_t length);
     SpanLocator(const SpanLocator& a, const SpanLocator& b);
     SpanLocator(const Locator& loc, size_t length);
     std::string Pretty() const;
@@ -35,7 +40,7 @@ public:
     Locator End() const;
     size_t Length() const;
     std::string Excerpt() const;
-    const std::shared_ptr<const CodeFile>& File() const;
+    FileId File() const;
     void WritePrettyExcerpt(std::ostream& out, size_t suggested_width) const;
 };
 }  // namespace locators
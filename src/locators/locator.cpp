@@ -7,20 +7,23 @@ using namespace std;
 
 namespace dinterp {
 namespace locators {
-Locator::Locator(const shared_ptr<const CodeFile>& file, size_t pos) : pos(pos), file(file) {}
+Locator::Locator(const shared_ptr<const CodeFile>& file, size_t pos) : Locator(file->Id(), pos) {}
+Locator::Locator(FileId file, size_t pos) : file(file), pos(static_cast<uint32_t>(pos)) {}
 std::string Locator::Pretty() const {
     stringstream res;
     auto [line, col] = LineCol();
-    res << file->FileName() << ':' << line + 1 << ':' << col;
+    res << FileName() << ':' << line + 1 << ':' << col;
     return res.str();
 }
 size_t Locator::Position() const { return pos; }
-size_t Locator::Line() const { return file->Line(pos); }
-size_t Locator::Column() const { return file->Column(pos); }
-pair<size_t, size_t> Locator::LineCol() const { return file->LineCol(pos); }
-const std::string& Locator::FileName() const { return file->FileName(); }
-CodeContext Locator::Context(size_t toleft, size_t toright) const { return file->Context(pos, toleft, toright); }
-const shared_ptr<const CodeFile>& Locator::File() const { return file; }
+size_t Locator::Line() const { return FileRegistry::Get(file).Line(pos); }
+size_t Locator::Column() const { return FileRegistry::Get(file).Column(pos); }
+pair<size_t, size_t> Locator::LineCol() const { return FileRegistry::Get(file).LineCol(pos); }
+const std::string& Locator::FileName() const { return FileRegistry::Get(file).FileName(); }
+CodeContext Locator::Context(size_t toleft, size_t toright) const {
+    return FileRegistry::Get(file).Context(pos, toleft, toright);
+}
+FileId Locator::File() const { return file; }
 
 void Locator::WritePrettyExcerpt(ostream& out, size_t suggested_width) const {
     out << FileName() << ":\n";
@@ -30,7 +33,7 @@ void Locator::WritePrettyExcerpt(ostream& out, size_t suggested_width) const {
     width -= static_cast<int>(linenum.size()) + 2;
     width = max(0, width);
     out << linenum << " |";
-    size_t linewidth = file->LineLength(line);
+    size_t linewidth = FileRegistry::Get(file).LineLength(line);
     int toleft, toright;
     if (static_cast<long>(linewidth) <= width) {
         toleft = col;
@@ -55,37 +58,42 @@ void Locator::WritePrettyExcerpt(ostream& out, size_t suggested_width) const {
 }
 
 SpanLocator::SpanLocator(const std::shared_ptr<const CodeFile>& file, size_t pos, size_t length)
-    : pos(pos), length(length), file(file) {}
+    : SpanLocator(file->Id(), pos, length) {}
+SpanLocator::SpanLocator(FileId file, size_t pos, size_t length)
+    : file(file), pos(static_cast<uint32_t>(pos)), length(static_cast<uint32_t>(length)) {}
 SpanLocator::SpanLocator(const SpanLocator& a, const SpanLocator& b) : file(a.file) {
     if (a.file != b.file)
-        throw std::runtime_error("Tried to merge two spans from different files: " + a.file->FileName() + " and " +
-                                 b.file->FileName());
+        throw std::runtime_error("Tried to merge two spans from different files: " +
+                                 FileRegistry::Get(a.file).FileName() + " and " + FileRegistry::Get(b.file).FileName());
     pos = min(a.pos, b.pos);
-    size_t end = max(a.pos + a.length, b.pos + b.length);
-    length = end - pos;
+    length = max(a.pos + a.length, b.pos + b.length) - pos;
 }
 SpanLocator::SpanLocator(const Locator& loc, size_t length) : SpanLocator(loc.File(), loc.Position(), length) {}
 string SpanLocator::Pretty() const {
     stringstream res;
-    auto [sline, scol] = file->LineCol(pos);
-    auto [eline, ecol] = file->LineCol(pos + length);
-    res << file->FileName() << ':' << sline + 1 << ':' << scol << "--" << eline + 1 << ':' << ecol;
+    auto& file = FileRegistry::Get(this->file);
+    auto [sline, scol] = file.LineCol(pos);
+    auto [eline, ecol] = file.LineCol(pos + length);
+    res << file.FileName() << ':' << sline + 1 << ':' << scol << "--" << eline + 1 << ':' << ecol;
     return res.str();
 }
 Locator SpanLocator::Start() const { return {file, pos}; }
 Locator SpanLocator::End() const { return {file, pos + length}; }
 size_t SpanLocator::Length() const { return length; }
-std::string SpanLocator::Excerpt() const { return file->AllText().substr(pos, length); }
-const shared_ptr<const CodeFile>& SpanLocator::File() const { return file; }
+std::string SpanLocator::Excerpt() const {
+    return std::string(FileRegistry::Get(file).AllText().substr(pos, length));
+}
+FileId SpanLocator::File() const { return file; }
 
 void SpanLocator::WritePrettyExcerpt(ostream& out, [[maybe_unused]] size_t suggested_width) const {
-    out << file->FileName() << ":\n";
+    auto& file = FileRegistry::Get(this->file);
+    out << file.FileName() << ":\n";
     size_t endpos = pos + length;
-    auto locstart = file->LineCol(pos);
-    auto locend = file->LineCol(endpos);
+    auto locstart = file.LineCol(pos);
+    auto locend = file.LineCol(endpos);
     if (locend.first > locstart.first && locend.second == 0) {
         locend.first--;
-        locend.second = file->LineLength(locend.first);
+        locend.second = file.LineLength(locend.first);
     }
     locstart.first++;
     locend.first++;
@@ -97,7 +105,7 @@ void SpanLocator::WritePrettyExcerpt(ostream& out, [[maybe_unused]] size_t sugge
             string linenum_str = to_string(linenum);
             out << linenum_str << string(linenum_chars - linenum_str.size() + 1, ' ') << '|';
         }
-        string linetext = file->LineTextWithoutLineFeed(linenum - 1);
+        string linetext = file.LineTextWithoutLineFeed(linenum - 1);
         out << linetext << '\n';
         out << string(linenum_chars + 1, ' ') << (last ? ' ' : '|');
         size_t hlstart = first ? locstart.second : 0;
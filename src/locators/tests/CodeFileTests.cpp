@@ -1,3 +1,6 @@
+#include <cstdio>
+#include <fstream>
+
 #include "fixture.h"
 using namespace std;
 
@@ -71,3 +74,35 @@ TEST_F(RealCodeFixture, Contexts) {
     EXPECT_EQ(cont.PointerWithinText, 10);
     EXPECT_EQ(cont.Text, " world!\\n\";");
 }
+
+TEST(CodeFile, MapFile) {
+    string name = testing::TempDir() + "locators_mapfile.d";
+    // long lines with line feeds at both ends of 16-byte blocks
+    string text = string(15, 'a') + "\n" + string(16, 'b') + "\n\n" + string(40, 'c') + "\n" + "d";
+    {
+        ofstream out(name);
+        out << text;
+    }
+    auto mapped = dinterp::locators::CodeFile::MapFile(name);
+    ASSERT_NE(mapped, nullptr);
+    dinterp::locators::CodeFile owned("<string>", text);
+    EXPECT_EQ(mapped->AllText(), text);
+    EXPECT_EQ(mapped->FileName(), name);
+    ASSERT_EQ(mapped->LineCount(), owned.LineCount());
+    for (size_t line = 0; line < owned.LineCount(); line++) {
+        EXPECT_EQ(mapped->LineStartPosition(line), owned.LineStartPosition(line));
+        EXPECT_EQ(mapped->LineTextWithoutLineFeed(line), owned.LineTextWithoutLineFeed(line));
+    }
+    for (size_t pos = 0; pos <= text.size(); pos++) EXPECT_EQ(mapped->LineCol(pos), owned.LineCol(pos));
+
+    {
+        ofstream out(name, ios::trunc);
+    }
+    auto empty = dinterp::locators::CodeFile::MapFile(name);
+    ASSERT_NE(empty, nullptr);
+    EXPECT_EQ(empty->AllText(), "");
+    EXPECT_EQ(empty->LineCount(), 1);
+    remove(name.c_str());
+
+    EXPECT_EQ(dinterp::locators::CodeFile::MapFile(name), nullptr);
+}
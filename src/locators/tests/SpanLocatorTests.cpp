@@ -12,3 +12,22 @@ TEST_F(RealCodeFixture, spanLocTest) {
     EXPECT_EQ(loc.End().Position(), start + len);
     EXPECT_EQ(loc.Excerpt(), "sing names");
 }
+
+TEST_F(RealCodeFixture, spanLocReleasesFile) {
+    SpanLocator first(file, file->Position(3, 0), 3);
+    SpanLocator second(file->Id(), file->Position(3, 4), 4);
+    EXPECT_EQ(first.File(), second.File());
+    SpanLocator merged(first, second);
+    EXPECT_EQ(merged.Excerpt(), "int main");
+    EXPECT_EQ(merged.Pretty(), "<string>:4:0--4:8");
+    auto other = make_shared<CodeFile>("<other>", "int");
+    EXPECT_NE(SpanLocator(other, 0, 3).File(), first.File());
+    EXPECT_THROW(SpanLocator(first, SpanLocator(other, 0, 3)), runtime_error);
+    // the registry does not keep the file, and the ids of released files are not reused
+    weak_ptr<const CodeFile> weak = file;
+    file.reset();
+    EXPECT_TRUE(weak.expired());
+    EXPECT_THROW(merged.Excerpt(), logic_error);
+    auto again = make_shared<CodeFile>("<again>", "int");
+    EXPECT_NE(again->Id(), first.File());
+}
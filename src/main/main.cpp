@@ -1,12 +1,12 @@
 #include <cstring>
-#include <fstream>
 #include <iostream>
 #include <memory>
 #include <optional>
-#include <sstream>
 
+#include "dinterp/bigint.h"
 #include "dinterp/complog/CompilationLog.h"
 #include "dinterp/complog/CompilationMessage.h"
+#include "dinterp/interp/evaluator.h"
 #include "dinterp/interp/runner.h"
 #include "dinterp/interp/runtimeContext.h"
 #include "dinterp/lexer.h"
@@ -30,6 +30,7 @@ public:
     bool NoTraceback = false;
     size_t CallStackCap = 1024;
     size_t TraceLen = 50;
+    size_t Threads = 1;
     optional<bool*> GetLongFlag(string name) {
         if (name == "lexer") return &Lexer;
         if (name == "syntaxer") return &Syntaxer;
@@ -89,6 +90,8 @@ Options:
 Parameter options:
     --callstack <nonnegative integer>  Set the call stack capacity (default = 1024).
     --tracelen  <nonnegative integer>  On error, output at most this many call stack entries (default = 50).
+    --threads   <nonnegative integer>  Multiply huge integers and check functions using up to this many threads
+                                       (default = 1).
 
 Every argument after -- is assumed to be a file name.
 )%%";
@@ -143,7 +146,7 @@ bool InterpretArgs(int argc, char** argv, Options& opts, vector<string>& files)
                 onlyFiles = true;
                 continue;
             }
-            if (arg == "tracelen" || arg == "callstack") {
+            if (arg == "tracelen" || arg == "callstack" || arg == "threads") {
                 ++i;
                 if (i == argc) {
                     cerr << "Expected a number after \"--" << arg << "\"\n";
@@ -156,6 +159,8 @@ bool InterpretArgs(int argc, char** argv, Options& opts, vector<string>& files)
                 }
                 if (arg == "tracelen")
                     opts.TraceLen = *parsedarg;
+                else if (arg == "threads")
+                    opts.Threads = *parsedarg;
                 else
                     opts.CallStackCap = *parsedarg;
                 continue;
@@ -183,17 +188,18 @@ bool InterpretArgs(int argc, char** argv, Options& opts, vector<string>& files)
     return true;
 }
 
-void PrintTokens(const locators::CodeFile& file, const vector<shared_ptr<Token>>& tokens) {
+void PrintTokens(const locators::CodeFile& file, const TokenBuffer& tokens) {
     cout << file.FileName() << '\n';
     size_t padding = 0;
-    for (auto& ptoken : tokens) padding = max(padding, TokenTypeToString(ptoken->type).length());
+    for (size_t i = 0; i < tokens.Size(); i++) padding = max(padding, TokenTypeToString(tokens.TypeAt(i)).length());
     padding += 2;
-    for (auto& ptoken : tokens) {
-        auto typestr = TokenTypeToString(ptoken->type);
-        cout << typestr << string(padding - typestr.size(), ' ')
-             << file.AllText().substr(ptoken->span.position, ptoken->span.length) << '\n';
+    for (size_t i = 0; i < tokens.Size(); i++) {
+        auto typestr = TokenTypeToString(tokens.TypeAt(i));
+        auto& span = tokens.SpanAt(i);
+        cout << typestr << string(padding - typestr.size(), ' ') << file.AllText().substr(span.position, span.length)
+             << '\n';
     }
-    cout << "Total: " << tokens.size() << " tokens\n\n";
+    cout << "Total: " << tokens.Size() << " tokens\n\n";
 }
 
 class SpyCompilationLog : public complog::ICompilationLog {
@@ -219,19 +225,12 @@ static void WaitForUserToReadMessages() {
 
 bool ProcessFile(string filename, const Options& opts, complog::ICompilationLog& log) {
     SpyCompilationLog slog(log);
-    shared_ptr<const locators::CodeFile> file;
-    {
-        ifstream in(filename);
-        if (!in) {
-            perror(("Cannot open " + filename).c_str());
-            return false;
-        }
-        stringstream sstr;
-        sstr << in.rdbuf();
-        in.close();
-        file = make_shared<locators::CodeFile>(filename, sstr.str());
+    shared_ptr<const locators::CodeFile> file = locators::CodeFile::MapFile(filename);
+    if (!file) {
+        perror(("Cannot open " + filename).c_str());
+        return false;
     }
-    auto maybeTokens = Lexer::tokenize(file, slog, true);
+    auto maybeTokens = Lexer::tokenizeCompact(file, slog, true);
     if (!maybeTokens.has_value()) {
         cerr << "A lexical error was encountered in " << filename << ", stopping.\n";
         return false;
@@ -241,7 +240,7 @@ bool ProcessFile(string filename, const Options& opts, complog::ICompilationLog&
         if (!opts.Check) PrintTokens(*file, tokens);
         return true;
     }
-    auto maybeProg = SyntaxAnalyzer::analyze(tokens, file, slog);
+    auto maybeProg = SyntaxAnalyzer::analyze(std::move(tokens), file, slog);
     if (!maybeProg.has_value()) {
         cerr << "A syntax error was encountered in " << filename << ", stopping.\n";
         return false;
@@ -255,7 +254,8 @@ bool ProcessFile(string filename, const Options& opts, complog::ICompilationLog&
         }
         return true;
     }
-    if (!semantic::Analyze(slog, prog)) {
+    interp::BoundedEvaluator evaluator;
+    if (!semantic::Analyze(slog, prog, &evaluator, opts.Threads)) {
         cerr << "A semantic error was encountered in " << filename << ", stopping.\n";
         return false;
     }
@@ -293,6 +293,7 @@ int main(int argc, char** argv) {
     vector<string> files;
     Options opts;
     if (!InterpretArgs(argc, argv, opts, files)) return 1;
+    BigInt::SetMulThreads(opts.Threads);
     bool doneSomething = false;
     if (opts.Help) {
         cout << Options::HELP << endl;
@@ -747,6 +747,30 @@ EXPLORER(
         return {};
     })
 
+EXPLORER(
+    HoistedValue,
+    {  // GetActionCommands
+        return vector<ActionCommand>({{"n", "Name = " + node->Name}, {"e", "Go to the hoisted expression"}});
+    },
+    {  // Action
+        if (command == "e") return node->Expr;
+        output << node->Name;
+        return {};
+    })
+
+EXPLORER(
+    InlinedCall,
+    {  // GetActionCommands
+        vector<ActionCommand> res({{"c", "Go to the inlined closure"}});
+        int n = node->Args.size();
+        for (int i = 0; i < n; ++i) res.emplace_back(to_string(i), "Args[" + to_string(i) + "]");
+        return res;
+    },
+    {  // Action
+        if (command == "c") return node->Callee;
+        return node->Args[StrToInt(command)];
+    })
+
 class CustomExplorer : public ASTExplorer {
     shared_ptr<ast::ASTNode> node;
 
@@ -829,6 +853,20 @@ void ASTExplorerVisitor::VisitCustom(ast::ASTNode& node) {
             return;
         }
     }
+    {
+        auto hoisted = dynamic_pointer_cast<ast::HoistedValue>(sh);
+        if (hoisted) {
+            this->explorer = make_shared<HoistedValueExplorer>(hoisted);
+            return;
+        }
+    }
+    {
+        auto inlined = dynamic_pointer_cast<ast::InlinedCall>(sh);
+        if (inlined) {
+            this->explorer = make_shared<InlinedCallExplorer>(inlined);
+            return;
+        }
+    }
     this->explorer = make_shared<CustomExplorer>(sh);
 }
 
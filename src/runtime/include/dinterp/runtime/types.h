@@ -44,6 +44,7 @@ public:
  * + Floor: int = this
  * + Ceil: int = this
  * + Frac: real = 0.0
+ * + Pow, ModPow, Gcd, ISqrt, ShiftLeft, ShiftRight, BitAnd, BitOr, BitXor: pure functions, see IntegerMethodFunction
  */
 class IntegerType : public Type {
 public:
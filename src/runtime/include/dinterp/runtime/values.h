@@ -42,6 +42,11 @@ public:
     virtual RuntimeValueResult Field(const std::string& name);              // a.fieldname
     virtual RuntimeValueResult Field(const RuntimeValue& index) const;      // a.(2 + 3)
     virtual RuntimeValueResult Subscript(const RuntimeValue& other) const;  // a[3 + 2]
+    // Destructive versions of BinaryPlus/BinaryMinus/BinaryMul that turn `this` into the result. Only to be called
+    // when nothing else references this value. false (with `this` untouched) if not supported for these operands.
+    virtual bool BinaryPlusInPlace(const RuntimeValue& other);
+    virtual bool BinaryMinusInPlace(const RuntimeValue& other);
+    virtual bool BinaryMulInPlace(const RuntimeValue& other);
     virtual ~RuntimeValue() = default;
 };
 
@@ -51,6 +56,7 @@ public:
  * + Floor: int = this
  * + Ceil: int = this
  * + Frac: real = 0.0
+ * + Pow, ModPow, Gcd, ISqrt, ShiftLeft, ShiftRight, BitAnd, BitOr, BitXor: IntegerMethodFunction
  */
 class IntegerValue : public RuntimeValue {
     BigInt value;
@@ -68,6 +74,9 @@ public:
     RuntimeValueResult UnaryMinus() const override;
     RuntimeValueResult UnaryPlus() const override;
     RuntimeValueResult Field(const std::string& name) override;
+    bool BinaryPlusInPlace(const RuntimeValue& other) override;
+    bool BinaryMinusInPlace(const RuntimeValue& other) override;
+    bool BinaryMulInPlace(const RuntimeValue& other) override;
     virtual ~IntegerValue() override = default;
 };
 
@@ -193,6 +202,9 @@ public:
 class FuncValue : public RuntimeValue {
 public:
     virtual RuntimeValueResult Call(const std::vector<std::shared_ptr<RuntimeValue>>& args) const = 0;
+    // Whether the checker may run a pure call with these arguments; false if the call would take too much memory or
+    // time, which it may fail with at runtime
+    virtual bool CanPrecompute(const std::vector<std::shared_ptr<RuntimeValue>>&) const { return true; }
     virtual ~FuncValue() override = default;
 };
 
@@ -236,6 +248,7 @@ public:
     void DoPrintSelf(std::ostream& out, std::set<std::shared_ptr<const RuntimeValue>>& recGuard) const override;
     StringJoinFunction(const std::shared_ptr<const StringValue>& _this);
     RuntimeValueResult Call(const std::vector<std::shared_ptr<RuntimeValue>>& args) const override;
+    bool CanPrecompute(const std::vector<std::shared_ptr<RuntimeValue>>& args) const override;
     std::shared_ptr<runtime::Type> TypeOfValue() const override;
     virtual ~StringJoinFunction() override = default;
 };
@@ -251,6 +264,35 @@ public:
     virtual ~StringSliceFunction() override = default;
 };
 
+/*
+ * Pure methods of integers:
+ * + Pow: function (exponent: int) -> int  // exponent >= 0
+ * + ModPow: function (exponent: int, modulus: int) -> int  // exponent >= 0, modulus /= 0
+ * + Gcd: function (other: int) -> int
+ * + ISqrt: function () -> int  // this >= 0
+ * + ShiftLeft: function (shift: int) -> int  // shift >= 0
+ * + ShiftRight: function (shift: int) -> int  // shift >= 0, rounds towards negative infinity
+ * + BitAnd, BitOr, BitXor: function (other: int) -> int  // negative numbers are in two's complement
+ */
+class IntegerMethodFunction : public FuncValue {
+public:
+    enum class Method { Pow, ModPow, Gcd, ISqrt, ShiftLeft, ShiftRight, BitAnd, BitOr, BitXor };
+
+private:
+    std::shared_ptr<const IntegerValue> _this;
+    Method method;
+
+public:
+    static std::optional<Method> MethodByName(const std::string& name);
+    static std::shared_ptr<FuncType> MethodType(Method method);
+    void DoPrintSelf(std::ostream& out, std::set<std::shared_ptr<const RuntimeValue>>& recGuard) const override;
+    IntegerMethodFunction(const std::shared_ptr<const IntegerValue>& _this, Method method);
+    RuntimeValueResult Call(const std::vector<std::shared_ptr<RuntimeValue>>& args) const override;
+    bool CanPrecompute(const std::vector<std::shared_ptr<RuntimeValue>>& args) const override;
+    std::shared_ptr<runtime::Type> TypeOfValue() const override;
+    virtual ~IntegerMethodFunction() override = default;
+};
+
 // No value must have UnknownType, that type is reserved for typechecking
 
 }  // namespace runtime
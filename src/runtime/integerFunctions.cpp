@@ -0,0 +1,155 @@
+#include <algorithm>
+
+#include "dinterp/runtime/values.h"
+using namespace std;
+
+namespace dinterp {
+namespace runtime {
+
+struct IntegerMethodInfo {
+    const char* name;
+    IntegerMethodFunction::Method method;
+    vector<const char*> argnames;
+};
+
+static const IntegerMethodInfo INTEGER_METHODS[] = {
+    {"Pow", IntegerMethodFunction::Method::Pow, {"exponent"}},
+    {"ModPow", IntegerMethodFunction::Method::ModPow, {"exponent", "modulus"}},
+    {"Gcd", IntegerMethodFunction::Method::Gcd, {"other"}},
+    {"ISqrt", IntegerMethodFunction::Method::ISqrt, {}},
+    {"ShiftLeft", IntegerMethodFunction::Method::ShiftLeft, {"shift"}},
+    {"ShiftRight", IntegerMethodFunction::Method::ShiftRight, {"shift"}},
+    {"BitAnd", IntegerMethodFunction::Method::BitAnd, {"other"}},
+    {"BitOr", IntegerMethodFunction::Method::BitOr, {"other"}},
+    {"BitXor", IntegerMethodFunction::Method::BitXor, {"other"}},
+};
+
+// The results are kept within this many bits, so that a call fails instead of running out of memory or time
+static constexpr size_t MAX_RESULT_BITS = size_t(1) << 24;
+
+static const IntegerMethodInfo& InfoOf(IntegerMethodFunction::Method method) {
+    return INTEGER_METHODS[static_cast<int>(method)];
+}
+
+optional<IntegerMethodFunction::Method> IntegerMethodFunction::MethodByName(const string& name) {
+    for (auto& info : INTEGER_METHODS)
+        if (name == info.name) return info.method;
+    return {};
+}
+
+shared_ptr<FuncType> IntegerMethodFunction::MethodType(Method method) {
+    size_t argCount = InfoOf(method).argnames.size();
+    return make_shared<FuncType>(true, vector<shared_ptr<Type>>(argCount, make_shared<IntegerType>()),
+                                 make_shared<IntegerType>());
+}
+
+// Whether the result would have more bits than MAX_RESULT_BITS, found without computing it
+static bool ResultTooLarge(IntegerMethodFunction::Method method, const BigInt& value,
+                           const vector<const BigInt*>& ints) {
+    size_t bits = value.SignificantBits();
+    switch (method) {
+        case IntegerMethodFunction::Method::Pow:
+            // the power of a number below 2 ** bits is below 2 ** (bits * exponent); 0, 1 and -1 do not grow
+            return bits > 1 && *ints[0] > static_cast<long>(MAX_RESULT_BITS / bits);
+        case IntegerMethodFunction::Method::ShiftLeft:
+            return bits && *ints[0] > static_cast<long>(MAX_RESULT_BITS - min(bits, MAX_RESULT_BITS));
+        default:
+            return false;
+    }
+}
+
+IntegerMethodFunction::IntegerMethodFunction(const shared_ptr<const IntegerValue>& _this, Method method)
+    : _this(_this), method(method) {}
+
+RuntimeValueResult IntegerMethodFunction::Call(const vector<shared_ptr<RuntimeValue>>& args) const {
+    auto& info = InfoOf(method);
+    size_t n = info.argnames.size();
+    if (args.size() != n)
+        return DRuntimeError("The int." + string(info.name) + " function expects exactly " + to_string(n) +
+                             " argument(s), but received " + to_string(args.size()));
+    vector<const BigInt*> ints(n);
+    for (size_t i = 0; i < n; i++) {
+        auto intval = dynamic_cast<const IntegerValue*>(args[i].get());
+        if (!intval)
+            return DRuntimeError("The int." + string(info.name) + " function expected an \"int\" argument " +
+                                 to_string(i + 1) + " (" + info.argnames[i] + "), but received \"" +
+                                 args[i]->TypeOfValue()->Name() + "\"");
+        ints[i] = &intval->Value();
+    }
+    const BigInt& value = _this->Value();
+    if (ResultTooLarge(method, value, ints))
+        return DRuntimeError("The result of the int." + string(info.name) + " function would have more than " +
+                             std::to_string(MAX_RESULT_BITS) + " bits");
+    optional<BigInt> res;
+    switch (method) {
+        case Method::Pow:
+            res = value.Pow(*ints[0]);
+            if (!res) return DRuntimeError("The int.Pow function's exponent cannot be negative");
+            break;
+        case Method::ModPow:
+            if (!*ints[1]) return DRuntimeError("The int.ModPow function's modulus cannot be 0");
+            res = value.ModPow(*ints[0], *ints[1]);
+            if (!res) return DRuntimeError("The int.ModPow function's exponent cannot be negative");
+            break;
+        case Method::Gcd:
+            res = value.Gcd(*ints[0]);
+            break;
+        case Method::ISqrt:
+            res = value.ISqrt();
+            if (!res) return DRuntimeError("The int.ISqrt function cannot be applied to a negative number");
+            break;
+        case Method::ShiftLeft:
+        case Method::ShiftRight: {
+            const BigInt& shift = *ints[0];
+            if (shift.IsNegative())
+                return DRuntimeError("The int." + string(info.name) + " function's shift cannot be negative");
+            if (method == Method::ShiftRight) {
+                // shifting out all the bits leaves 0 or -1
+                auto bits = BigInt(static_cast<long>(value.SignificantBits()) + 1);
+                res = value >> static_cast<size_t>(min(shift, bits).ClampToLong());
+                break;
+            }
+            res = value ? value << static_cast<size_t>(shift.ClampToLong()) : value;
+            break;
+        }
+        case Method::BitAnd:
+            res = value & *ints[0];
+            break;
+        case Method::BitOr:
+            res = value | *ints[0];
+            break;
+        case Method::BitXor:
+            res = value ^ *ints[0];
+            break;
+    }
+    return make_shared<IntegerValue>(*res);
+}
+
+bool IntegerMethodFunction::CanPrecompute(const vector<shared_ptr<RuntimeValue>>& args) const {
+    // the calls with wrong arguments fail the same way whenever they run
+    if (args.size() != InfoOf(method).argnames.size()) return true;
+    vector<const BigInt*> ints;
+    for (auto& arg : args) {
+        auto intval = dynamic_cast<const IntegerValue*>(arg.get());
+        if (!intval) return true;
+        ints.push_back(&intval->Value());
+    }
+    return !ResultTooLarge(method, _this->Value(), ints);
+}
+
+shared_ptr<runtime::Type> IntegerMethodFunction::TypeOfValue() const { return MethodType(method); }
+
+void IntegerMethodFunction::DoPrintSelf(std::ostream& out, std::set<std::shared_ptr<const RuntimeValue>>&) const {
+    auto& info = InfoOf(method);
+    out << "<built-in function int." << info.name << '(';
+    bool first = true;
+    for (auto argname : info.argnames) {
+        if (!first) out << ", ";
+        first = false;
+        out << argname << ": int";
+    }
+    out << ") -> int>";
+}
+
+}  // namespace runtime
+}  // namespace dinterp
@@ -96,6 +96,21 @@ RuntimeValueResult StringJoinFunction::Call(const std::vector<std::shared_ptr<Ru
     std::ranges::transform(strvals, strs.begin(), [](const StringValue* val) { return val->Value(); });
     return make_shared<StringValue>(_this->Join(strs));
 }
+// A joined string may be much larger than the array it is made from, which only holds references to the parts
+bool StringJoinFunction::CanPrecompute(const std::vector<std::shared_ptr<RuntimeValue>>& args) const {
+    static constexpr size_t MAX_PRECOMPUTED_LENGTH = size_t(1) << 24;
+    if (args.size() != 1) return true;
+    auto arrval = dynamic_cast<const ArrayValue*>(args[0].get());
+    if (!arrval) return true;
+    size_t length = 0;
+    for (auto& kv : arrval->Value) {
+        auto strval = dynamic_cast<const StringValue*>(kv.second.get());
+        if (!strval) return true;
+        length += strval->Value().size() + _this->Value().size();
+        if (length > MAX_PRECOMPUTED_LENGTH) return false;
+    }
+    return true;
+}
 std::shared_ptr<runtime::Type> StringJoinFunction::TypeOfValue() const {
     return make_shared<FuncType>(true, vector<shared_ptr<Type>>{make_shared<ArrayType>()}, make_shared<StringType>());
 }
@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <memory>
 #include <sstream>
+
+#include "dinterp/runtime/values.h"
 using namespace std;
 
 /*
@@ -100,6 +102,7 @@ std::optional<std::shared_ptr<Type>> IntegerType::UnaryPlus() const { return mak
 std::optional<std::shared_ptr<Type>> IntegerType::Field(const std::string& name) const {
     if (name == "Round" || name == "Floor" || name == "Ceil") return make_shared<IntegerType>();
     if (name == "Frac") return make_shared<RealType>();
+    if (auto method = IntegerMethodFunction::MethodByName(name)) return IntegerMethodFunction::MethodType(*method);
     return {};
 }
 
@@ -286,7 +289,7 @@ bool FuncType::StrictTypeEq(const Type& other) const {
         size_t n = argTypes->size();
         if (p->argTypes->size() != n) return false;
         for (size_t i = 0; i < n; i++)
-            if (argTypes->at(i)->StrictTypeEq(*p->argTypes->at(i))) return false;
+            if (!argTypes->at(i)->StrictTypeEq(*p->argTypes->at(i))) return false;
     } else if (p->argTypes)
         return false;
     return returnType->StrictTypeEq(*p->returnType);
@@ -38,6 +38,9 @@ RuntimeValueResult RuntimeValue::UnaryNot() const { return {}; }
 RuntimeValueResult RuntimeValue::Field([[maybe_unused]] const string& name) { return {}; }
 RuntimeValueResult RuntimeValue::Field([[maybe_unused]] const RuntimeValue& index) const { return {}; }
 RuntimeValueResult RuntimeValue::Subscript([[maybe_unused]] const RuntimeValue& other) const { return {}; }
+bool RuntimeValue::BinaryPlusInPlace([[maybe_unused]] const RuntimeValue& other) { return false; }
+bool RuntimeValue::BinaryMinusInPlace([[maybe_unused]] const RuntimeValue& other) { return false; }
+bool RuntimeValue::BinaryMulInPlace([[maybe_unused]] const RuntimeValue& other) { return false; }
 
 #define NUMERIC_CLASSIFY                                              \
     const IntegerValue* aint = dynamic_cast<const IntegerValue*>(&a); \
@@ -62,6 +65,19 @@ NUMERIC_ARITH(-, Minus)
 NUMERIC_ARITH(*, Mul)
 NUMERIC_CUSTOM(/, Div, if (!bint->Value()) return DRuntimeError("Integer division by 0");)
 
+// Saves copying the limbs of a large accumulator (`acc := acc + x`); int op real still produces a new real
+#define INTEGER_IN_PLACE(operator, name)                                   \
+    bool IntegerValue::Binary##name##InPlace(const RuntimeValue& other) { \
+        auto intval = dynamic_cast<const IntegerValue*>(&other);          \
+        if (!intval) return false;                                        \
+        value operator## = intval->value;                                 \
+        return true;                                                      \
+    }
+
+INTEGER_IN_PLACE(+, Plus)
+INTEGER_IN_PLACE(-, Minus)
+INTEGER_IN_PLACE(*, Mul)
+
 static partial_ordering OrderingFromInt(int o) {
     if (o > 0) return partial_ordering::greater;
     if (o < 0) return partial_ordering::less;
@@ -93,6 +109,9 @@ RuntimeValueResult IntegerValue::UnaryPlus() const { return make_shared<IntegerV
 RuntimeValueResult IntegerValue::Field(const string& name) {
     if (name == "Round" || name == "Floor" || name == "Ceil") return make_shared<IntegerValue>(value);
     if (name == "Frac") return make_shared<RealValue>(0);
+    if (auto method = IntegerMethodFunction::MethodByName(name))
+        return make_shared<IntegerMethodFunction>(dynamic_pointer_cast<const IntegerValue>(shared_from_this()),
+                                                  *method);
     return {};
 }
 void IntegerValue::DoPrintSelf(ostream& out, set<shared_ptr<const RuntimeValue>>&) const { out << value.ToString(); }
@@ -0,0 +1,101 @@
+#include "dinterp/semantic/closureChecks.h"
+
+#include <algorithm>
+#include <exception>
+
+#include "dinterp/semantic/expressionChecker.h"
+#include "dinterp/syntaxext/astDeepCopy.h"
+#include "dinterp/syntaxext/precomputed.h"
+using namespace std;
+
+namespace dinterp {
+namespace semantic {
+
+shared_ptr<runtime::RuntimeValue> ClosureCheckPool::RefusingEvaluator::Evaluate(
+    const ast::ClosureDefinition&, const vector<pair<string, shared_ptr<runtime::RuntimeValue>>>&,
+    const vector<shared_ptr<runtime::RuntimeValue>>&) {
+    asked = true;
+    return nullptr;
+}
+
+ClosureCheckPool::Task::Task(shared_ptr<ast::FuncLiteral> literal, ValueTimeline values)
+    : literal(std::move(literal)), values(std::move(values)), visible(this->values.VariableCount()) {}
+
+ClosureCheckPool::ClosureCheckPool(const ast::Body& program, const ValueTimeline& outside, size_t threads) {
+    auto around = outside.Detached();
+    around.StartScope();
+    for (auto& stmt : program.statements) {
+        auto var = dynamic_cast<const ast::VarStatement*>(stmt.get());
+        if (!var) continue;
+        // a variable is declared after its initializer is checked
+        for (auto& [name, init] : var->definitions) {
+            auto literal = init ? dynamic_pointer_cast<ast::FuncLiteral>(*init) : nullptr;
+            if (literal) byLiteral.emplace(literal.get(), tasks.emplace_back(make_unique<Task>(literal, around)).get());
+            around.Declare(name->identifier,
+                           locators::SpanLocator(var->pos.File(), name->span.position, name->span.length));
+        }
+    }
+    size_t n = min(threads ? threads - 1 : 0, tasks.size());
+    for (size_t i = 0; i < n; i++) workers.emplace_back([this] { Work(); });
+}
+
+ClosureCheckPool::~ClosureCheckPool() {
+    stopping = true;
+    for (auto& worker : workers) worker.join();
+}
+
+void ClosureCheckPool::Run(Task& task) {
+    auto literal = dynamic_pointer_cast<ast::FuncLiteral>(ast::AstDeepCopier::Clone(*task.literal));
+    RefusingEvaluator evaluator;
+    {
+        ValueTimeline values = task.values.Detached();
+        values.EvaluateCallsWith(&evaluator);
+        ExpressionChecker chk(task.log, values);
+        literal->AcceptVisitor(chk);
+        if (chk.HasResult())
+            task.closure = dynamic_pointer_cast<ast::ClosureDefinition>(chk.AssertReplacementAsExpression());
+    }
+    task.asked = evaluator.asked;
+}
+
+void ClosureCheckPool::Work() {
+    while (!stopping) {
+        size_t i = next++;
+        if (i >= tasks.size()) return;
+        auto& task = *tasks[i];
+        if (task.claimed.exchange(true)) continue;
+        try {
+            Run(task);
+            task.finished.set_value();
+        } catch (...) {
+            task.finished.set_exception(current_exception());
+        }
+    }
+}
+
+bool ClosureCheckPool::Take(const ast::FuncLiteral& literal, const ValueTimeline& values,
+                            complog::ICompilationLog& log, shared_ptr<ast::ClosureDefinition>& closure) {
+    auto iter = byLiteral.find(&literal);
+    if (iter == byLiteral.end()) return false;
+    auto& task = *iter->second;
+    byLiteral.erase(iter);
+    // the checker only declares the predicted names at the top level, so it has them all if it has as many; it has
+    // fewer if the initializer of one of them failed
+    bool predicted = values.VariableCount() == task.visible;
+    if (!task.claimed.exchange(true)) {
+        if (!predicted) return false;
+        Run(task);
+    } else {
+        // even if the result is of no use, the checker must not change the literal while the check copies it
+        task.result.get();
+        if (!predicted) return false;
+    }
+    // without an evaluator, the calls are left to the runtime the same as with one that refuses them
+    if (task.asked && values.CallEvaluator()) return false;
+    for (auto& message : task.log.Messages()) log.Log(message);
+    closure = task.closure;
+    return true;
+}
+
+}  // namespace semantic
+}  // namespace dinterp
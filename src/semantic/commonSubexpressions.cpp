@@ -0,0 +1,315 @@
+#include "dinterp/semantic/commonSubexpressions.h"
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#include "dinterp/runtime/types.h"
+#include "dinterp/runtime/values.h"
+#include "dinterp/syntax.h"
+#include "dinterp/syntaxext/precomputed.h"
+using namespace std;
+
+namespace dinterp {
+namespace semantic {
+
+CommonSubexpressionEliminator::CommonSubexpressionEliminator(ValueTimeline& values, const string& prefix)
+    : values(values), prefix(prefix) {}
+
+const vector<string>& CommonSubexpressionEliminator::Shared() const { return shared; }
+
+static bool IsScalar(const shared_ptr<runtime::Type>& type) {
+    return type->TypeEq(runtime::IntegerType()) || type->TypeEq(runtime::RealType()) ||
+           type->TypeEq(runtime::StringType()) || type->TypeEq(runtime::BoolType());
+}
+
+template <typename Node>
+CommonSubexpressionEliminator::Summary CommonSubexpressionEliminator::Collect(Node& parent,
+                                                                              shared_ptr<ast::Expression>& expr) {
+    size_t firstInner = occurrences.size();
+    summary = {};
+    expr->AcceptVisitor(*this);
+    Summary result = std::move(summary);
+    if (nested || !result.eligible) return result;
+    if (!dynamic_cast<ast::Unary*>(expr.get()) && !dynamic_cast<ast::Sum*>(expr.get()) &&
+        !dynamic_cast<ast::Term*>(expr.get()))
+        return result;
+    occurrences.push_back({&expr, &parent,
+                           [](ValueTimeline& values, ast::ASTNode& parent) {
+                               values.WillChange(static_cast<Node&>(parent));
+                           },
+                           firstInner, statements.size() - 1});
+    pending.emplace_back(occurrences.size() - 1, result);
+    return result;
+}
+
+template <typename Node, typename Operator>
+void CommonSubexpressionEliminator::CollectOperands(Node& parent, vector<shared_ptr<ast::Expression>>& operands,
+                                                    char tag, const vector<Operator>& operators) {
+    Summary result{true, string(1, tag) + "(", {}};
+    for (size_t i = 0; i < operands.size(); i++) {
+        auto operand = Collect(parent, operands[i]);
+        result.eligible = result.eligible && operand.eligible;
+        if (!result.eligible) continue;
+        if (i) result.key += "," + (operators.empty() ? string() : to_string(static_cast<int>(operators[i - 1])) + ",");
+        result.key += operand.key;
+        result.inputs.merge(operand.inputs);
+    }
+    result.key += ")";
+    summary = std::move(result);
+}
+
+void CommonSubexpressionEliminator::AddStatement(const shared_ptr<ast::Statement>& stmt) {
+    statements.push_back(stmt);
+    calls = false;
+    assigned.clear();
+    stmt->AcceptVisitor(*this);
+    auto reassigned = [this](const set<string>& inputs) {
+        return ranges::any_of(inputs, [this](const string& name) { return assigned.contains(name); });
+    };
+    // with a call, the order of the expressions in the statement would matter
+    if (!calls) {
+        for (auto& [index, occurrence] : pending) {
+            auto group = open.find(occurrence.key);
+            if (group == open.end()) {
+                // the statement assigns to an input after reading it, so there is no later occurrence to share with
+                if (reassigned(occurrence.inputs)) continue;
+                group = open.emplace(occurrence.key, groups.size()).first;
+                groups.push_back({occurrence.key.size(), std::move(occurrence.inputs), {}});
+            }
+            groups[group->second].occurrences.push_back(index);
+        }
+    }
+    pending.clear();
+    if (calls)
+        open.clear();
+    else
+        erase_if(open, [&](const auto& kv) { return reassigned(groups[kv.second].inputs); });
+}
+
+shared_ptr<ast::Statement> CommonSubexpressionEliminator::Eliminate() {
+    vector<bool> inner(occurrences.size());
+    vector<size_t> order(groups.size());
+    iota(order.begin(), order.end(), 0);
+    // an expression has a longer key than the ones inside it, so it is handled before them
+    ranges::stable_sort(order, greater{}, [this](size_t group) { return groups[group].keyLength; });
+    optional<size_t> first;
+    for (size_t group : order) {
+        vector<size_t> live;
+        ranges::copy_if(groups[group].occurrences, back_inserter(live), [&inner](size_t index) { return !inner[index]; });
+        if (live.size() < 2) continue;
+        string name = prefix + to_string(shared.size());
+        shared.push_back(name);
+        for (size_t i = 0; i < live.size(); i++) {
+            auto& occurrence = occurrences[live[i]];
+            // only the first occurrence is sure to be evaluated, the expressions inside the others are not counted
+            if (i) fill(inner.begin() + occurrence.firstInner, inner.begin() + live[i], true);
+            occurrence.willChange(values, *occurrence.parent);
+            auto& expr = *occurrence.slot;
+            expr = make_shared<ast::HoistedValue>(expr->pos, name, expr);
+        }
+        first = min(first.value_or(statements.size()), occurrences[live[0]].statement);
+    }
+    return first ? statements[*first] : nullptr;
+}
+
+#define DISALLOWED_VISIT(name)                                                          \
+    void CommonSubexpressionEliminator::Visit##name([[maybe_unused]] ast::name& node) { \
+        throw runtime_error("CommonSubexpressionEliminator cannot visit ast::" #name);  \
+    }
+
+void CommonSubexpressionEliminator::VisitBody(ast::Body& node) {
+    nested++;
+    for (auto& stmt : node.statements) stmt->AcceptVisitor(*this);
+    nested--;
+}
+
+void CommonSubexpressionEliminator::VisitVarStatement(ast::VarStatement& node) {
+    for (auto& [name, value] : node.definitions)
+        if (value) Collect(node, *value);
+}
+
+void CommonSubexpressionEliminator::VisitIfStatement(ast::IfStatement& node) {
+    Collect(node, node.condition);
+    node.doIfTrue->AcceptVisitor(*this);
+    if (node.doIfFalse) node.doIfFalse.value()->AcceptVisitor(*this);
+}
+
+void CommonSubexpressionEliminator::VisitShortIfStatement(ast::ShortIfStatement& node) {
+    Collect(node, node.condition);
+    nested++;
+    node.doIfTrue->AcceptVisitor(*this);
+    nested--;
+}
+
+void CommonSubexpressionEliminator::VisitWhileStatement(ast::WhileStatement& node) {
+    nested++;
+    Collect(node, node.condition);
+    node.action->AcceptVisitor(*this);
+    nested--;
+}
+
+void CommonSubexpressionEliminator::VisitForStatement(ast::ForStatement& node) {
+    Collect(node, node.startOrList);
+    if (node.end) Collect(node, *node.end);
+    node.action->AcceptVisitor(*this);
+}
+
+void CommonSubexpressionEliminator::VisitLoopStatement(ast::LoopStatement& node) {
+    node.body->AcceptVisitor(*this);
+}
+
+void CommonSubexpressionEliminator::VisitExitStatement([[maybe_unused]] ast::ExitStatement& node) {}
+
+void CommonSubexpressionEliminator::VisitAssignStatement(ast::AssignStatement& node) {
+    Collect(node, node.src);
+    for (auto& acc : node.dest->accessorChain) {
+        if (auto index = dynamic_cast<ast::IndexAccessor*>(acc.get()))
+            Collect(*index, index->expressionInBrackets);
+        else if (auto paren = dynamic_cast<ast::ParenMemberAccessor*>(acc.get()))
+            Collect(*paren, paren->expr);
+    }
+    assigned.insert(node.dest->baseIdent->identifier);
+}
+
+void CommonSubexpressionEliminator::VisitPrintStatement(ast::PrintStatement& node) {
+    for (auto& expr : node.expressions) Collect(node, expr);
+}
+
+void CommonSubexpressionEliminator::VisitReturnStatement(ast::ReturnStatement& node) {
+    if (node.returnValue) Collect(node, *node.returnValue);
+}
+
+void CommonSubexpressionEliminator::VisitExpressionStatement(ast::ExpressionStatement& node) {
+    Collect(node, node.expr);
+}
+
+DISALLOWED_VISIT(CommaExpressions)
+DISALLOWED_VISIT(CommaIdents)
+DISALLOWED_VISIT(IdentMemberAccessor)
+DISALLOWED_VISIT(IntLiteralMemberAccessor)
+DISALLOWED_VISIT(ParenMemberAccessor)
+DISALLOWED_VISIT(IndexAccessor)
+DISALLOWED_VISIT(Reference)
+DISALLOWED_VISIT(PrefixOperator)
+DISALLOWED_VISIT(TypecheckOperator)
+DISALLOWED_VISIT(Call)
+DISALLOWED_VISIT(AccessorOperator)
+DISALLOWED_VISIT(TupleLiteralElement)
+DISALLOWED_VISIT(ShortFuncBody)
+DISALLOWED_VISIT(LongFuncBody)
+
+void CommonSubexpressionEliminator::VisitXorOperator(ast::XorOperator& node) {
+    CollectOperands(node, node.operands, 'x');
+}
+
+void CommonSubexpressionEliminator::VisitOrOperator(ast::OrOperator& node) { CollectOperands(node, node.operands, 'o'); }
+
+void CommonSubexpressionEliminator::VisitAndOperator(ast::AndOperator& node) {
+    CollectOperands(node, node.operands, 'a');
+}
+
+void CommonSubexpressionEliminator::VisitBinaryRelation(ast::BinaryRelation& node) {
+    CollectOperands(node, node.operands, 'r', node.operators);
+}
+
+void CommonSubexpressionEliminator::VisitSum(ast::Sum& node) { CollectOperands(node, node.terms, 's', node.operators); }
+
+void CommonSubexpressionEliminator::VisitTerm(ast::Term& node) {
+    CollectOperands(node, node.unaries, 't', node.operators);
+}
+
+void CommonSubexpressionEliminator::VisitUnary(ast::Unary& node) {
+    Summary result = Collect(node, node.expr);
+    string key = "u(";
+    for (auto& op : node.prefixOps) key += op->kind == ast::PrefixOperator::PrefixOperatorKind::Minus ? '-' : '+';
+    key += "|" + result.key;
+    for (auto& op : node.postfixOps) {
+        if (auto call = dynamic_cast<ast::Call*>(op.get())) {
+            calls = true;
+            result.eligible = false;
+            for (auto& arg : call->args) Collect(*call, arg);
+        } else if (auto typecheck = dynamic_cast<ast::TypecheckOperator*>(op.get())) {
+            key += " is " + to_string(static_cast<int>(typecheck->typeId));
+        } else if (auto accop = dynamic_cast<ast::AccessorOperator*>(op.get())) {
+            auto accessor = accop->accessor.get();
+            if (auto ident = dynamic_cast<ast::IdentMemberAccessor*>(accessor)) {
+                key += "." + ident->name->identifier;
+            } else if (auto paren = dynamic_cast<ast::ParenMemberAccessor*>(accessor)) {
+                auto inner = Collect(*paren, paren->expr);
+                result.eligible = result.eligible && inner.eligible;
+                key += ".(" + inner.key + ")";
+                result.inputs.merge(inner.inputs);
+            } else if (auto index = dynamic_cast<ast::IndexAccessor*>(accessor)) {
+                auto inner = Collect(*index, index->expressionInBrackets);
+                result.eligible = result.eligible && inner.eligible;
+                key += "[" + inner.key + "]";
+                result.inputs.merge(inner.inputs);
+            } else {
+                // members by number only exist in tuples
+                result.eligible = false;
+            }
+        }
+    }
+    result.key = std::move(key) + ")";
+    summary = std::move(result);
+}
+
+void CommonSubexpressionEliminator::VisitUnaryNot(ast::UnaryNot& node) {
+    Summary result = Collect(node, node.nested);
+    result.key = "!(" + result.key + ")";
+    summary = std::move(result);
+}
+
+void CommonSubexpressionEliminator::VisitPrimaryIdent(ast::PrimaryIdent& node) {
+    auto& name = node.name->identifier;
+    auto val = values.PeekVariable(name);
+    if (!val || !IsScalar(val->index() ? get<1>(*val)->TypeOfValue() : get<0>(*val))) return;
+    summary = {true, "$" + name, {name}};
+}
+
+void CommonSubexpressionEliminator::VisitParenthesesExpression(ast::ParenthesesExpression& node) {
+    summary = Collect(node, node.expr);
+}
+
+// Tuples and arrays are mutable, a new one is needed every time
+void CommonSubexpressionEliminator::VisitTupleLiteral(ast::TupleLiteral& node) {
+    for (auto& elem : node.elements) Collect(*elem, elem->expression);
+    summary = {};
+}
+
+void CommonSubexpressionEliminator::VisitArrayLiteral(ast::ArrayLiteral& node) {
+    for (auto& item : node.items) Collect(node, item);
+    summary = {};
+}
+
+void CommonSubexpressionEliminator::VisitFuncLiteral([[maybe_unused]] ast::FuncLiteral& node) {}
+
+void CommonSubexpressionEliminator::VisitTokenLiteral([[maybe_unused]] ast::TokenLiteral& node) {}
+
+void CommonSubexpressionEliminator::VisitCustom(ast::ASTNode& node) {
+    if (auto inlined = dynamic_cast<ast::InlinedCall*>(&node)) {
+        calls = true;
+        for (auto& arg : inlined->Args) Collect(*inlined, arg);
+        summary = {};
+        return;
+    }
+    auto precomp = dynamic_cast<ast::PrecomputedValue*>(&node);
+    if (!precomp) return;  // closures only run when called, and hoisted values are already shared
+    auto type = precomp->Value->TypeOfValue();
+    if (!IsScalar(type)) return;
+    ostringstream key;
+    if (type->TypeEq(runtime::RealType())) {
+        // a printed real may be rounded
+        key << "real@" << precomp;
+    } else {
+        ostringstream printed;
+        precomp->Value->PrintSelf(printed);
+        key << type->Name() << printed.str().size() << ":" << printed.str();
+    }
+    summary = {true, key.str(), {}};
+}
+
+}  // namespace semantic
+}  // namespace dinterp
@@ -0,0 +1,125 @@
+#include "dinterp/semantic/deadStores.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "dinterp/syntax.h"
+using namespace std;
+
+namespace dinterp {
+namespace semantic {
+
+DeadStoreEliminator::DeadStoreEliminator(ValueTimeline& values, const ScopeStats& stats) : values(values) {
+    for (auto& [name, stmt] : stats.removableAssignments) useless.emplace(stmt, name);
+    unread.insert(stats.variablesOnlyStored.begin(), stats.variablesOnlyStored.end());
+}
+
+static bool DeclaresNothing(const ast::Body& body) {
+    return ranges::none_of(body.statements, [](const shared_ptr<ast::Statement>& stmt) {
+        return dynamic_cast<const ast::VarStatement*>(stmt.get()) != nullptr;
+    });
+}
+
+void DeadStoreEliminator::Eliminate(ast::Body& body) {
+    for (auto& stmt : body.statements)
+        if (!dynamic_cast<ast::VarStatement*>(stmt.get())) FindRedeclared(*stmt);
+    Sweep(body, {});
+}
+
+void DeadStoreEliminator::FindRedeclared(const ast::Statement& stmt) {
+    if (unread.empty()) return;
+    if (auto var = dynamic_cast<const ast::VarStatement*>(&stmt)) {
+        for (auto& def : var->definitions) unread.erase(def.first->identifier);
+    } else if (auto body = dynamic_cast<const ast::Body*>(&stmt)) {
+        for (auto& nested : body->statements) FindRedeclared(*nested);
+    } else if (auto ifstmt = dynamic_cast<const ast::IfStatement*>(&stmt)) {
+        FindRedeclared(*ifstmt->doIfTrue);
+        if (ifstmt->doIfFalse) FindRedeclared(**ifstmt->doIfFalse);
+    } else if (auto shortif = dynamic_cast<const ast::ShortIfStatement*>(&stmt)) {
+        FindRedeclared(*shortif->doIfTrue);
+    } else if (auto whilestmt = dynamic_cast<const ast::WhileStatement*>(&stmt)) {
+        FindRedeclared(*whilestmt->action);
+    } else if (auto forstmt = dynamic_cast<const ast::ForStatement*>(&stmt)) {
+        if (forstmt->optVariableName) unread.erase(forstmt->optVariableName.value()->identifier);
+        FindRedeclared(*forstmt->action);
+    } else if (auto loopstmt = dynamic_cast<const ast::LoopStatement*>(&stmt)) {
+        FindRedeclared(*loopstmt->body);
+    }
+}
+
+void DeadStoreEliminator::Sweep(ast::Body& body, set<string> live) {
+    bool removing = !useless.empty() || !unread.empty();
+    bool changed = false;
+    vector<shared_ptr<ast::Statement>> kept;
+    kept.reserve(body.statements.size());
+    for (auto& stmt : body.statements) {
+        if (auto asg = dynamic_cast<ast::AssignStatement*>(stmt.get())) {
+            auto& name = asg->dest->baseIdent->identifier;
+            if (asg->dest->accessorChain.empty() && (live.contains(name) || useless.contains({asg, name}))) {
+                changed = true;
+                continue;
+            }
+        } else if (auto var = dynamic_cast<ast::VarStatement*>(stmt.get())) {
+            if (removing) SweepDeclaration(*var, live);
+            if (var->definitions.empty()) {
+                changed = true;
+                continue;
+            }
+        } else if (auto nested = dynamic_cast<ast::Body*>(stmt.get())) {
+            if (removing) Sweep(*nested, live);
+            // the bodies left by the `if` statements with a known condition often need no scope of their own
+            if (DeclaresNothing(*nested)) {
+                kept.insert(kept.end(), nested->statements.begin(), nested->statements.end());
+                changed = true;
+                continue;
+            }
+        } else if (removing) {
+            SweepNested(*stmt, live);
+        }
+        kept.push_back(stmt);
+    }
+    if (!changed) return;
+    values.WillChange(body);
+    body.statements = std::move(kept);
+}
+
+void DeadStoreEliminator::SweepNested(ast::Statement& stmt, const set<string>& live) {
+    if (auto ifstmt = dynamic_cast<ast::IfStatement*>(&stmt)) {
+        Sweep(*ifstmt->doIfTrue, live);
+        if (ifstmt->doIfFalse) Sweep(**ifstmt->doIfFalse, live);
+    } else if (auto whilestmt = dynamic_cast<ast::WhileStatement*>(&stmt)) {
+        Sweep(*whilestmt->action, live);
+    } else if (auto forstmt = dynamic_cast<ast::ForStatement*>(&stmt)) {
+        Sweep(*forstmt->action, live);
+    } else if (auto loopstmt = dynamic_cast<ast::LoopStatement*>(&stmt)) {
+        Sweep(*loopstmt->body, live);
+    }
+}
+
+void DeadStoreEliminator::SweepDeclaration(ast::VarStatement& stmt, set<string>& live) {
+    bool changed = false;
+    auto definitions = stmt.definitions;
+    for (auto iter = definitions.begin(); iter != definitions.end();) {
+        auto& name = iter->first->identifier;
+        bool dead = unread.contains(name);
+        if (dead) {
+            live.insert(name);
+            if (!values.PeekVariable(name)) {
+                iter = definitions.erase(iter);
+                changed = true;
+                continue;
+            }
+        }
+        if (iter->second && (dead || useless.contains({&stmt, name}))) {
+            iter->second.reset();
+            changed = true;
+        }
+        ++iter;
+    }
+    if (!changed) return;
+    values.WillChange(stmt);
+    stmt.definitions = std::move(definitions);
+}
+
+}  // namespace semantic
+}  // namespace dinterp
@@ -2,16 +2,19 @@
 
 #include <algorithm>
 #include <memory>
+#include <set>
 #include <stdexcept>
 
 #include "dinterp/lexer.h"
 #include "dinterp/locators/locator.h"
 #include "dinterp/runtime/types.h"
 #include "dinterp/runtime/values.h"
+#include "dinterp/semantic/closureChecks.h"
 #include "dinterp/semantic/diagnostics.h"
 #include "dinterp/semantic/statementChecker.h"
 #include "dinterp/semantic/unaryOpsChecker.h"
 #include "dinterp/syntax.h"
+#include "dinterp/syntaxext/astDeepCopy.h"
 #include "dinterp/syntaxext/precomputed.h"
 using namespace std;
 
@@ -177,6 +180,7 @@ void ExpressionChecker::VisitAndOrOperator(bool isOr, vector<shared_ptr<ast::Exp
 }
 
 void ExpressionChecker::VisitXorOperator(ast::XorOperator& node) {
+    values.WillChange(node);
     const char* OPERATOR_NAME = "xor";
     vector<ExpressionChecker> rec;
     size_t valuesknown = 0;
@@ -257,11 +261,18 @@ void ExpressionChecker::VisitXorOperator(ast::XorOperator& node) {
         this->res = make_shared<runtime::BoolType>();
 }
 
-void ExpressionChecker::VisitOrOperator(ast::OrOperator& node) { VisitAndOrOperator(true, node.operands, node.pos); }
+void ExpressionChecker::VisitOrOperator(ast::OrOperator& node) {
+    values.WillChange(node);
+    VisitAndOrOperator(true, node.operands, node.pos);
+}
 
-void ExpressionChecker::VisitAndOperator(ast::AndOperator& node) { VisitAndOrOperator(false, node.operands, node.pos); }
+void ExpressionChecker::VisitAndOperator(ast::AndOperator& node) {
+    values.WillChange(node);
+    VisitAndOrOperator(false, node.operands, node.pos);
+}
 
 void ExpressionChecker::VisitBinaryRelation(ast::BinaryRelation& node) {
+    values.WillChange(node);
     const char* const OPERATOR_NAMES[] = {"<", "<=", ">", ">=", "=", "/="};
     auto& operands = node.operands;
     auto& operators = node.operators;
@@ -366,6 +377,7 @@ void ExpressionChecker::VisitBinaryRelation(ast::BinaryRelation& node) {
 }
 
 void ExpressionChecker::VisitSum(ast::Sum& node) {
+    values.WillChange(node);
     const char* const OPERATOR_NAMES[] = {"+", "-"};
     auto& operands = node.terms;
     auto& operators = node.operators;
@@ -530,6 +542,7 @@ void ExpressionChecker::VisitSum(ast::Sum& node) {
 // zero-division is not pure
 // division by an int or an unknown is not pure
 void ExpressionChecker::VisitTerm(ast::Term& node) {
+    values.WillChange(node);
     const char* const OPERATOR_NAMES[] = {"*", "/"};
     auto& operands = node.unaries;
     auto& operators = node.operators;
@@ -626,7 +639,43 @@ void ExpressionChecker::VisitTerm(ast::Term& node) {
 // string.Slice(_, _, non-0) is pure
 // string.Slice(_, _, ?) is not pure
 
+// The longest closure body, in characters of source, whose calls are inlined
+static constexpr size_t MAX_INLINED_LENGTH = 160;
+
+// The variables that a body declares in its own scopes, not counting the closures it defines
+static void CollectDeclaredVariables(const ast::Statement& stmt, set<string>& names) {
+    if (auto body = dynamic_cast<const ast::Body*>(&stmt)) {
+        for (auto& child : body->statements) CollectDeclaredVariables(*child, names);
+    } else if (auto var = dynamic_cast<const ast::VarStatement*>(&stmt)) {
+        for (auto& def : var->definitions) names.insert(def.first->identifier);
+    } else if (auto ifstmt = dynamic_cast<const ast::IfStatement*>(&stmt)) {
+        CollectDeclaredVariables(*ifstmt->doIfTrue, names);
+        if (ifstmt->doIfFalse) CollectDeclaredVariables(**ifstmt->doIfFalse, names);
+    } else if (auto shortif = dynamic_cast<const ast::ShortIfStatement*>(&stmt)) {
+        CollectDeclaredVariables(*shortif->doIfTrue, names);
+    } else if (auto whilestmt = dynamic_cast<const ast::WhileStatement*>(&stmt)) {
+        CollectDeclaredVariables(*whilestmt->action, names);
+    } else if (auto forstmt = dynamic_cast<const ast::ForStatement*>(&stmt)) {
+        CollectDeclaredVariables(*forstmt->action, names);
+    } else if (auto loopstmt = dynamic_cast<const ast::LoopStatement*>(&stmt)) {
+        CollectDeclaredVariables(*loopstmt->body, names);
+    }
+}
+
+// An inlined body runs on top of the caller's scopes instead of the closure's, so it must find the same variables
+// there: the ones it captured, and none of the ones it declares (which would then be declared twice)
+static bool CanInline(const ast::ClosureDefinition& callee, const ast::Call& call, const ValueTimeline& values) {
+    auto& body = *dynamic_cast<const ast::LongFuncBody&>(*callee.Definition).funcBody;
+    if (call.args.size() != callee.Params.size() || body.pos.Length() > MAX_INLINED_LENGTH) return false;
+    auto visible = [&values](const string& name) { return values.PeekVariable(name).has_value(); };
+    if (!ranges::all_of(callee.CapturedExternals, visible)) return false;
+    set<string> declared;
+    CollectDeclaredVariables(body, declared);
+    return ranges::none_of(declared, visible);
+}
+
 void ExpressionChecker::VisitUnary(ast::Unary& node) {
+    values.WillChange(node);
     ExpressionChecker rec(log, values);
     node.expr->AcceptVisitor(rec);
     if (!rec.HasResult()) return;
@@ -639,6 +688,12 @@ void ExpressionChecker::VisitUnary(ast::Unary& node) {
     }
     locators::SpanLocator loc = node.expr->pos;
     auto val = rec.Result();
+    // checking the call may forget the closure, so it is looked up first. A closure body is checked in a blind scope,
+    // where the closures from outside of it are not known: recursive calls are not inlined
+    shared_ptr<ast::ClosureDefinition> callee;
+    if (auto ident = dynamic_cast<ast::PrimaryIdent*>(node.expr.get()))
+        if (!node.postfixOps.empty() && dynamic_cast<ast::Call*>(node.postfixOps[0].get()))
+            callee = values.KnownClosure(ident->name->identifier);
 
     bool precomp = pure && val.index();
     size_t npost = node.postfixOps.size(), npre = node.prefixOps.size();
@@ -648,17 +703,30 @@ void ExpressionChecker::VisitUnary(ast::Unary& node) {
                                                                node.postfixOps[ipost]->precedence());
         if (doPostfix) {
             UnaryOpChecker chk(log, values, val, loc);
+            if (ipost == 0 && ipre == 0 && callee) chk.CallsClosure(callee);
             node.postfixOps[ipost]->AcceptVisitor(chk);
             if (!chk.HasResult()) return;
             pure = pure && chk.Pure();
             val = chk.Result();
             auto iloc = node.postfixOps[ipost]->pos;
             loc = locators::SpanLocator(loc, iloc);
+            // the call of a known closure may have been evaluated
+            if (ipost == 0 && ipre == 0 && callee) precomp = true;
             precomp = precomp && pure && val.index() && !get<1>(val)->TypeOfValue()->Mutable();
             if (precomp) {
                 node.postfixOps.erase(node.postfixOps.begin());
                 npost--;
                 node.expr = make_shared<ast::PrecomputedValue>(loc, get<1>(val));
+                callee = nullptr;
+            } else if (ipost == 0 && ipre == 0 && callee) {
+                auto& call = dynamic_cast<ast::Call&>(*node.postfixOps[0]);
+                if (CanInline(*chk.Callee(), call, values)) {
+                    node.expr = make_shared<ast::InlinedCall>(loc, chk.Callee(), call.args);
+                    node.postfixOps.erase(node.postfixOps.begin());
+                    npost--;
+                } else
+                    ++ipost;
+                callee = nullptr;
             } else
                 ++ipost;
         } else {
@@ -683,6 +751,7 @@ void ExpressionChecker::VisitUnary(ast::Unary& node) {
 }
 
 void ExpressionChecker::VisitUnaryNot(ast::UnaryNot& node) {
+    values.WillChange(node);
     ExpressionChecker rec(log, values);
     node.nested->AcceptVisitor(rec);
     if (!rec.HasResult()) return;
@@ -691,7 +760,7 @@ void ExpressionChecker::VisitUnaryNot(ast::UnaryNot& node) {
     auto result = rec.Result();
     if (result.index()) {
         auto& rval = get<1>(result);
-        runtime::RuntimeValueResult negated = get<1>(result);
+        runtime::RuntimeValueResult negated = rval->UnaryNot();
         if (!negated) {
             errors::VectorOfSpanTypes bad{{node.nested->pos, rval->TypeOfValue()}};
             log.Log(make_shared<errors::OperatorNotApplicable>("not", bad));
@@ -725,6 +794,8 @@ void ExpressionChecker::VisitPrimaryIdent(ast::PrimaryIdent& node) {
     auto valtype = val->index() ? get<1>(*val)->TypeOfValue() : get<0>(*val);
     if (valtype->TypeEq(runtime::NoneType()))
         log.Log(make_shared<errors::NoneValueAccessed>(node.pos, node.name->identifier));
+    // a variable of unknown type is not pure, the same as any other unknown operand
+    if (isUnknown(*val)) pure = false;
     this->res = *val;
 }
 
@@ -735,6 +806,7 @@ void ExpressionChecker::VisitParenthesesExpression(ast::ParenthesesExpression& n
 
 // Tuples are mutable, cannot precompute
 void ExpressionChecker::VisitTupleLiteral(ast::TupleLiteral& node) {
+    values.WillChange(node);
     bool badnames = false;
     size_t n = node.elements.size();
     {
@@ -754,6 +826,7 @@ void ExpressionChecker::VisitTupleLiteral(ast::TupleLiteral& node) {
     }
     bool errored = false;
     for (size_t i = 0; i < n; i++) {
+        values.WillChange(*node.elements[i]);
         auto& expr = node.elements[i]->expression;
         ExpressionChecker rec(log, values);
         expr->AcceptVisitor(rec);
@@ -769,15 +842,36 @@ void ExpressionChecker::VisitTupleLiteral(ast::TupleLiteral& node) {
     this->res = make_shared<runtime::TupleType>();
 }
 
+// The variables that a closure only reads keep their values: it reads them when it is called, and a call that may
+// change them makes all the variables unknown anyway
+static void CaptureExternals(ValueTimeline& values, const ast::ClosureDefinition& closure) {
+    for (auto& name : closure.CapturedExternals) {
+        if (ranges::find(closure.AssignedExternals, name) == closure.AssignedExternals.end())
+            values.LookupVariable(name);
+        else
+            values.AssignUnknownButUsed(name);
+        values.Capture(name);
+    }
+}
+
 void ExpressionChecker::VisitFuncLiteral(ast::FuncLiteral& node) {
-    vector<string> paramnames;
-    {
+    if (auto checked = values.CheckedClosure(node)) {
+        for (auto& message : checked->messages) log.Log(message);
+        CaptureExternals(values, *checked->definition);
+        replacement = checked->definition;
+        res = checked->definition->Type;
+        return;
+    }
+    shared_ptr<ast::ClosureDefinition> closure;
+    // the messages of the check are kept with the closure, since they may be thrown away with the speculation
+    complog::AccumulatedCompilationLog closureLog;
+    auto ahead = values.ClosureChecksAhead();
+    if (!ahead || !ahead->Take(node, values, closureLog, closure)) {
         bool badnames = false;
         map<string, vector<locators::SpanLocator>> locs;
         for (auto& param : node.parameters) {
             auto span = param->span;
             locs[param->identifier].emplace_back(node.pos.File(), span.position, span.length);
-            paramnames.push_back(param->identifier);
         }
         for (auto& kv : locs) {
             if (kv.second.size() <= 1) continue;
@@ -785,15 +879,33 @@ void ExpressionChecker::VisitFuncLiteral(ast::FuncLiteral& node) {
             log.Log(make_shared<errors::DuplicateParameterNames>(kv.first, kv.second));
         }
         if (badnames) return;
-    }
+        ExpressionChecker chk(closureLog, values);
+        closure = chk.CheckClosure(
+            node, vector<shared_ptr<runtime::Type>>(node.parameters.size(), make_shared<runtime::UnknownType>()));
+    }
+    for (auto& message : closureLog.Messages()) log.Log(message);
+    if (!closure) return;
+    CaptureExternals(values, *closure);
+    if (values.CurrentSpeculation())
+        values.KeepClosure({static_pointer_cast<ast::FuncLiteral>(node.shared_from_this()), closure,
+                            closureLog.Messages()});
+    replacement = closure;
+    this->res = closure->Type;
+}
 
+shared_ptr<ast::ClosureDefinition> ExpressionChecker::CheckClosure(
+    ast::FuncLiteral& node, const vector<shared_ptr<runtime::Type>>& paramtypes) {
     ValueTimeline tl(values);
+    tl.Speculate(nullptr);
     tl.StartBlindScope();
-    for (auto& param : node.parameters) {
+    vector<string> paramnames;
+    for (size_t i = 0; i < node.parameters.size(); i++) {
+        auto& param = node.parameters[i];
         auto span = param->span;
         auto loc = locators::SpanLocator(node.pos.File(), span.position, span.length);
         tl.Declare(param->identifier, loc);
-        tl.AssignType(param->identifier, make_shared<runtime::UnknownType>(), loc);
+        tl.AssignType(param->identifier, paramtypes[i], loc);
+        paramnames.push_back(param->identifier);
     }
 
     {
@@ -809,21 +921,48 @@ void ExpressionChecker::VisitFuncLiteral(ast::FuncLiteral& node) {
 
     StatementChecker chk(log, tl, true, false);
     dynamic_pointer_cast<ast::LongFuncBody>(node.funcBody)->funcBody->AcceptVisitor(chk);
-    if (chk.Terminated() == StatementChecker::TerminationKind::Errored) return;
+    if (chk.Terminated() == StatementChecker::TerminationKind::Errored) return nullptr;
     auto paraminfo = tl.EndScope();
     for (auto& unused : paraminfo.uselessAssignments)
         log.Log(make_shared<errors::AssignedValueUnused>(unused.second, unused.first));
     vector<string> captured(paraminfo.referencedExternals.size());
     std::ranges::transform(paraminfo.referencedExternals, captured.begin(),
                            [](const pair<const string, bool>& kv) { return kv.first; });
-    for (auto& name : captured) values.AssignUnknownButUsed(name);
     auto optreturnedtype = chk.Returned();
     auto returnedtype = optreturnedtype ? *optreturnedtype : make_shared<runtime::NoneType>();
-    auto functype = make_shared<runtime::FuncType>(
-        chk.Pure(), vector<shared_ptr<runtime::Type>>(node.parameters.size(), make_shared<runtime::UnknownType>()),
-        returnedtype);
-    replacement = make_shared<ast::ClosureDefinition>(node.pos, functype, node.funcBody, paramnames, captured);
-    this->res = functype;
+    auto functype = make_shared<runtime::FuncType>(chk.Pure(), paramtypes, returnedtype);
+    auto closure = make_shared<ast::ClosureDefinition>(node.pos, functype, node.funcBody, paramnames, captured);
+    for (auto& [name, assigned] : paraminfo.referencedExternals)
+        if (assigned) closure->AssignedExternals.push_back(name);
+    return closure;
+}
+
+// The most copies of a closure that are checked with known argument types
+static constexpr size_t MAX_SPECIALIZATIONS = 4;
+
+shared_ptr<ast::ClosureDefinition> ExpressionChecker::Specialize(ValueTimeline& values, ast::ClosureDefinition& closure,
+                                                                 const vector<shared_ptr<runtime::Type>>& types) {
+    if (!closure.Source || types.empty() || types.size() != closure.Params.size()) return nullptr;
+    string signature;
+    for (auto& type : types) {
+        if (!type->TypeEq(runtime::IntegerType()) && !type->TypeEq(runtime::RealType()) &&
+            !type->TypeEq(runtime::StringType()) && !type->TypeEq(runtime::BoolType()))
+            return nullptr;
+        signature += (signature.empty() ? "" : ", ") + type->Name();
+    }
+    if (auto iter = closure.Specializations.find(signature); iter != closure.Specializations.end()) return iter->second;
+    if (closure.Specializations.size() >= MAX_SPECIALIZATIONS) return nullptr;
+    // the diagnostics of the closure were reported when it was defined, and a copy with errors is not used
+    complog::AccumulatedCompilationLog discarded;
+    ExpressionChecker chk(discarded, values);
+    auto copy = dynamic_pointer_cast<ast::FuncLiteral>(ast::AstDeepCopier::Clone(*closure.Source));
+    auto specialized = chk.CheckClosure(*copy, types);
+    if (ranges::any_of(discarded.Messages(), [](const shared_ptr<complog::CompilationMessage>& message) {
+            return message->MessageSeverity() >= complog::Severity::Error();
+        }))
+        specialized = nullptr;
+    closure.Specializations.emplace(signature, specialized);
+    return specialized;
 }
 
 void ExpressionChecker::VisitTokenLiteral(ast::TokenLiteral& node) {
@@ -854,6 +993,7 @@ void ExpressionChecker::VisitTokenLiteral(ast::TokenLiteral& node) {
 
 // Arrays are mutable, cannot precompute
 void ExpressionChecker::VisitArrayLiteral(ast::ArrayLiteral& node) {
+    values.WillChange(node);
     size_t n = node.items.size();
     bool errored = false;
     for (size_t i = 0; i < n; i++) {
@@ -1,11 +1,17 @@
 #pragma once
+#include <cstddef>
+
 #include "dinterp/complog/CompilationLog.h"
+#include "dinterp/semantic/callEvaluator.h"
 #include "dinterp/syntax.h"
 
 namespace dinterp {
 namespace semantic {
 
-bool Analyze(complog::ICompilationLog& log, const std::shared_ptr<ast::Body>& program);
+// With an `evaluator`, the pure calls of known closures with constant arguments are replaced with their results. With
+// more than one thread, the closures that the top-level variables are initialized with are checked on the others
+bool Analyze(complog::ICompilationLog& log, const std::shared_ptr<ast::Body>& program,
+             ICallEvaluator* evaluator = nullptr, size_t threads = 1);
 
 }
 }  // namespace dinterp
@@ -0,0 +1,27 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dinterp/runtime/values.h"
+#include "dinterp/syntaxext/precomputed.h"
+
+namespace dinterp {
+namespace semantic {
+
+// Runs the calls of known closures with constant arguments during the analysis, so that the checker can replace them
+// with their results. The checker cannot run code by itself: the interpreter provides the evaluator
+class ICallEvaluator {
+public:
+    // The value the checked closure returns for `args`, its captured variables holding the `captured` values; nullptr
+    // if the call fails, has an effect (prints or assigns a captured variable) or does not finish within the budget
+    virtual std::shared_ptr<runtime::RuntimeValue> Evaluate(
+        const ast::ClosureDefinition& closure,
+        const std::vector<std::pair<std::string, std::shared_ptr<runtime::RuntimeValue>>>& captured,
+        const std::vector<std::shared_ptr<runtime::RuntimeValue>>& args) = 0;
+    virtual ~ICallEvaluator() = default;
+};
+
+}  // namespace semantic
+}  // namespace dinterp
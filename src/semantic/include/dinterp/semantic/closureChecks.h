@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "dinterp/complog/CompilationLog.h"
+#include "dinterp/syntax.h"
+#include "valueTimeline.h"
+
+namespace dinterp {
+namespace semantic {
+
+/*
+ * Checks the closures that the top-level `var` statements of a program are initialized with on other threads, ahead
+ * of the checker. A closure is checked in a blind scope, so its check only depends on the names visible around the
+ * literal, and for these literals the names are known in advance: the ones outside the program and the variables of
+ * the definitions before the literal. A check runs on a copy of the literal and writes its messages to a log of its
+ * own; the checker takes the result when it reaches the literal, and the messages go to its log at that point, so the
+ * log gets them in the same order as if the checker had done the check itself.
+ *
+ * The tasks are claimed in the order of the program, by the workers and by the checker, which runs the task of the
+ * literal it reaches if no worker has claimed it yet.
+ */
+class ClosureCheckPool {
+    // Refuses the calls, remembering that the check asked for one: such a check is only valid without an evaluator
+    class RefusingEvaluator : public ICallEvaluator {
+    public:
+        bool asked = false;
+        std::shared_ptr<runtime::RuntimeValue> Evaluate(
+            const ast::ClosureDefinition& closure,
+            const std::vector<std::pair<std::string, std::shared_ptr<runtime::RuntimeValue>>>& captured,
+            const std::vector<std::shared_ptr<runtime::RuntimeValue>>& args) override;
+    };
+
+    struct Task {
+        std::shared_ptr<ast::FuncLiteral> literal;  // kept, since the checker may drop the statement
+        // The predicted state around the literal, kept as long as the pool: the copy that the check changes shares
+        // nodes with it (see `ValueTimeline::Detached`)
+        const ValueTimeline values;
+        const size_t visible;  // the number of variables in `values`
+        std::atomic<bool> claimed = false;
+        std::promise<void> finished;
+        std::future<void> result = finished.get_future();
+        complog::AccumulatedCompilationLog log;
+        std::shared_ptr<ast::ClosureDefinition> closure;  // nullptr if the check failed
+        bool asked = false;
+        Task(std::shared_ptr<ast::FuncLiteral> literal, ValueTimeline values);
+    };
+
+    std::vector<std::unique_ptr<Task>> tasks;
+    std::unordered_map<const ast::FuncLiteral*, Task*> byLiteral;
+    std::atomic<size_t> next = 0;
+    std::atomic<bool> stopping = false;
+    std::vector<std::thread> workers;
+
+    static void Run(Task& task);
+    void Work();
+
+public:
+    // `outside` holds the names visible from the program; up to `threads - 1` workers are started
+    ClosureCheckPool(const ast::Body& program, const ValueTimeline& outside, size_t threads);
+    ClosureCheckPool(const ClosureCheckPool&) = delete;
+    ClosureCheckPool& operator=(const ClosureCheckPool&) = delete;
+    // Abandons the tasks that were not claimed and waits for the running ones
+    ~ClosureCheckPool();
+    // Whether the check of the literal was done ahead for the state `values` at the literal; if so, its messages are
+    // logged to `log` and `closure` is set to its result (nullptr if it failed)
+    bool Take(const ast::FuncLiteral& literal, const ValueTimeline& values, complog::ICompilationLog& log,
+              std::shared_ptr<ast::ClosureDefinition>& closure);
+};
+
+}  // namespace semantic
+}  // namespace dinterp
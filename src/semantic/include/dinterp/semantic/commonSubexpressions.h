@@ -0,0 +1,112 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "dinterp/syntax.h"
+#include "valueTimeline.h"
+
+namespace dinterp {
+namespace semantic {
+
+// Makes the `Unary`, `Sum` and `Term` expressions that a body computes several times with the same inputs share one
+// value, kept in a synthetic variable through `HoistedValue`s. An expression qualifies if it calls nothing and only
+// reads variables that hold an int, a real, a string or a bool; two occurrences share a value if no statement between
+// them assigns to any of these variables or calls anything. Only the expressions that a statement evaluates before
+// anything else in it are considered (not the ones in nested bodies or in `while` conditions).
+class CommonSubexpressionEliminator : public ast::IASTVisitor {
+    struct Summary {
+        bool eligible = false;
+        std::string key;  // equal for the expressions that compute the same thing
+        std::set<std::string> inputs;
+    };
+    struct Occurrence {
+        std::shared_ptr<ast::Expression>* slot;
+        ast::ASTNode* parent;
+        void (*willChange)(ValueTimeline& values, ast::ASTNode& parent);
+        size_t firstInner;  // the occurrences inside this one are numbered from `firstInner` up to this one
+        size_t statement;
+    };
+    struct Group {
+        size_t keyLength;
+        std::set<std::string> inputs;
+        std::vector<size_t> occurrences;
+    };
+
+    ValueTimeline& values;
+    std::string prefix;
+    std::vector<std::shared_ptr<ast::Statement>> statements;
+    std::vector<Occurrence> occurrences;
+    std::vector<Group> groups;
+    std::map<std::string, size_t> open;  // the groups that later occurrences may still join, by key
+    std::vector<std::pair<size_t, Summary>> pending;  // the occurrences met in the current statement
+    std::set<std::string> assigned;                   // by the current statement
+    bool calls = false;                               // in the current statement
+    int nested = 0;
+    Summary summary;
+    std::vector<std::string> shared;
+
+    // Visits the expression and records it if it qualifies and is evaluated first in the statement
+    template <typename Node>
+    Summary Collect(Node& parent, std::shared_ptr<ast::Expression>& expr);
+    template <typename Node, typename Operator = int>
+    void CollectOperands(Node& parent, std::vector<std::shared_ptr<ast::Expression>>& operands, char tag,
+                         const std::vector<Operator>& operators = {});
+
+public:
+    // `values` is the state of the checker, which follows the statements
+    CommonSubexpressionEliminator(ValueTimeline& values, const std::string& prefix);
+    // To be called with each statement of the body, in order, right after it is checked
+    void AddStatement(const std::shared_ptr<ast::Statement>& stmt);
+    // Replaces the occurrences that share a value; returns the first statement that uses one of them, if any
+    std::shared_ptr<ast::Statement> Eliminate();
+    // The names of the variables to declare before that statement
+    const std::vector<std::string>& Shared() const;
+    void VisitBody(ast::Body& node) override;
+    void VisitVarStatement(ast::VarStatement& node) override;
+    void VisitIfStatement(ast::IfStatement& node) override;
+    void VisitShortIfStatement(ast::ShortIfStatement& node) override;
+    void VisitWhileStatement(ast::WhileStatement& node) override;
+    void VisitForStatement(ast::ForStatement& node) override;
+    void VisitLoopStatement(ast::LoopStatement& node) override;
+    void VisitExitStatement(ast::ExitStatement& node) override;
+    void VisitAssignStatement(ast::AssignStatement& node) override;
+    void VisitPrintStatement(ast::PrintStatement& node) override;
+    void VisitReturnStatement(ast::ReturnStatement& node) override;
+    void VisitExpressionStatement(ast::ExpressionStatement& node) override;
+    void VisitCommaExpressions(ast::CommaExpressions& node) override;
+    void VisitCommaIdents(ast::CommaIdents& node) override;
+    void VisitIdentMemberAccessor(ast::IdentMemberAccessor& node) override;
+    void VisitIntLiteralMemberAccessor(ast::IntLiteralMemberAccessor& node) override;
+    void VisitParenMemberAccessor(ast::ParenMemberAccessor& node) override;
+    void VisitIndexAccessor(ast::IndexAccessor& node) override;
+    void VisitReference(ast::Reference& node) override;
+    void VisitXorOperator(ast::XorOperator& node) override;
+    void VisitOrOperator(ast::OrOperator& node) override;
+    void VisitAndOperator(ast::AndOperator& node) override;
+    void VisitBinaryRelation(ast::BinaryRelation& node) override;
+    void VisitSum(ast::Sum& node) override;
+    void VisitTerm(ast::Term& node) override;
+    void VisitUnary(ast::Unary& node) override;
+    void VisitUnaryNot(ast::UnaryNot& node) override;
+    void VisitPrefixOperator(ast::PrefixOperator& node) override;
+    void VisitTypecheckOperator(ast::TypecheckOperator& node) override;
+    void VisitCall(ast::Call& node) override;
+    void VisitAccessorOperator(ast::AccessorOperator& node) override;
+    void VisitPrimaryIdent(ast::PrimaryIdent& node) override;
+    void VisitParenthesesExpression(ast::ParenthesesExpression& node) override;
+    void VisitTupleLiteralElement(ast::TupleLiteralElement& node) override;
+    void VisitTupleLiteral(ast::TupleLiteral& node) override;
+    void VisitShortFuncBody(ast::ShortFuncBody& node) override;
+    void VisitLongFuncBody(ast::LongFuncBody& node) override;
+    void VisitFuncLiteral(ast::FuncLiteral& node) override;
+    void VisitTokenLiteral(ast::TokenLiteral& node) override;
+    void VisitArrayLiteral(ast::ArrayLiteral& node) override;
+    void VisitCustom(ast::ASTNode& node) override;
+    virtual ~CommonSubexpressionEliminator() = default;
+};
+
+}  // namespace semantic
+}  // namespace dinterp
@@ -0,0 +1,37 @@
+#pragma once
+#include <set>
+#include <string>
+#include <utility>
+
+#include "dinterp/syntax.h"
+#include "valueTimeline.h"
+
+namespace dinterp {
+namespace semantic {
+
+// Removes from a checked body, once its scope has ended, the assignments that the checker found useless and that store
+// a pure value that cannot fail at runtime: an assignment statement is dropped, and a `var` statement keeps the variable
+// without its initializer. A variable that is never read and only assigned such values goes away with all of its
+// assignments, unless a nested scope declares the name again; its declaration is kept if a variable of the same name is
+// visible from the body, since declaring it again is an error at runtime. Nested bodies left declaring nothing are
+// merged into their parent.
+class DeadStoreEliminator {
+    ValueTimeline& values;
+    std::set<std::pair<const ast::Statement*, std::string>> useless;
+    std::set<std::string> unread;
+
+    // Removes the names declared again inside `stmt` from `unread`
+    void FindRedeclared(const ast::Statement& stmt);
+    // `live` are the variables of `unread` that are declared at this point of the body
+    void Sweep(ast::Body& body, std::set<std::string> live);
+    void SweepNested(ast::Statement& stmt, const std::set<std::string>& live);
+    void SweepDeclaration(ast::VarStatement& stmt, std::set<std::string>& live);
+
+public:
+    // `values` is the state after the scope of the body has ended, with `stats`
+    DeadStoreEliminator(ValueTimeline& values, const ScopeStats& stats);
+    void Eliminate(ast::Body& body);
+};
+
+}  // namespace semantic
+}  // namespace dinterp
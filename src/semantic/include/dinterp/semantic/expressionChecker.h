@@ -20,6 +20,9 @@ class ExpressionChecker : public ast::IASTVisitor {
 
     void VisitAndOrOperator(bool isOr, std::vector<std::shared_ptr<ast::Expression>>& operands,
                             const locators::SpanLocator& position);
+    // Checks the body of a function literal in a blind scope, with parameters of the given types; nullptr on errors
+    std::shared_ptr<ast::ClosureDefinition> CheckClosure(ast::FuncLiteral& node,
+                                                         const std::vector<std::shared_ptr<runtime::Type>>& paramtypes);
 
 public:
     ExpressionChecker(complog::ICompilationLog& log, ValueTimeline& values);
@@ -29,6 +32,10 @@ public:
     std::optional<std::shared_ptr<ast::ASTNode>> Replacement() const;
     std::shared_ptr<ast::Expression> AssertReplacementAsExpression() const;
     ValueTimeline& ProgramState() const;
+    // The closure checked again from its source for arguments of the given types (ints, reals, strings or bools), at
+    // most once per list of types; nullptr if that is not possible. `values` is the state at the call site
+    static std::shared_ptr<ast::ClosureDefinition> Specialize(ValueTimeline& values, ast::ClosureDefinition& closure,
+                                                              const std::vector<std::shared_ptr<runtime::Type>>& types);
     void VisitBody(ast::Body& node) override;
     void VisitVarStatement(ast::VarStatement& node) override;
     void VisitIfStatement(ast::IfStatement& node) override;
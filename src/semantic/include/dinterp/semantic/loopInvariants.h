@@ -1,25 +1,46 @@
 #pragma once
-#include "dinterp/locators/locator.h"
-#include "dinterp/runtime/values.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
 #include "dinterp/syntax.h"
-#include "runtimeContext.h"
-#include "varScopes.h"
+#include "valueTimeline.h"
 
 namespace dinterp {
-namespace interp {
+namespace semantic {
+
+// Moves the expressions of a checked loop whose value cannot change while the loop runs into `HoistedValue`s, so that
+// each of them is evaluated once per run of the loop. An expression is invariant if it calls nothing and only reads
+// variables from outside the loop that the loop never assigns to and that hold an int, a real, a string or a bool at
+// the head of the loop; closures are left alone. Only the largest invariant expressions are moved.
+class LoopInvariantHoister : public ast::IASTVisitor {
+    ValueTimeline& head;
+    const std::set<std::string>& assigned;
+    std::string prefix;
+    std::vector<std::set<std::string>> locals;
+    std::vector<std::string> hoisted;
+    std::map<std::string, std::string> renamed;  // the values already shared inside the loop keep being shared
+    bool invariant = false;
 
-class UnaryOpExecutor : public ast::IASTVisitor {
-    RuntimeContext& context;
-    std::shared_ptr<ScopeStack> scopes;
-    std::shared_ptr<runtime::RuntimeValue> curValue;
-    locators::SpanLocator curPos;
-    void AccessFieldByIndex(const runtime::RuntimeValue& index, const locators::SpanLocator& accessorPos);
+    bool IsInvariantVariable(const std::string& name);
+    // Visits the expression and returns whether it is invariant; if it is not, its invariant parts are hoisted
+    bool Check(std::shared_ptr<ast::Expression>& expr);
+    template <typename Node>
+    void Hoist(Node& parent, std::shared_ptr<ast::Expression>& expr);
+    template <typename Node>
+    void HoistIfInvariant(Node& parent, std::shared_ptr<ast::Expression>& expr);
+    // Returns whether all the operands are invariant; if not, hoists the ones that are
+    template <typename Node>
+    bool CheckOperands(Node& parent, std::vector<std::shared_ptr<ast::Expression>>& operands);
 
 public:
-    UnaryOpExecutor(RuntimeContext& context, const std::shared_ptr<ScopeStack>& scopes,
-                    const std::shared_ptr<runtime::RuntimeValue> curValue, const locators::SpanLocator& curPos);
-    const std::shared_ptr<runtime::RuntimeValue>& Value() const;
-    const locators::SpanLocator& Position() const;
+    // `head` is the state the loop body was checked from, `assigned` are the variables the loop assigns to by name
+    LoopInvariantHoister(ValueTimeline& head, const std::set<std::string>& assigned, const std::string& prefix);
+    // Hoists from the condition and the body of a `while`, `for` or `loop` statement
+    void HoistFromLoop(ast::Statement& loop);
+    // The names of the variables to declare before the loop
+    const std::vector<std::string>& Hoisted() const;
     void VisitBody(ast::Body& node) override;
     void VisitVarStatement(ast::VarStatement& node) override;
     void VisitIfStatement(ast::IfStatement& node) override;
@@ -61,8 +82,8 @@ public:
     void VisitTokenLiteral(ast::TokenLiteral& node) override;
     void VisitArrayLiteral(ast::ArrayLiteral& node) override;
     void VisitCustom(ast::ASTNode& node) override;
-    virtual ~UnaryOpExecutor() override = default;
+    virtual ~LoopInvariantHoister() = default;
 };
 
-}  // namespace interp
+}  // namespace semantic
 }  // namespace dinterp
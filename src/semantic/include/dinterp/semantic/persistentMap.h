@@ -0,0 +1,198 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace dinterp {
+namespace semantic {
+
+/*
+ * An ordered map whose copies share their nodes (an AVL tree with path copying). Copying the map is O(1); a change
+ * copies only the nodes on the path to the changed entry that are shared with another map, so a copy that is changed
+ * in k places costs O(k log n) on top of the original. Nodes that only this map owns are changed in place.
+ *
+ * Two maps forked from one another keep sharing the subtrees that neither of them changed, which `Merge` skips.
+ */
+template <typename Key, typename Value>
+class PersistentMap {
+    struct Node {
+        Key key;
+        Value value;
+        std::shared_ptr<Node> left, right;
+        int height = 1;
+        Node(Key key, Value value) : key(std::move(key)), value(std::move(value)) {}
+    };
+
+    std::shared_ptr<Node> root;
+    size_t size = 0;
+
+    static int Height(const std::shared_ptr<Node>& node) { return node ? node->height : 0; }
+
+    // Makes `node` owned by this map alone, copying it (but not its children) if it is shared
+    static void Detach(std::shared_ptr<Node>& node) {
+        if (node.use_count() > 1) node = std::make_shared<Node>(*node);
+    }
+
+    static void UpdateHeight(Node& node) { node.height = std::max(Height(node.left), Height(node.right)) + 1; }
+
+    // The nodes that rotate must be detached
+    static void RotateRight(std::shared_ptr<Node>& node) {
+        auto left = std::move(node->left);
+        node->left = std::move(left->right);
+        UpdateHeight(*node);
+        left->right = std::move(node);
+        UpdateHeight(*left);
+        node = std::move(left);
+    }
+
+    static void RotateLeft(std::shared_ptr<Node>& node) {
+        auto right = std::move(node->right);
+        node->right = std::move(right->left);
+        UpdateHeight(*node);
+        right->left = std::move(node);
+        UpdateHeight(*right);
+        node = std::move(right);
+    }
+
+    // Only the nodes on the path of the last insertion may be out of balance, and those are detached
+    static void Rebalance(std::shared_ptr<Node>& node) {
+        int balance = Height(node->left) - Height(node->right);
+        if (balance > 1) {
+            if (Height(node->left->left) < Height(node->left->right)) RotateLeft(node->left);
+            RotateRight(node);
+        } else if (balance < -1) {
+            if (Height(node->right->right) < Height(node->right->left)) RotateRight(node->right);
+            RotateLeft(node);
+        } else
+            UpdateHeight(*node);
+    }
+
+    static bool Insert(std::shared_ptr<Node>& node, Key& key, Value& value) {
+        if (!node) {
+            node = std::make_shared<Node>(std::move(key), std::move(value));
+            return true;
+        }
+        if (!(key < node->key) && !(node->key < key)) return false;
+        Detach(node);
+        bool inserted = Insert(key < node->key ? node->left : node->right, key, value);
+        if (inserted) Rebalance(node);
+        return inserted;
+    }
+
+    template <typename F>
+    static void Update(std::shared_ptr<Node>& node, const Key& key, F& change) {
+        Detach(node);
+        if (key < node->key)
+            Update(node->left, key, change);
+        else if (node->key < key)
+            Update(node->right, key, change);
+        else
+            change(node->value);
+    }
+
+    template <typename F>
+    static void ForEach(const std::shared_ptr<Node>& node, F& f) {
+        if (!node) return;
+        ForEach(node->left, f);
+        f(std::as_const(node->key), std::as_const(node->value));
+        ForEach(node->right, f);
+    }
+
+    template <typename F>
+    static void ChangeEach(std::shared_ptr<Node>& node, F& change) {
+        if (!node) return;
+        Detach(node);
+        ChangeEach(node->left, change);
+        change(std::as_const(node->key), node->value);
+        ChangeEach(node->right, change);
+    }
+
+    // Whether the trees have the same keys in the same places, which is the case if neither of them had keys added
+    // since they were forked
+    static bool SameShape(const std::shared_ptr<Node>& a, const std::shared_ptr<Node>& b) {
+        if (a == b) return true;
+        if (!a || !b || a->key < b->key || b->key < a->key) return false;
+        return SameShape(a->left, b->left) && SameShape(a->right, b->right);
+    }
+
+    template <typename F>
+    static void MergeSameShape(std::shared_ptr<Node>& dest, const std::shared_ptr<Node>& src, F& merge) {
+        if (dest == src) return;
+        Detach(dest);
+        merge(dest->value, std::as_const(src->value));
+        MergeSameShape(dest->left, src->left, merge);
+        MergeSameShape(dest->right, src->right, merge);
+    }
+
+public:
+    size_t Size() const { return size; }
+
+    const Value* Find(const Key& key) const {
+        const Node* node = root.get();
+        while (node) {
+            if (key < node->key)
+                node = node->left.get();
+            else if (node->key < key)
+                node = node->right.get();
+            else
+                return &node->value;
+        }
+        return nullptr;
+    }
+
+    bool Contains(const Key& key) const { return Find(key); }
+
+    // Returns false (and leaves the map as it was) if the key is present
+    bool Insert(Key key, Value value) {
+        bool inserted = Insert(root, key, value);
+        size += inserted;
+        return inserted;
+    }
+
+    // Calls `change(Value&)` on the value of the key, which must be present
+    template <typename F>
+    void Update(const Key& key, F change) {
+        Update(root, key, change);
+    }
+
+    // Calls `change(Value&)` on the value of the key, inserting `Value()` first if the key is absent
+    template <typename F>
+    void Upsert(const Key& key, F change) {
+        if (!Contains(key)) Insert(key, Value());
+        Update(root, key, change);
+    }
+
+    // Calls `f(const Key&, const Value&)` for every entry, in the order of the keys
+    template <typename F>
+    void ForEach(F f) const {
+        ForEach(root, f);
+    }
+
+    // Calls `change(const Key&, Value&)` for every entry, in the order of the keys
+    template <typename F>
+    void ChangeEach(F change) {
+        ChangeEach(root, change);
+    }
+
+    // Calls `merge(Value& mine, const Value& theirs)` for every key of `other` that this map has, and copies the
+    // entries of the other keys. If the maps were forked from one another and neither got new keys since, the subtrees
+    // they still share are skipped, so the cost depends on how much they changed; `merge` must therefore leave a value
+    // alone when it is merged with itself.
+    template <typename F>
+    void Merge(const PersistentMap& other, F merge) {
+        if (SameShape(root, other.root)) {
+            MergeSameShape(root, other.root, merge);
+            return;
+        }
+        other.ForEach([this, &merge](const Key& key, const Value& value) {
+            if (Contains(key))
+                Update(key, [&merge, &value](Value& mine) { merge(mine, value); });
+            else
+                Insert(key, value);
+        });
+    }
+};
+
+}  // namespace semantic
+}  // namespace dinterp
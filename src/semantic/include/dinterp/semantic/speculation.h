@@ -0,0 +1,69 @@
+#pragma once
+#include <memory>
+#include <stdexcept>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "dinterp/complog/CompilationMessage.h"
+#include "dinterp/syntax.h"
+#include "dinterp/syntaxext/precomputed.h"
+
+namespace dinterp {
+namespace semantic {
+
+// A closure checked during a speculation, with the literal it was checked from and the messages of its check
+struct KeptClosure {
+    std::shared_ptr<ast::FuncLiteral> literal;
+    std::shared_ptr<ast::ClosureDefinition> definition;
+    std::vector<std::shared_ptr<complog::CompilationMessage>> messages;
+};
+
+/*
+ * An undo log for the checks whose result may be thrown away: the first check of a `while` condition, done with the
+ * values from before the loop, and the tries of a loop body from a state at its head that may still change (see
+ * `StatementChecker::CheckLoop`). The checkers rewrite the nodes they visit in place, so while speculating they save
+ * every node before changing it, and `Undo` puts the saved (shallow) copies back.
+ *
+ * Speculations nest: a kept one hands its log over to the speculation it is nested in, which may still undo it.
+ *
+ * A closure is checked in a blind scope, so its check does not depend on the values around it. It is needed again when
+ * the check that replaced the closure is undone, and so are its messages, which were logged where the undone check
+ * logged its own: the closures checked during a speculation are kept for all the speculations nested in the same
+ * outermost one, and dropped with it.
+ */
+class Speculation {
+    struct SavedNode {
+        std::shared_ptr<ast::ASTNode> node, copy;
+        void (*restore)(ast::ASTNode& node, const ast::ASTNode& copy);
+    };
+
+    Speculation* outer;
+    std::vector<SavedNode> saved;
+    std::shared_ptr<std::unordered_map<const ast::FuncLiteral*, KeptClosure>> closures;
+
+public:
+    explicit Speculation(Speculation* outer);
+
+    // `Node` must be the dynamic type of the node
+    template <typename Node>
+    void Save(Node& node) {
+#ifdef DINTERP_DEBUG
+        if (typeid(node) != typeid(Node)) throw std::logic_error("Speculation::Save called with a base class");
+#endif
+        saved.push_back({node.shared_from_this(), std::make_shared<Node>(node),
+                         [](ast::ASTNode& node, const ast::ASTNode& copy) {
+                             static_cast<Node&>(node) = static_cast<const Node&>(copy);
+                         }});
+    }
+
+    Speculation* Outer() const;
+    void Undo();
+    void Keep();
+    // nullptr if the literal was not checked during this speculation or the ones nested in the same outermost one
+    const KeptClosure* CheckedClosure(const ast::FuncLiteral& literal) const;
+    void KeepClosure(KeptClosure closure);
+};
+
+}  // namespace semantic
+}  // namespace dinterp
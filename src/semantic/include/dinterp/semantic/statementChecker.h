@@ -1,4 +1,7 @@
 #pragma once
+#include <set>
+#include <string>
+
 #include "dinterp/complog/CompilationLog.h"
 #include "dinterp/runtime/types.h"
 #include "dinterp/runtime/values.h"
@@ -22,7 +25,15 @@ private:
     bool inFunction, inCycle;
     TerminationKind terminationKind;
 
-    void VisitLoopBodyAndEndScope(std::shared_ptr<ast::Body>& body);
+    void CheckLoop(ast::Statement& loop, std::shared_ptr<ast::Expression>* condition, std::shared_ptr<ast::Body>& body,
+                   const IdentifierToken* variable, const std::shared_ptr<runtime::Type>& variableType);
+    // Declares the synthetic variables of the hoisted expressions before the loop, in the replacement
+    void HoistLoopInvariants(ast::Statement& loop, ValueTimeline& head, const std::set<std::string>& assigned);
+    // Returns the state at the end of the body, if the body can reach it
+    std::optional<ValueTimeline> CheckLoopIteration(std::shared_ptr<ast::Expression>* condition,
+                                                    std::shared_ptr<ast::Body>& body, const IdentifierToken* variable,
+                                                    const std::shared_ptr<runtime::Type>& variableType);
+    std::optional<ValueTimeline> VisitLoopBodyAndEndScope(std::shared_ptr<ast::Body>& body);
     void AddReturnType(const std::shared_ptr<runtime::Type>& type);
     void AddReturnType(const std::optional<std::shared_ptr<runtime::Type>>& type);
 
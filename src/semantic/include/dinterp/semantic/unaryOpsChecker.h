@@ -16,6 +16,7 @@ private:
     locators::SpanLocator pos;
     bool pure = true;
     std::optional<runtime::TypeOrValue> res;
+    std::shared_ptr<ast::ClosureDefinition> callee;
 
 public:
     UnaryOpChecker(complog::ICompilationLog& log, ValueTimeline& values, const runtime::TypeOrValue& curvalue,
@@ -23,6 +24,10 @@ public:
     bool HasResult() const;
     bool Pure() const;
     runtime::TypeOrValue Result() const;
+    // The value is known to be this closure, which a call may then specialize for its arguments
+    void CallsClosure(const std::shared_ptr<ast::ClosureDefinition>& closure);
+    // The closure a call runs: the known one, or its copy specialized for the arguments
+    std::shared_ptr<ast::ClosureDefinition> Callee() const;
     void VisitBody(ast::Body& node) override;
     void VisitVarStatement(ast::VarStatement& node) override;
     void VisitIfStatement(ast::IfStatement& node) override;
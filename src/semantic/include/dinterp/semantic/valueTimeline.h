@@ -4,52 +4,126 @@
 
 #include "dinterp/locators/locator.h"
 #include "dinterp/runtime.h"
+#include "dinterp/semantic/callEvaluator.h"
+#include "dinterp/semantic/persistentMap.h"
+#include "dinterp/semantic/speculation.h"
+#include "dinterp/syntaxext/precomputed.h"
 
 namespace dinterp {
 namespace semantic {
 
+class ClosureCheckPool;
+
 struct ScopeStats {
     std::vector<std::pair<std::string, locators::SpanLocator>> uselessAssignments;
     std::vector<std::pair<std::string, locators::SpanLocator>> variablesNeverUsed;
     std::map<std::string, bool> referencedExternals;  // true if assigned
+    // The statements of the useless assignments that store a pure value that cannot fail: `var` statements (for the
+    // initializer of the variable) and assignment statements
+    std::vector<std::pair<std::string, const ast::Statement*>> removableAssignments;
+    // The variables that are never read and are only assigned such values by statements
+    std::vector<std::string> variablesOnlyStored;
 };
 
+// Timelines are copied at every branch, so the scopes are persistent maps: a copy shares all of its variables with the
+// original, and merging two copies only visits the variables that changed in either of them
 class ValueTimeline {
+    struct Assignment {
+        locators::SpanLocator pos;
+        const ast::Statement* removable;
+    };
+
     struct Var {
         runtime::TypeOrValue val;
-        std::set<std::shared_ptr<locators::SpanLocator>> lastUnusedAssignments;
+        std::set<std::shared_ptr<Assignment>> lastUnusedAssignments;
         locators::SpanLocator declaration;
+        std::shared_ptr<ast::ClosureDefinition> closure;  // the closure the variable holds, if it is known
         bool used = false;
+        bool read = false;
+        bool captured = false;      // a closure may read it whenever it is called
+        bool impureStores = false;  // assigned a value that is not pure, or not by a statement
         Var(const locators::SpanLocator& declarationloc);
     };
 
     struct Scope {
-        std::map<std::string, Var> vars;
-        std::map<std::string, bool> externalReferences;  // true if assigned
+        PersistentMap<std::string, Var> vars;
+        PersistentMap<std::string, bool> externalReferences;  // true if assigned
     };
 
     std::vector<Scope> stack;
     std::vector<size_t> blindScopeIndices;
+    std::vector<size_t> loopScopeIndices;
+    Speculation* speculation = nullptr;
+    ICallEvaluator* evaluator = nullptr;
+    ClosureCheckPool* closureChecks = nullptr;
 
     std::optional<std::pair<size_t, const Var*>> Lookup(const std::string& name) const;
-    std::optional<std::pair<size_t, Var*>> Lookup(const std::string& name);
+    // What a variable found in the scope looks like from the top scope
+    runtime::TypeOrValue Visible(size_t scopeindex, const runtime::TypeOrValue& val) const;
+    // Changes the variable in the scope it is found in, after marking it as referenced from the top scope
+    template <typename F>
+    bool AssignWith(const std::string& name, F change);
+    // Records an assignment of the variable that may be useless
+    static void Store(Var& var, const locators::SpanLocator& pos, const ast::Statement* removable);
 
 public:
     std::optional<runtime::TypeOrValue> LookupVariable(const std::string& name);
+    // Same as LookupVariable, but does not count as a read of the variable
+    std::optional<runtime::TypeOrValue> PeekVariable(const std::string& name) const;
     void MakeAllUnknown();
     // Normal scope
     void StartScope();
     // Blind Scope: from inside, all external variables are of type UnknownType
     void StartBlindScope();
+    // Loop Scope: from inside, external variables that hold a mutable value are only known by its type, since the value
+    // may change through another variable
+    void StartLoopScope();
     ScopeStats EndScope();
-    bool AssignType(const std::string& name, const std::shared_ptr<runtime::Type>& type, locators::SpanLocator pos);
+    // `removable` is the statement that assigns the value, if it can be removed when the assignment is useless: the
+    // value is pure and cannot fail
+    bool AssignType(const std::string& name, const std::shared_ptr<runtime::Type>& type, locators::SpanLocator pos,
+                    const ast::Statement* removable = nullptr);
     bool AssignValue(const std::string& name, const std::shared_ptr<runtime::RuntimeValue>& precomputed,
-                     locators::SpanLocator pos);
-    bool Assign(const std::string& name, const runtime::TypeOrValue& precomputed, locators::SpanLocator pos);
+                     locators::SpanLocator pos, const ast::Statement* removable = nullptr);
+    bool Assign(const std::string& name, const runtime::TypeOrValue& precomputed, locators::SpanLocator pos,
+                const ast::Statement* removable = nullptr);
     bool AssignUnknownButUsed(const std::string& name);
+    // Marks the variable as captured by a closure: it counts as read, and none of its later assignments are useless
+    void Capture(const std::string& name);
+    // Records that the variable holds the closure until it is assigned again; does not count as an assignment
+    bool BindClosure(const std::string& name, const std::shared_ptr<ast::ClosureDefinition>& closure);
+    // The closure that the variable is known to hold from the top scope, if any
+    std::shared_ptr<ast::ClosureDefinition> KnownClosure(const std::string& name) const;
     bool Declare(const std::string& name, locators::SpanLocator pos);
     locators::SpanLocator LookupDeclaration(const std::string& name);
     void MergeTimelines(const ValueTimeline& other);  // Use after an If statement
+    // Keeps only the type of the variable's value, without counting as an assignment
+    void ForgetValue(const std::string& name);
+    // Generalizes the values of the variables with those in `other`, a later state of the same scopes, and returns
+    // whether any of them changed. With `widen`, the ones that change become unknown
+    bool GeneralizeValues(const ValueTimeline& other, bool widen);
+    // The checkers that use a timeline (or its copies) during a speculation take part in it (see Speculation)
+    void Speculate(Speculation* speculation);
+    Speculation* CurrentSpeculation() const;
+    // The evaluator of pure calls, shared by the copies of the timeline; nullptr if calls are left to the runtime
+    void EvaluateCallsWith(ICallEvaluator* evaluator);
+    ICallEvaluator* CallEvaluator() const;
+    // The pool that checks closures ahead of the checker, shared by the copies of the timeline; nullptr if there is none
+    void CheckClosuresAheadWith(ClosureCheckPool* pool);
+    ClosureCheckPool* ClosureChecksAhead() const;
+    // A copy that can be used on another thread: it has no speculation, evaluator or pool. Its scopes still share nodes with this timeline, which is safe as long as this timeline is kept: a copy
+    // copies every node it shares before changing it
+    ValueTimeline Detached() const;
+    // The number of variables declared in all the scopes
+    size_t VariableCount() const;
+    // To be called by a checker before it changes a node
+    template <typename Node>
+    void WillChange(Node& node) {
+        if (speculation) speculation->Save(node);
+    }
+    // The closures checked during the current speculation (see Speculation::CheckedClosure); nullptr outside of one
+    const KeptClosure* CheckedClosure(const ast::FuncLiteral& literal) const;
+    void KeepClosure(KeptClosure closure);
 };
 
 }  // namespace semantic
@@ -1,4 +1,7 @@
 #pragma once
+#include <map>
+#include <string>
+
 #include "dinterp/locators/locator.h"
 #include "dinterp/runtime/types.h"
 #include "dinterp/runtime/values.h"
@@ -21,6 +24,11 @@ public:
     std::shared_ptr<FuncBody> Definition;
     std::vector<std::string> Params;
     std::vector<std::string> CapturedExternals;
+    std::vector<std::string> AssignedExternals;  // the captured variables that the closure may assign to
+    // An unchecked copy of the literal, kept for the closures that are bound to a variable
+    std::shared_ptr<FuncLiteral> Source;
+    // Copies of the closure checked with known argument types, by the names of the types (nullptr if the check failed)
+    std::map<std::string, std::shared_ptr<ClosureDefinition>> Specializations;
     ClosureDefinition(const locators::SpanLocator& pos, const std::shared_ptr<runtime::FuncType>& type,
                       const std::shared_ptr<FuncBody>& definition, const std::vector<std::string>& params,
                       const std::vector<std::string>& capturedExternals);
@@ -28,5 +36,30 @@ public:
     virtual ~ClosureDefinition() override = default;
 };
 
+// An expression whose value is kept in the synthetic variable `Name`, declared (as `none`) before the statements that
+// use it: it is evaluated the first time one of the `HoistedValue`s with that name is reached, and reused afterwards.
+// Used for loop-invariant expressions, declared right before the loop, and for common subexpressions of a body
+class HoistedValue : public Expression {
+public:
+    std::string Name;
+    std::shared_ptr<Expression> Expr;
+    HoistedValue(const locators::SpanLocator& pos, const std::string& name, const std::shared_ptr<Expression>& expr);
+    void AcceptVisitor(IASTVisitor& vis) override;
+    virtual ~HoistedValue() override = default;
+};
+
+// A call of a closure that is known at the call site, replaced by the closure's body: the arguments are bound to the
+// parameters in a new scope on top of the caller's, where the body of `Callee` runs. The call is pushed on the call
+// stack at `pos` like a real call, so stack traces and the positions of errors stay the same
+class InlinedCall : public Expression {
+public:
+    std::shared_ptr<ClosureDefinition> Callee;
+    std::vector<std::shared_ptr<Expression>> Args;
+    InlinedCall(const locators::SpanLocator& pos, const std::shared_ptr<ClosureDefinition>& callee,
+                const std::vector<std::shared_ptr<Expression>>& args);
+    void AcceptVisitor(IASTVisitor& vis) override;
+    virtual ~InlinedCall() override = default;
+};
+
 }  // namespace ast
 }  // namespace dinterp
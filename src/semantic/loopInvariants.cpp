@@ -0,0 +1,259 @@
+#include "dinterp/semantic/loopInvariants.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "dinterp/runtime/types.h"
+#include "dinterp/runtime/values.h"
+#include "dinterp/syntax.h"
+#include "dinterp/syntaxext/precomputed.h"
+using namespace std;
+
+namespace dinterp {
+namespace semantic {
+
+LoopInvariantHoister::LoopInvariantHoister(ValueTimeline& head, const set<string>& assigned, const string& prefix)
+    : head(head), assigned(assigned), prefix(prefix) {}
+
+const vector<string>& LoopInvariantHoister::Hoisted() const { return hoisted; }
+
+bool LoopInvariantHoister::IsInvariantVariable(const string& name) {
+    if (assigned.contains(name)) return false;
+    if (ranges::any_of(locals, [&name](const set<string>& scope) { return scope.contains(name); })) return false;
+    auto val = head.PeekVariable(name);
+    if (!val) return false;
+    auto type = val->index() ? get<1>(*val)->TypeOfValue() : get<0>(*val);
+    return type->TypeEq(runtime::IntegerType()) || type->TypeEq(runtime::RealType()) ||
+           type->TypeEq(runtime::StringType()) || type->TypeEq(runtime::BoolType());
+}
+
+bool LoopInvariantHoister::Check(shared_ptr<ast::Expression>& expr) {
+    invariant = false;
+    expr->AcceptVisitor(*this);
+    return invariant;
+}
+
+template <typename Node>
+void LoopInvariantHoister::Hoist(Node& parent, shared_ptr<ast::Expression>& expr) {
+    // a variable or a constant is as cheap to evaluate as the hoisted value
+    if (dynamic_cast<ast::PrimaryIdent*>(expr.get()) || dynamic_cast<ast::PrecomputedValue*>(expr.get())) return;
+    auto value = expr;
+    string name = prefix + to_string(hoisted.size());
+    bool fresh = true;
+    // hoisted from an inner loop or shared in the body, and invariant in this loop as well
+    if (auto inner = dynamic_cast<ast::HoistedValue*>(expr.get())) {
+        value = inner->Expr;
+        auto [outer, added] = renamed.emplace(inner->Name, name);
+        name = outer->second;
+        fresh = added;
+    }
+    if (fresh) hoisted.push_back(name);
+    head.WillChange(parent);
+    expr = make_shared<ast::HoistedValue>(expr->pos, name, value);
+}
+
+template <typename Node>
+void LoopInvariantHoister::HoistIfInvariant(Node& parent, shared_ptr<ast::Expression>& expr) {
+    if (Check(expr)) Hoist(parent, expr);
+}
+
+template <typename Node>
+bool LoopInvariantHoister::CheckOperands(Node& parent, vector<shared_ptr<ast::Expression>>& operands) {
+    vector<bool> invariants;
+    invariants.reserve(operands.size());
+    for (auto& operand : operands) invariants.push_back(Check(operand));
+    if (ranges::all_of(invariants, [](bool inv) { return inv; })) return true;
+    for (size_t i = 0; i < operands.size(); i++)
+        if (invariants[i]) Hoist(parent, operands[i]);
+    return false;
+}
+
+void LoopInvariantHoister::HoistFromLoop(ast::Statement& loop) {
+    locals.emplace_back();
+    if (auto whilestmt = dynamic_cast<ast::WhileStatement*>(&loop)) {
+        HoistIfInvariant(*whilestmt, whilestmt->condition);
+        whilestmt->action->AcceptVisitor(*this);
+    } else if (auto forstmt = dynamic_cast<ast::ForStatement*>(&loop)) {
+        // the range or the list is only evaluated once
+        if (forstmt->optVariableName) locals.back().insert(forstmt->optVariableName.value()->identifier);
+        forstmt->action->AcceptVisitor(*this);
+    } else if (auto loopstmt = dynamic_cast<ast::LoopStatement*>(&loop)) {
+        loopstmt->body->AcceptVisitor(*this);
+    }
+    locals.pop_back();
+}
+
+#define DISALLOWED_VISIT(name)                                                 \
+    void LoopInvariantHoister::Visit##name([[maybe_unused]] ast::name& node) { \
+        throw runtime_error("LoopInvariantHoister cannot visit ast::" #name);  \
+    }
+
+void LoopInvariantHoister::VisitBody(ast::Body& node) {
+    locals.emplace_back();
+    for (auto& stmt : node.statements) stmt->AcceptVisitor(*this);
+    locals.pop_back();
+}
+
+void LoopInvariantHoister::VisitVarStatement(ast::VarStatement& node) {
+    for (auto& [name, value] : node.definitions) {
+        if (value) HoistIfInvariant(node, *value);
+        locals.back().insert(name->identifier);
+    }
+}
+
+void LoopInvariantHoister::VisitIfStatement(ast::IfStatement& node) {
+    HoistIfInvariant(node, node.condition);
+    node.doIfTrue->AcceptVisitor(*this);
+    if (node.doIfFalse) node.doIfFalse.value()->AcceptVisitor(*this);
+}
+
+void LoopInvariantHoister::VisitShortIfStatement(ast::ShortIfStatement& node) {
+    HoistIfInvariant(node, node.condition);
+    locals.emplace_back();
+    node.doIfTrue->AcceptVisitor(*this);
+    locals.pop_back();
+}
+
+void LoopInvariantHoister::VisitWhileStatement(ast::WhileStatement& node) {
+    HoistIfInvariant(node, node.condition);
+    node.action->AcceptVisitor(*this);
+}
+
+void LoopInvariantHoister::VisitForStatement(ast::ForStatement& node) {
+    HoistIfInvariant(node, node.startOrList);
+    if (node.end) HoistIfInvariant(node, *node.end);
+    locals.emplace_back();
+    if (node.optVariableName) locals.back().insert(node.optVariableName.value()->identifier);
+    node.action->AcceptVisitor(*this);
+    locals.pop_back();
+}
+
+void LoopInvariantHoister::VisitLoopStatement(ast::LoopStatement& node) { node.body->AcceptVisitor(*this); }
+
+void LoopInvariantHoister::VisitExitStatement([[maybe_unused]] ast::ExitStatement& node) {}
+
+void LoopInvariantHoister::VisitAssignStatement(ast::AssignStatement& node) {
+    HoistIfInvariant(node, node.src);
+    for (auto& acc : node.dest->accessorChain) {
+        if (auto index = dynamic_cast<ast::IndexAccessor*>(acc.get()))
+            HoistIfInvariant(*index, index->expressionInBrackets);
+        else if (auto paren = dynamic_cast<ast::ParenMemberAccessor*>(acc.get()))
+            HoistIfInvariant(*paren, paren->expr);
+    }
+}
+
+void LoopInvariantHoister::VisitPrintStatement(ast::PrintStatement& node) {
+    for (auto& expr : node.expressions) HoistIfInvariant(node, expr);
+}
+
+void LoopInvariantHoister::VisitReturnStatement(ast::ReturnStatement& node) {
+    if (node.returnValue) HoistIfInvariant(node, *node.returnValue);
+}
+
+void LoopInvariantHoister::VisitExpressionStatement(ast::ExpressionStatement& node) {
+    HoistIfInvariant(node, node.expr);
+}
+
+DISALLOWED_VISIT(CommaExpressions)
+DISALLOWED_VISIT(CommaIdents)
+DISALLOWED_VISIT(IdentMemberAccessor)
+DISALLOWED_VISIT(IntLiteralMemberAccessor)
+DISALLOWED_VISIT(ParenMemberAccessor)
+DISALLOWED_VISIT(IndexAccessor)
+DISALLOWED_VISIT(Reference)
+DISALLOWED_VISIT(PrefixOperator)
+DISALLOWED_VISIT(TypecheckOperator)
+DISALLOWED_VISIT(Call)
+DISALLOWED_VISIT(AccessorOperator)
+DISALLOWED_VISIT(TupleLiteralElement)
+DISALLOWED_VISIT(ShortFuncBody)
+DISALLOWED_VISIT(LongFuncBody)
+
+void LoopInvariantHoister::VisitXorOperator(ast::XorOperator& node) { invariant = CheckOperands(node, node.operands); }
+
+void LoopInvariantHoister::VisitOrOperator(ast::OrOperator& node) { invariant = CheckOperands(node, node.operands); }
+
+void LoopInvariantHoister::VisitAndOperator(ast::AndOperator& node) { invariant = CheckOperands(node, node.operands); }
+
+void LoopInvariantHoister::VisitBinaryRelation(ast::BinaryRelation& node) {
+    invariant = CheckOperands(node, node.operands);
+}
+
+void LoopInvariantHoister::VisitSum(ast::Sum& node) { invariant = CheckOperands(node, node.terms); }
+
+void LoopInvariantHoister::VisitTerm(ast::Term& node) { invariant = CheckOperands(node, node.unaries); }
+
+// Prefix operators, type checks and accessors by name or number only depend on the operand; accessors with an
+// expression also depend on it, and calls are never invariant
+void LoopInvariantHoister::VisitUnary(ast::Unary& node) {
+    bool exprInvariant = Check(node.expr);
+    bool all = exprInvariant;
+    vector<ast::ParenMemberAccessor*> parens;
+    vector<ast::IndexAccessor*> indices;
+    for (auto& op : node.postfixOps) {
+        if (auto call = dynamic_cast<ast::Call*>(op.get())) {
+            for (auto& arg : call->args) HoistIfInvariant(*call, arg);
+            all = false;
+            continue;
+        }
+        auto accop = dynamic_cast<ast::AccessorOperator*>(op.get());
+        if (!accop) continue;
+        if (auto paren = dynamic_cast<ast::ParenMemberAccessor*>(accop->accessor.get())) {
+            if (Check(paren->expr))
+                parens.push_back(paren);
+            else
+                all = false;
+        } else if (auto index = dynamic_cast<ast::IndexAccessor*>(accop->accessor.get())) {
+            if (Check(index->expressionInBrackets))
+                indices.push_back(index);
+            else
+                all = false;
+        }
+    }
+    invariant = all;
+    if (all) return;
+    if (exprInvariant) Hoist(node, node.expr);
+    for (auto paren : parens) Hoist(*paren, paren->expr);
+    for (auto index : indices) Hoist(*index, index->expressionInBrackets);
+}
+
+void LoopInvariantHoister::VisitUnaryNot(ast::UnaryNot& node) { invariant = Check(node.nested); }
+
+void LoopInvariantHoister::VisitPrimaryIdent(ast::PrimaryIdent& node) {
+    invariant = IsInvariantVariable(node.name->identifier);
+}
+
+void LoopInvariantHoister::VisitParenthesesExpression(ast::ParenthesesExpression& node) {
+    invariant = Check(node.expr);
+}
+
+// Tuples and arrays are mutable, a new one is needed every time
+void LoopInvariantHoister::VisitTupleLiteral(ast::TupleLiteral& node) {
+    for (auto& elem : node.elements) HoistIfInvariant(*elem, elem->expression);
+    invariant = false;
+}
+
+void LoopInvariantHoister::VisitArrayLiteral(ast::ArrayLiteral& node) {
+    for (auto& item : node.items) HoistIfInvariant(node, item);
+    invariant = false;
+}
+
+void LoopInvariantHoister::VisitFuncLiteral([[maybe_unused]] ast::FuncLiteral& node) { invariant = false; }
+
+void LoopInvariantHoister::VisitTokenLiteral([[maybe_unused]] ast::TokenLiteral& node) { invariant = true; }
+
+void LoopInvariantHoister::VisitCustom(ast::ASTNode& node) {
+    if (auto precomp = dynamic_cast<ast::PrecomputedValue*>(&node)) {
+        invariant = !precomp->Value->TypeOfValue()->Mutable();
+        return;
+    }
+    if (auto inner = dynamic_cast<ast::HoistedValue*>(&node)) {
+        invariant = Check(inner->Expr);
+        return;
+    }
+    // the body of a closure runs when it is called, not where it is defined
+    invariant = false;
+}
+
+}  // namespace semantic
+}  // namespace dinterp
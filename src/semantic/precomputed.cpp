@@ -15,5 +15,15 @@ ClosureDefinition::ClosureDefinition(const locators::SpanLocator& pos, const std
     : Expression(pos), Type(type), Definition(definition), Params(params), CapturedExternals(capturedExternals) {}
 void ClosureDefinition::AcceptVisitor(IASTVisitor& vis) { vis.VisitCustom(*this); }
 
+HoistedValue::HoistedValue(const locators::SpanLocator& pos, const std::string& name,
+                           const std::shared_ptr<Expression>& expr)
+    : Expression(pos), Name(name), Expr(expr) {}
+void HoistedValue::AcceptVisitor(IASTVisitor& vis) { vis.VisitCustom(*this); }
+
+InlinedCall::InlinedCall(const locators::SpanLocator& pos, const std::shared_ptr<ClosureDefinition>& callee,
+                         const std::vector<std::shared_ptr<Expression>>& args)
+    : Expression(pos), Callee(callee), Args(args) {}
+void InlinedCall::AcceptVisitor(IASTVisitor& vis) { vis.VisitCustom(*this); }
+
 }  // namespace ast
 }  // namespace dinterp
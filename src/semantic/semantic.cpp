@@ -1,12 +1,17 @@
 #include "dinterp/semantic.h"
 
+#include <memory>
+
 #include "dinterp/runtime/types.h"
+#include "dinterp/semantic/closureChecks.h"
 #include "dinterp/semantic/statementChecker.h"
 #include "dinterp/semantic/valueTimeline.h"
 using namespace std;
 
-bool dinterp::semantic::Analyze(complog::ICompilationLog& log, const shared_ptr<ast::Body>& program) {
+bool dinterp::semantic::Analyze(complog::ICompilationLog& log, const shared_ptr<ast::Body>& program,
+                                ICallEvaluator* evaluator, size_t threads) {
     ValueTimeline tl;
+    tl.EvaluateCallsWith(evaluator);
     tl.StartScope();
     {
         auto zeroLoc = locators::SpanLocator(program->pos.File(), 0, 0);
@@ -14,6 +19,11 @@ bool dinterp::semantic::Analyze(complog::ICompilationLog& log, const shared_ptr<
         tl.AssignType("input", make_shared<runtime::FuncType>(false, 0, make_shared<runtime::StringType>()), zeroLoc);
         tl.LookupVariable("input");
     }
+    unique_ptr<ClosureCheckPool> ahead;
+    if (threads > 1) {
+        ahead = make_unique<ClosureCheckPool>(*program, tl, threads);
+        tl.CheckClosuresAheadWith(ahead.get());
+    }
     StatementChecker chk(log, tl, false, false);
     program->AcceptVisitor(chk);
 
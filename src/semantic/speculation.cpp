@@ -0,0 +1,39 @@
+#include "dinterp/semantic/speculation.h"
+
+#include <iterator>
+#include <ranges>
+
+namespace dinterp {
+namespace semantic {
+
+Speculation::Speculation(Speculation* outer)
+    : outer(outer),
+      closures(outer ? outer->closures
+                     : std::make_shared<std::unordered_map<const ast::FuncLiteral*, KeptClosure>>()) {}
+
+Speculation* Speculation::Outer() const { return outer; }
+
+void Speculation::Undo() {
+    for (auto& edit : std::views::reverse(saved)) edit.restore(*edit.node, *edit.copy);
+    saved.clear();
+}
+
+void Speculation::Keep() {
+    if (outer)
+        outer->saved.insert(outer->saved.end(), std::make_move_iterator(saved.begin()),
+                            std::make_move_iterator(saved.end()));
+    saved.clear();
+}
+
+const KeptClosure* Speculation::CheckedClosure(const ast::FuncLiteral& literal) const {
+    auto iter = closures->find(&literal);
+    return iter == closures->end() ? nullptr : &iter->second;
+}
+
+void Speculation::KeepClosure(KeptClosure closure) {
+    auto key = closure.literal.get();
+    (*closures)[key] = std::move(closure);
+}
+
+}  // namespace semantic
+}  // namespace dinterp
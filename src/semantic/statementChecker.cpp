@@ -1,12 +1,20 @@
 #include "dinterp/semantic/statementChecker.h"
 
+#include <algorithm>
+#include <optional>
+#include <set>
 #include <stdexcept>
+#include <string>
 
 #include "dinterp/locators/CodeFile.h"
 #include "dinterp/locators/locator.h"
 #include "dinterp/runtime/types.h"
+#include "dinterp/semantic/commonSubexpressions.h"
+#include "dinterp/semantic/deadStores.h"
 #include "dinterp/semantic/diagnostics.h"
 #include "dinterp/semantic/expressionChecker.h"
+#include "dinterp/semantic/loopInvariants.h"
+#include "dinterp/semantic/speculation.h"
 #include "dinterp/semantic/unaryOpsChecker.h"
 #include "dinterp/semantic/valueTimeline.h"
 #include "dinterp/syntax.h"
@@ -16,7 +24,7 @@ using namespace std;
 namespace dinterp {
 namespace semantic {
 
-static locators::SpanLocator LocatorFromToken(const Token& tk, const shared_ptr<const locators::CodeFile>& file) {
+static locators::SpanLocator LocatorFromToken(const Token& tk, locators::FileId file) {
     return locators::SpanLocator(file, tk.span.position, tk.span.length);
 }
 
@@ -54,14 +62,29 @@ static void ReportVariableProblems(complog::ICompilationLog& log, const ScopeSta
     for (auto& var : stats.variablesNeverUsed) log.Log(make_shared<errors::VariableNeverUsed>(var.second, var.first));
 }
 
+// The synthetic variables are never seen by the checker, they start as `none` at runtime
+static shared_ptr<ast::VarStatement> DeclareSynthetic(const locators::SpanLocator& pos, const vector<string>& names) {
+    auto declaration = make_shared<ast::VarStatement>(pos);
+    for (auto& name : names) {
+        auto token = make_shared<IdentifierToken>();
+        token->identifier = name;
+        token->span = {pos.Start().Position(), 0};
+        declaration->definitions.emplace_back(token, nullopt);
+    }
+    return declaration;
+}
+
 void StatementChecker::VisitBody(ast::Body& node) {
+    values.WillChange(node);
     values.StartScope();
+    CommonSubexpressionEliminator cse(values, "(body at " + node.pos.Start().Pretty() + ") #");
     size_t n = node.statements.size();
     for (size_t i = 0; i < n; i++) {
         auto stmt = node.statements[i];
         StatementChecker rec(log, values, inFunction, inCycle);
         stmt->AcceptVisitor(rec);
         pure = pure && rec.Pure();
+        size_t first = i;
         if (rec.Replacement()) {
             auto& repl = *rec.Replacement();
             if (repl.empty()) {
@@ -75,6 +98,8 @@ void StatementChecker::VisitBody(ast::Body& node) {
                 n += repl.size() - 1;
             }
         }
+        if (!rec.Replacement() || !rec.Replacement()->empty())
+            for (size_t j = first; j <= i; j++) cse.AddStatement(node.statements[j]);
         AddReturnType(rec.Returned());
         switch (rec.Terminated()) {
             case TerminationKind::ReachedEnd:
@@ -96,16 +121,40 @@ void StatementChecker::VisitBody(ast::Body& node) {
         }
     }
     if (terminationKind == TerminationKind::Errored) terminationKind = TerminationKind::ReachedEnd;
-    ReportVariableProblems(log, values.EndScope());
+    if (auto user = cse.Eliminate())
+        node.statements.insert(ranges::find(node.statements, user), DeclareSynthetic(user->pos, cse.Shared()));
+    auto stats = values.EndScope();
+    ReportVariableProblems(log, stats);
+    DeadStoreEliminator(values, stats).Eliminate(node);
+}
+
+// Whether the checked expression evaluates without an error at runtime. A pure expression may still fail, like an index
+// out of bounds or a division by zero, and then only such a value is a store that the dead store elimination may drop
+static bool CannotFail(const ast::Expression& expr) {
+    if (auto unary = dynamic_cast<const ast::Unary*>(&expr))
+        return unary->prefixOps.empty() && unary->postfixOps.empty() && CannotFail(*unary->expr);
+    if (auto parens = dynamic_cast<const ast::ParenthesesExpression*>(&expr)) return CannotFail(*parens->expr);
+    if (auto tuple = dynamic_cast<const ast::TupleLiteral*>(&expr))
+        return ranges::all_of(tuple->elements, [](auto& element) { return CannotFail(*element->expression); });
+    if (auto array = dynamic_cast<const ast::ArrayLiteral*>(&expr))
+        return ranges::all_of(array->items, [](auto& item) { return CannotFail(*item); });
+    return dynamic_cast<const ast::PrecomputedValue*>(&expr) || dynamic_cast<const ast::TokenLiteral*>(&expr) ||
+           dynamic_cast<const ast::PrimaryIdent*>(&expr) || dynamic_cast<const ast::ClosureDefinition*>(&expr);
 }
 
 void StatementChecker::VisitVarStatement(ast::VarStatement& node) {
+    values.WillChange(node);
     bool errored = false;
     for (auto& kv : node.definitions) {
         const string& name = kv.first->identifier;
         locators::SpanLocator declarationspan = LocatorFromToken(*kv.first, node.pos.File());
         if (kv.second) {
             auto& expr = *kv.second;
+            // a closure bound to a variable may be checked again where the types of its arguments are known
+            shared_ptr<ast::FuncLiteral> source;
+            auto literal = dynamic_pointer_cast<ast::FuncLiteral>(expr);
+            if (literal && !values.CheckedClosure(*literal))
+                source = dynamic_pointer_cast<ast::FuncLiteral>(ast::AstDeepCopier::Clone(*literal));
             ExpressionChecker chk(log, values);
             expr->AcceptVisitor(chk);
             if (!chk.HasResult()) {
@@ -119,7 +168,12 @@ void StatementChecker::VisitVarStatement(ast::VarStatement& node) {
                 errored = true;
                 continue;
             }
-            values.Assign(name, chk.Result(), kv.second.value()->pos);
+            values.Assign(name, chk.Result(), kv.second.value()->pos,
+                          chk.Pure() && CannotFail(*expr) ? &node : nullptr);
+            if (auto closure = dynamic_pointer_cast<ast::ClosureDefinition>(expr)) {
+                if (source) closure->Source = source;
+                values.BindClosure(name, closure);
+            }
         } else {
             if (!values.Declare(name, declarationspan)) {
                 log.Log(make_shared<errors::VariableRedefined>(declarationspan, name));
@@ -132,6 +186,7 @@ void StatementChecker::VisitVarStatement(ast::VarStatement& node) {
 }
 
 void StatementChecker::VisitIfStatement(ast::IfStatement& node) {
+    values.WillChange(node);
     auto& cond = node.condition;
     ExpressionChecker condchk(log, values);
     cond->AcceptVisitor(condchk);
@@ -233,23 +288,38 @@ void StatementChecker::VisitShortIfStatement(ast::ShortIfStatement& node) {
 }
 
 void StatementChecker::VisitWhileStatement(ast::WhileStatement& node) {
-    // first evaluation:
+    values.WillChange(node);
+    // first evaluation: the condition is checked in place with the values from before the loop, and the changes this
+    // makes to it are undone unless the loop turns out to be dead. So are its messages, since the loop checks the
+    // condition again
     pure = false;
+    Speculation speculation(values.CurrentSpeculation());
     {
-        auto cond = dynamic_pointer_cast<ast::Expression>(ast::AstDeepCopier::Clone(*node.condition));
         auto temptl = values;
-        ExpressionChecker chk(log, temptl);
-        cond->AcceptVisitor(chk);
-        if (!chk.HasResult()) return;
-        auto firstCond = chk.Replacement() ? chk.AssertReplacementAsExpression() : cond;
+        temptl.Speculate(&speculation);
+        complog::AccumulatedCompilationLog firstLog;
+        ExpressionChecker chk(firstLog, temptl);
+        node.condition->AcceptVisitor(chk);
+        auto keepMessages = [this, &firstLog] {
+            for (auto& message : firstLog.Messages()) log.Log(message);
+        };
+        if (!chk.HasResult()) {
+            keepMessages();
+            speculation.Undo();
+            return;
+        }
+        auto firstCond = chk.Replacement() ? chk.AssertReplacementAsExpression() : node.condition;
         auto firsteval = chk.Result();
         auto type = firsteval.index() ? get<1>(firsteval)->TypeOfValue() : get<0>(firsteval);
         if (!type->TypeEq(runtime::UnknownType()) && !type->TypeEq(runtime::BoolType())) {
+            keepMessages();
             log.Log(make_shared<errors::WhileConditionNotBoolAtStart>(firstCond->pos, type));
+            speculation.Undo();
             return;
         }
         if (firsteval.index()) {
             if (!dynamic_cast<const runtime::BoolValue&>(*get<1>(firsteval)).Value()) {
+                keepMessages();
                 log.Log(make_shared<errors::WhileConditionFalseAtStart>(firstCond->pos));
                 replacement.emplace();
                 if (!chk.Pure())
@@ -257,27 +327,129 @@ void StatementChecker::VisitWhileStatement(ast::WhileStatement& node) {
                 StatementChecker schk(log, temptl, inFunction, true);
                 temptl.StartBlindScope();
                 node.action->AcceptVisitor(schk);
+                speculation.Keep();
                 if (schk.Terminated() == TerminationKind::Errored) return;
                 terminationKind = TerminationKind::ReachedEnd;
                 return;
             }
         }
     }
-    values.StartBlindScope();
-    ExpressionChecker chk(log, values);
-    node.condition->AcceptVisitor(chk);
-    if (!chk.HasResult()) return;
-    if (chk.Replacement()) node.condition = chk.AssertReplacementAsExpression();
-    VisitLoopBodyAndEndScope(node.action);
+    speculation.Undo();
+    // the tries of the loop are nested in the speculation, so they find the closures of the condition checked above
+    values.Speculate(&speculation);
+    CheckLoop(node, &node.condition, node.action, nullptr, nullptr);
+    speculation.Keep();
+    values.Speculate(speculation.Outer());
+}
+
+// The variables that a loop body may assign to by name. Calls, which may assign to any variable, are handled by the
+// checker as they come
+static void CollectAssignedVariables(const ast::Statement& stmt, set<string>& names) {
+    if (auto body = dynamic_cast<const ast::Body*>(&stmt)) {
+        for (auto& child : body->statements) CollectAssignedVariables(*child, names);
+    } else if (auto asg = dynamic_cast<const ast::AssignStatement*>(&stmt)) {
+        if (asg->dest->accessorChain.empty()) names.insert(asg->dest->baseIdent->identifier);
+    } else if (auto ifstmt = dynamic_cast<const ast::IfStatement*>(&stmt)) {
+        CollectAssignedVariables(*ifstmt->doIfTrue, names);
+        if (ifstmt->doIfFalse) CollectAssignedVariables(**ifstmt->doIfFalse, names);
+    } else if (auto shortif = dynamic_cast<const ast::ShortIfStatement*>(&stmt)) {
+        CollectAssignedVariables(*shortif->doIfTrue, names);
+    } else if (auto whilestmt = dynamic_cast<const ast::WhileStatement*>(&stmt)) {
+        CollectAssignedVariables(*whilestmt->action, names);
+    } else if (auto forstmt = dynamic_cast<const ast::ForStatement*>(&stmt)) {
+        CollectAssignedVariables(*forstmt->action, names);
+    } else if (auto loopstmt = dynamic_cast<const ast::LoopStatement*>(&stmt)) {
+        CollectAssignedVariables(*loopstmt->body, names);
+    }
+}
+
+// The body is checked from the state at the head of the loop: the state before the loop, generalized with the state
+// at the end of the body until it stops changing. The variables the body assigns to start with only their types known,
+// so that is usually the case after the first try; a try that changes the state at the head is undone. The state at
+// the head only becomes more general, and after the second try a variable that changes becomes unknown. The expressions
+// of the kept try that cannot change while the loop runs are then hoisted out of it (see LoopInvariantHoister).
+void StatementChecker::CheckLoop(ast::Statement& loop, shared_ptr<ast::Expression>* condition,
+                                 shared_ptr<ast::Body>& body, const IdentifierToken* variable,
+                                 const shared_ptr<runtime::Type>& variableType) {
+    auto outer = values.CurrentSpeculation();
+    // the tries share the closures checked during any of them: outside of a speculation, for as long as the loop is
+    // checked
+    optional<Speculation> region;
+    auto around = outer ? outer : &region.emplace(nullptr);
+    // the loop statement itself is not part of the tries
+    auto originalCondition = condition ? *condition : nullptr;
+    auto originalBody = body;
+    ValueTimeline head = values;
+    set<string> assigned;
+    CollectAssignedVariables(*body, assigned);
+    for (auto& name : assigned) head.ForgetValue(name);
+    for (bool widen = false;; widen = true) {
+        Speculation speculation(around);
+        complog::AccumulatedCompilationLog iterationLog;
+        ValueTimeline tl = head;
+        tl.Speculate(&speculation);
+        StatementChecker iteration(iterationLog, tl, inFunction, inCycle);
+        auto backEdge = iteration.CheckLoopIteration(condition, body, variable, variableType);
+        if (backEdge) {
+            ValueTimeline next = head;
+            if (next.GeneralizeValues(*backEdge, widen)) {
+                speculation.Undo();
+                if (condition) *condition = originalCondition;
+                body = originalBody;
+                head = std::move(next);
+                continue;
+            }
+        }
+        speculation.Keep();
+        for (auto& message : iterationLog.Messages()) log.Log(message);
+        tl.Speculate(outer);
+        values = std::move(tl);
+        terminationKind = iteration.terminationKind;
+        AddReturnType(iteration.returned);
+        if (terminationKind != TerminationKind::Errored) HoistLoopInvariants(loop, head, assigned);
+        return;
+    }
+}
+
+void StatementChecker::HoistLoopInvariants(ast::Statement& loop, ValueTimeline& head, const set<string>& assigned) {
+    LoopInvariantHoister hoister(head, assigned, "(loop at " + loop.pos.Start().Pretty() + ") #");
+    hoister.HoistFromLoop(loop);
+    if (hoister.Hoisted().empty()) return;
+    replacement = {DeclareSynthetic(loop.pos, hoister.Hoisted()),
+                   dynamic_pointer_cast<ast::Statement>(loop.shared_from_this())};
 }
 
-void StatementChecker::VisitLoopBodyAndEndScope(shared_ptr<ast::Body>& body) {
+optional<ValueTimeline> StatementChecker::CheckLoopIteration(shared_ptr<ast::Expression>* condition,
+                                                             shared_ptr<ast::Body>& body,
+                                                             const IdentifierToken* variable,
+                                                             const shared_ptr<runtime::Type>& variableType) {
+    values.StartLoopScope();
+    if (variable) {
+        auto span = LocatorFromToken(*variable, body->pos.File());
+        values.Declare(variable->identifier, span);
+        values.AssignType(variable->identifier, variableType, span);
+    }
+    if (condition) {
+        ExpressionChecker chk(log, values);
+        (*condition)->AcceptVisitor(chk);
+        if (!chk.HasResult()) return {};
+        if (chk.Replacement()) *condition = chk.AssertReplacementAsExpression();
+    }
+    return VisitLoopBodyAndEndScope(body);
+}
+
+optional<ValueTimeline> StatementChecker::VisitLoopBodyAndEndScope(shared_ptr<ast::Body>& body) {
     StatementChecker rec(log, values, inFunction, true);
     body->AcceptVisitor(rec);
     auto term = rec.Terminated();
     if (term == TerminationKind::Errored) {
         values.EndScope();
-        return;
+        return {};
+    }
+    optional<ValueTimeline> backEdge;
+    if (term == TerminationKind::ReachedEnd) {
+        backEdge = values;
+        backEdge->EndScope();
     }
     auto stats = values.EndScope();
     ReportVariableProblems(log, stats);
@@ -293,12 +465,14 @@ void StatementChecker::VisitLoopBodyAndEndScope(shared_ptr<ast::Body>& body) {
     AddReturnType(rec.Returned());
     if (term == TerminationKind::Returned) {
         terminationKind = TerminationKind::Returned;
-        return;
+        return backEdge;
     }
     terminationKind = TerminationKind::ReachedEnd;
+    return backEdge;
 }
 
 void StatementChecker::VisitForStatement(ast::ForStatement& node) {
+    values.WillChange(node);
     pure = false;
     ExpressionChecker chkStart(log, values);
     node.startOrList->AcceptVisitor(chkStart);
@@ -334,19 +508,12 @@ void StatementChecker::VisitForStatement(ast::ForStatement& node) {
         }
         variabletype = make_shared<runtime::UnknownType>();
     }
-    values.StartBlindScope();
-    if (node.optVariableName) {
-        string name = node.optVariableName.value()->identifier;
-        auto span = LocatorFromToken(**node.optVariableName, node.pos.File());
-        values.Declare(name, span);
-        values.AssignType(name, variabletype, span);
-    }
-    VisitLoopBodyAndEndScope(node.action);
+    CheckLoop(node, nullptr, node.action, node.optVariableName ? node.optVariableName->get() : nullptr, variabletype);
 }
 
 void StatementChecker::VisitLoopStatement(ast::LoopStatement& node) {
-    values.StartBlindScope();
-    VisitLoopBodyAndEndScope(node.body);
+    values.WillChange(node);
+    CheckLoop(node, nullptr, node.body, nullptr, nullptr);
 }
 
 void StatementChecker::VisitExitStatement(ast::ExitStatement& node) {
@@ -359,6 +526,7 @@ void StatementChecker::VisitExitStatement(ast::ExitStatement& node) {
 }
 
 void StatementChecker::VisitAssignStatement(ast::AssignStatement& node) {
+    values.WillChange(node);
     pure = false;
     ExpressionChecker valuechk(log, values);
     node.src->AcceptVisitor(valuechk);
@@ -368,7 +536,8 @@ void StatementChecker::VisitAssignStatement(ast::AssignStatement& node) {
     auto& ref = node.dest;
     size_t n = ref->accessorChain.size();
     if (!n) {
-        if (!values.Assign(ref->baseIdent->identifier, srcval, node.pos)) {
+        bool removable = valuechk.Pure() && CannotFail(*node.src);
+        if (!values.Assign(ref->baseIdent->identifier, srcval, node.pos, removable ? &node : nullptr)) {
             auto span = ref->baseIdent->span;
             log.Log(make_shared<errors::VariableNotDefined>(
                 locators::SpanLocator(node.pos.File(), span.position, span.length), ref->baseIdent->identifier));
@@ -407,6 +576,7 @@ void StatementChecker::VisitAssignStatement(ast::AssignStatement& node) {
                 log.Log(make_shared<errors::SubscriptAssignmentOnlyInArrays>(lastloc, type));
                 return;
             }
+            values.WillChange(*index);
             ExpressionChecker chk(log, values);
             index->expressionInBrackets->AcceptVisitor(chk);
             if (!chk.HasResult()) return;
@@ -451,10 +621,7 @@ void StatementChecker::VisitAssignStatement(ast::AssignStatement& node) {
         optional<BigInt> indexvalue;
         auto exprIndex = dynamic_cast<ast::ParenMemberAccessor*>(acc.get());
         if (exprIndex) {
-            if (!type->TypeEq(runtime::UnknownType()) && !type->TypeEq(runtime::ArrayType())) {
-                log.Log(make_shared<errors::SubscriptAssignmentOnlyInArrays>(lastloc, type));
-                return;
-            }
+            values.WillChange(*exprIndex);
             ExpressionChecker chk(log, values);
             exprIndex->expr->AcceptVisitor(chk);
             if (!chk.HasResult()) return;
@@ -484,6 +651,7 @@ void StatementChecker::VisitAssignStatement(ast::AssignStatement& node) {
 }
 
 void StatementChecker::VisitPrintStatement(ast::PrintStatement& node) {
+    values.WillChange(node);
     pure = false;
     for (auto& expr : node.expressions) {
         ExpressionChecker chk(log, values);
@@ -495,6 +663,7 @@ void StatementChecker::VisitPrintStatement(ast::PrintStatement& node) {
 }
 
 void StatementChecker::VisitReturnStatement(ast::ReturnStatement& node) {
+    values.WillChange(node);
     if (!inFunction) {
         log.Log(make_shared<errors::ReturnOutsideOfFunction>(node.pos));
         return;
@@ -523,6 +692,7 @@ void StatementChecker::VisitReturnStatement(ast::ReturnStatement& node) {
 }
 
 void StatementChecker::VisitExpressionStatement(ast::ExpressionStatement& node) {
+    values.WillChange(node);
     ExpressionChecker chk(log, values);
     node.expr->AcceptVisitor(chk);
     if (!chk.HasResult()) return;
@@ -5,6 +5,7 @@
 
 #include "dinterp/complog/CompilationLog.h"
 #include "dinterp/complog/CompilationMessage.h"
+#include "dinterp/interp/evaluator.h"
 #include "dinterp/lexer.h"
 #include "dinterp/semantic.h"
 #include "dinterp/syntax.h"
@@ -12,7 +13,7 @@
 using namespace std;
 using namespace dinterp;
 
-void FileSample::ReadFile(std::string name, bool expectSuccess) {
+void FileSample::ReadFile(std::string name, bool expectSuccess, size_t threads) {
     ifstream fs(name);
     ASSERT_TRUE(fs);
     stringstream text;
@@ -33,7 +34,9 @@ void FileSample::ReadFile(std::string name, bool expectSuccess) {
     log.reset();
 
     log = make_unique<complog::AccumulatedCompilationLog>();
-    bool ok_semantic = semantic::Analyze(*log, program);
+    // the pure calls are evaluated as they are when the program is run
+    interp::BoundedEvaluator evaluator;
+    bool ok_semantic = semantic::Analyze(*log, program, &evaluator, threads);
     if (expectSuccess) {
         log->WriteToStream(cout, complog::Severity::Error(), complog::CompilationMessage::FormatOptions::All(80));
         ASSERT_TRUE(ok_semantic);
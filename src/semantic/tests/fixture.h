@@ -15,7 +15,8 @@ public:
     std::vector<std::shared_ptr<dinterp::Token>> tokens;
     std::unique_ptr<dinterp::complog::AccumulatedCompilationLog> log;
     std::shared_ptr<dinterp::ast::Body> program;
-    void ReadFile(std::string name, bool expectSuccess);
+    // With more than one thread, closures are checked ahead (see `semantic::Analyze`)
+    void ReadFile(std::string name, bool expectSuccess, size_t threads = 1);
     void ExpectFailure(size_t line, size_t col);
     void ExpectFailure(size_t line, size_t col, std::string messageIncludes);
 };
@@ -23,6 +23,8 @@ UnaryOpChecker::UnaryOpChecker(complog::ICompilationLog& log, ValueTimeline& val
     : log(log), values(values), curvalue(curvalue), pos(pos), pure(!isUnknown(curvalue)) {}
 bool UnaryOpChecker::HasResult() const { return static_cast<bool>(res); }
 bool UnaryOpChecker::Pure() const { return pure; }
+void UnaryOpChecker::CallsClosure(const shared_ptr<ast::ClosureDefinition>& closure) { callee = closure; }
+shared_ptr<ast::ClosureDefinition> UnaryOpChecker::Callee() const { return callee; }
 variant<shared_ptr<runtime::Type>, shared_ptr<runtime::RuntimeValue>> UnaryOpChecker::Result() const { return *res; }
 
 #define DISALLOWED_VISIT(name)                                           \
@@ -116,6 +118,7 @@ void UnaryOpChecker::VisitIntLiteralMemberAccessor(ast::IntLiteralMemberAccessor
 }
 
 void UnaryOpChecker::VisitParenMemberAccessor(ast::ParenMemberAccessor& node) {
+    values.WillChange(node);
     ExpressionChecker nested(log, values);
     node.expr->AcceptVisitor(nested);
     if (!nested.HasResult()) return;
@@ -159,6 +162,7 @@ void UnaryOpChecker::VisitParenMemberAccessor(ast::ParenMemberAccessor& node) {
 }
 
 void UnaryOpChecker::VisitIndexAccessor(ast::IndexAccessor& node) {
+    values.WillChange(node);
     ExpressionChecker nested(log, values);
     node.expressionInBrackets->AcceptVisitor(nested);
     if (!nested.HasResult()) return;
@@ -196,8 +200,33 @@ void UnaryOpChecker::VisitIndexAccessor(ast::IndexAccessor& node) {
     res = *optmember;
 }
 
+// The value that the call of the known closure returns for constant arguments, found by running it; nullptr if it
+// cannot be evaluated. What the closure captures must be known at the call site, and neither it nor the arguments nor
+// the result may be mutable. `FuncType::Pure` does not allow loops or assignments, so instead the evaluator refuses the
+// calls that turn out to have effects
+static shared_ptr<runtime::RuntimeValue> EvaluateCall(const ValueTimeline& values, const ast::ClosureDefinition& callee,
+                                                      const vector<optional<shared_ptr<runtime::RuntimeValue>>>& args) {
+    auto evaluator = values.CallEvaluator();
+    if (!evaluator || callee.Params.size() != args.size()) return nullptr;
+    vector<pair<string, shared_ptr<runtime::RuntimeValue>>> captured;
+    for (auto& name : callee.CapturedExternals) {
+        auto val = values.PeekVariable(name);
+        if (!val || !val->index() || get<1>(*val)->TypeOfValue()->Mutable()) return nullptr;
+        captured.emplace_back(name, get<1>(*val));
+    }
+    vector<shared_ptr<runtime::RuntimeValue>> argvalues;
+    for (auto& arg : args) {
+        if (!arg || arg.value()->TypeOfValue()->Mutable()) return nullptr;
+        argvalues.push_back(*arg);
+    }
+    auto res = evaluator->Evaluate(callee, captured, argvalues);
+    if (!res || res->TypeOfValue()->Mutable()) return nullptr;
+    return res;
+}
+
 // A call makes every variable 'unknown'
 void UnaryOpChecker::VisitCall(ast::Call& node) {
+    values.WillChange(node);
     size_t n = node.args.size();
     vector<optional<shared_ptr<runtime::RuntimeValue>>> optValues;
     optValues.reserve(n);
@@ -227,6 +256,17 @@ void UnaryOpChecker::VisitCall(ast::Call& node) {
         }
     }
     if (errored) return;
+    // what the copy is known to do with arguments of these types, the closure does as well
+    if (callee)
+        if (auto specialized = ExpressionChecker::Specialize(values, *callee, types)) {
+            callee = specialized;
+            curvalue = specialized->Type;
+        }
+    if (callee && allknown && pure)
+        if (auto value = EvaluateCall(values, *callee, optValues)) {
+            this->res = value;
+            return;
+        }
     if (curvalue.index() && allknown && pure) {
         auto& rval = *get<1>(curvalue);
         auto curtype = rval.TypeOfValue();
@@ -237,10 +277,12 @@ void UnaryOpChecker::VisitCall(ast::Call& node) {
         auto& funcvalue = dynamic_cast<runtime::FuncValue&>(rval);
         auto& functype = dynamic_cast<runtime::FuncType&>(*curtype);
         pure = pure && functype.Pure();
+        vector<shared_ptr<runtime::RuntimeValue>> args(n);
+        std::ranges::transform(optValues, args.begin(),
+                               [](const optional<shared_ptr<runtime::RuntimeValue>> a) { return *a; });
+        // a call too large to run here is left to the runtime, and since it may fail there, it must not be removed
+        if (pure && !funcvalue.CanPrecompute(args)) pure = false;
         if (pure) {
-            vector<shared_ptr<runtime::RuntimeValue>> args(n);
-            std::ranges::transform(optValues, args.begin(),
-                                   [](const optional<shared_ptr<runtime::RuntimeValue>> a) { return *a; });
             auto res = funcvalue.Call(args);
             if (!res) {
                 errors::VectorOfSpanTypes bad{{pos, curtype}};
@@ -13,47 +13,69 @@ ValueTimeline::Var::Var(const locators::SpanLocator& declloc)
     : val(make_shared<runtime::NoneValue>()), declaration(declloc) {}
 
 optional<pair<size_t, const ValueTimeline::Var*>> ValueTimeline::Lookup(const std::string& name) const {
-    for (long i = static_cast<long>(stack.size()) - 1; i >= 0l; --i) {
-        auto& scope = stack[i];
-        auto iter = scope.vars.find(name);
-        if (iter == scope.vars.end()) continue;
-        return make_pair(i, &iter->second);
-    }
+    for (long i = static_cast<long>(stack.size()) - 1; i >= 0l; --i)
+        if (auto var = stack[i].vars.Find(name)) return make_pair(i, var);
     return {};
 }
 
-optional<pair<size_t, ValueTimeline::Var*>> ValueTimeline::Lookup(const std::string& name) {
-    for (long i = static_cast<long>(stack.size()) - 1; i >= 0l; --i) {
-        auto& scope = stack[i];
-        auto iter = scope.vars.find(name);
-        if (iter == scope.vars.end()) continue;
-        return make_pair(i, &iter->second);
-    }
-    return {};
+template <typename F>
+bool ValueTimeline::AssignWith(const string& name, F change) {
+    auto search = Lookup(name);
+    if (!search) return false;
+    size_t scopeindex = search->first;
+    auto& topscope = stack.back();
+    if (scopeindex != stack.size() - 1) topscope.externalReferences.Upsert(name, [](bool& asg) { asg = true; });
+    stack[scopeindex].vars.Update(name, [&change](Var& var) {
+        var.closure = nullptr;
+        change(var);
+    });
+    return true;
 }
 
 optional<runtime::TypeOrValue> ValueTimeline::LookupVariable(const string& name) {
     auto v = Lookup(name);
     if (!v) return {};
-    auto& p = *v;
-    p.second->used = true;
-    p.second->lastUnusedAssignments.clear();
-    if (p.first + 1 < stack.size()) stack.back().externalReferences[name] = false;
-    if (blindScopeIndices.size() && p.first < blindScopeIndices.back()) {
+    auto [scopeindex, var] = *v;
+    runtime::TypeOrValue val = var->val;
+    // reading a variable is much more common than changing it, and most reads change nothing
+    if (!var->read || !var->lastUnusedAssignments.empty())
+        stack[scopeindex].vars.Update(name, [](Var& read) {
+            read.used = true;
+            read.read = true;
+            read.lastUnusedAssignments.clear();
+        });
+    if (scopeindex + 1 < stack.size()) {
+        auto& refs = stack.back().externalReferences;
+        if (auto asg = refs.Find(name); !asg || *asg) refs.Upsert(name, [](bool& assigned) { assigned = false; });
+    }
+    return Visible(scopeindex, val);
+}
+
+optional<runtime::TypeOrValue> ValueTimeline::PeekVariable(const string& name) const {
+    auto v = Lookup(name);
+    if (!v) return {};
+    return Visible(v->first, v->second->val);
+}
+
+runtime::TypeOrValue ValueTimeline::Visible(size_t scopeindex, const runtime::TypeOrValue& val) const {
+    if (blindScopeIndices.size() && scopeindex < blindScopeIndices.back()) {
         return make_shared<runtime::UnknownType>();
     }
-    return p.second->val;
+    if (loopScopeIndices.size() && scopeindex < loopScopeIndices.back() && val.index()) {
+        auto type = get<1>(val)->TypeOfValue();
+        if (type->Mutable()) return type;
+    }
+    return val;
 }
 
+// A call only reads the variables that a closure captured, and these have no useless assignments (see Capture)
 void ValueTimeline::MakeAllUnknown() {
     auto unk = make_shared<runtime::UnknownType>();
     for (auto& scope : stack)
-        for (auto& kv : scope.vars) {
-            auto& var = kv.second;
+        scope.vars.ChangeEach([&unk](const string&, Var& var) {
             var.val = unk;
-            var.used = true;
-            var.lastUnusedAssignments.clear();
-        }
+            var.closure = nullptr;
+        });
 }
 
 void ValueTimeline::StartScope() { stack.emplace_back(); }
@@ -63,79 +85,108 @@ void ValueTimeline::StartBlindScope() {
     StartScope();
 }
 
+void ValueTimeline::StartLoopScope() {
+    loopScopeIndices.push_back(stack.size());
+    StartScope();
+}
+
 ScopeStats ValueTimeline::EndScope() {
     ScopeStats res;
     auto top = std::move(stack.back());
     stack.pop_back();
 
-    res.referencedExternals = top.externalReferences;
-    for (auto& kv : top.vars) {
-        auto& var = kv.second;
+    top.externalReferences.ForEach([&res](const string& name, bool assigned) {
+        res.referencedExternals.emplace_hint(res.referencedExternals.end(), name, assigned);
+    });
+    top.vars.ForEach([&res](const string& name, const Var& var) {
         if (!var.used)
-            res.variablesNeverUsed.emplace_back(kv.first, var.declaration);
+            res.variablesNeverUsed.emplace_back(name, var.declaration);
         else
             for (auto& asg : var.lastUnusedAssignments) {
-                res.uselessAssignments.emplace_back(kv.first, *asg);
+                res.uselessAssignments.emplace_back(name, asg->pos);
+                if (asg->removable) res.removableAssignments.emplace_back(name, asg->removable);
             }
-    }
+        if (!var.read && !var.impureStores) res.variablesOnlyStored.push_back(name);
+    });
     if (stack.size()) {
         auto& newtop = stack.back();
-        for (const auto& kv : top.externalReferences)
-            if (!newtop.vars.contains(kv.first)) {
-                bool& wasAssigned = newtop.externalReferences[kv.first];
-                wasAssigned = wasAssigned || kv.second;
-            }
+        top.externalReferences.ForEach([&newtop](const string& name, bool assigned) {
+            if (!newtop.vars.Contains(name))
+                newtop.externalReferences.Upsert(name, [assigned](bool& wasAssigned) {
+                    wasAssigned = wasAssigned || assigned;
+                });
+        });
     }
     if (blindScopeIndices.size() && blindScopeIndices.back() == stack.size()) blindScopeIndices.pop_back();
+    if (loopScopeIndices.size() && loopScopeIndices.back() == stack.size()) loopScopeIndices.pop_back();
     return res;
 }
 
-bool ValueTimeline::AssignType(const string& name, const shared_ptr<runtime::Type>& type, locators::SpanLocator pos) {
-    auto search = Lookup(name);
-    if (!search) return false;
-    auto& [scopeindex, var] = *search;
-    auto& topscope = stack.back();
-    if (scopeindex != stack.size() - 1) topscope.externalReferences[name] = true;
-    var->val = type;
-    var->lastUnusedAssignments = {make_shared<locators::SpanLocator>(pos)};
-    var->used = true;
-    return true;
+void ValueTimeline::Store(Var& var, const locators::SpanLocator& pos, const ast::Statement* removable) {
+    var.used = true;
+    var.impureStores = var.impureStores || !removable;
+    if (var.captured)
+        var.lastUnusedAssignments.clear();
+    else
+        var.lastUnusedAssignments = {make_shared<Assignment>(Assignment{pos, removable})};
+}
+
+bool ValueTimeline::AssignType(const string& name, const shared_ptr<runtime::Type>& type, locators::SpanLocator pos,
+                               const ast::Statement* removable) {
+    return AssignWith(name, [&type, &pos, removable](Var& var) {
+        var.val = type;
+        Store(var, pos, removable);
+    });
 }
 
 bool ValueTimeline::AssignValue(const string& name, const shared_ptr<runtime::RuntimeValue>& precomputed,
-                                locators::SpanLocator pos) {
-    auto search = Lookup(name);
-    if (!search) return false;
-    auto& [scopeindex, var] = *search;
-    auto& topscope = stack.back();
-    if (scopeindex != stack.size() - 1) topscope.externalReferences[name] = true;
-    var->val = precomputed;
-    var->lastUnusedAssignments = {make_shared<locators::SpanLocator>(pos)};
-    var->used = true;
-    return true;
+                                locators::SpanLocator pos, const ast::Statement* removable) {
+    return AssignWith(name, [&precomputed, &pos, removable](Var& var) {
+        var.val = precomputed;
+        Store(var, pos, removable);
+    });
 }
 
-bool ValueTimeline::Assign(const string& name, const runtime::TypeOrValue& precomputed, locators::SpanLocator pos) {
-    if (precomputed.index()) return AssignValue(name, get<1>(precomputed), pos);
-    return AssignType(name, get<0>(precomputed), pos);
+bool ValueTimeline::Assign(const string& name, const runtime::TypeOrValue& precomputed, locators::SpanLocator pos,
+                           const ast::Statement* removable) {
+    if (precomputed.index()) return AssignValue(name, get<1>(precomputed), pos, removable);
+    return AssignType(name, get<0>(precomputed), pos, removable);
 }
 
 bool ValueTimeline::AssignUnknownButUsed(const string& name) {
+    return AssignWith(name, [](Var& var) {
+        var.val = make_shared<runtime::UnknownType>();
+        var.lastUnusedAssignments.clear();
+        var.used = true;
+        var.read = true;
+    });
+}
+
+void ValueTimeline::Capture(const string& name) {
+    auto search = Lookup(name);
+    if (!search || search->second->captured) return;
+    stack[search->first].vars.Update(name, [](Var& var) {
+        var.captured = true;
+        var.read = true;
+        var.lastUnusedAssignments.clear();
+    });
+}
+
+bool ValueTimeline::BindClosure(const string& name, const shared_ptr<ast::ClosureDefinition>& closure) {
     auto search = Lookup(name);
     if (!search) return false;
-    auto& [scopeindex, var] = *search;
-    auto& topscope = stack.back();
-    if (scopeindex != stack.size() - 1) topscope.externalReferences[name] = true;
-    var->val = make_shared<runtime::UnknownType>();
-    var->lastUnusedAssignments.clear();
-    var->used = true;
+    stack[search->first].vars.Update(name, [&closure](Var& var) { var.closure = closure; });
     return true;
 }
 
+shared_ptr<ast::ClosureDefinition> ValueTimeline::KnownClosure(const string& name) const {
+    auto search = Lookup(name);
+    if (!search || (blindScopeIndices.size() && search->first < blindScopeIndices.back())) return nullptr;
+    return search->second->closure;
+}
+
 bool ValueTimeline::Declare(const string& name, locators::SpanLocator pos) {
-    auto& topscope = stack.back();
-    auto insertres = topscope.vars.emplace(name, Var(pos));
-    return insertres.second;
+    return stack.back().vars.Insert(name, Var(pos));
 }
 
 static void GeneralizeValue(runtime::TypeOrValue& dest, const runtime::TypeOrValue& src) {
@@ -145,7 +196,7 @@ static void GeneralizeValue(runtime::TypeOrValue& dest, const runtime::TypeOrVal
     dest = lefttype->Generalize(*righttype);
 }
 
-// `used` is OR'ed
+// `used`, `read`, `captured` and `impureStores` are OR'ed
 // useless assignments are INTERSECTED
 // vals are generalized
 // externalReferences are OR'ed
@@ -159,28 +210,20 @@ void ValueTimeline::MergeTimelines(const ValueTimeline& other) {
     for (size_t i = 0; i < n; i++) {
         auto& myscope = stack[i];
         const auto& srcscope = other.stack[i];
-        for (auto& kv : srcscope.externalReferences) {
-            bool& asg = myscope.externalReferences[kv.first];
-            asg = asg || kv.second;
-        }
+        myscope.externalReferences.Merge(srcscope.externalReferences,
+                                         [](bool& asg, bool srcasg) { asg = asg || srcasg; });
 #ifdef DINTERP_DEBUG
-        if (myscope.vars.size() != srcscope.vars.size())
+        if (myscope.vars.Size() != srcscope.vars.Size())
             throw std::runtime_error("variable counts were different when merging timelines");
 #endif
-        auto destiter = myscope.vars.begin();
-        auto destend = myscope.vars.end();
-        auto srciter = srcscope.vars.begin();
-        for (; destiter != destend; ++destiter, ++srciter) {
-#ifdef DINTERP_DEBUG
-            if (destiter->first != srciter->first)
-                throw std::runtime_error("variable names were different when merging timelines");
-#endif
-            auto& destvar = destiter->second;
-            const auto& srcvar = srciter->second;
+        myscope.vars.Merge(srcscope.vars, [](Var& destvar, const Var& srcvar) {
             destvar.used = destvar.used || srcvar.used;
+            destvar.read = destvar.read || srcvar.read;
+            destvar.captured = destvar.captured || srcvar.captured;
+            destvar.impureStores = destvar.impureStores || srcvar.impureStores;
             auto& destunused = destvar.lastUnusedAssignments;
             auto& srcunused = srcvar.lastUnusedAssignments;
-            set<shared_ptr<locators::SpanLocator>> intersect;
+            set<shared_ptr<Assignment>> intersect;
             {
                 auto diter = destunused.begin(), dend = destunused.end();
                 for (const auto& i : srcunused) {
@@ -190,9 +233,77 @@ void ValueTimeline::MergeTimelines(const ValueTimeline& other) {
             }
             destunused.swap(intersect);
             GeneralizeValue(destvar.val, srcvar.val);
-        }
+            if (destvar.closure != srcvar.closure) destvar.closure = nullptr;
+        });
     }
 }
 
+void ValueTimeline::ForgetValue(const string& name) {
+    auto search = Lookup(name);
+    if (!search || (!search->second->val.index() && !search->second->closure)) return;
+    stack[search->first].vars.Update(name, [](Var& var) {
+        if (var.val.index()) var.val = get<1>(var.val)->TypeOfValue();
+        var.closure = nullptr;
+    });
+}
+
+bool ValueTimeline::GeneralizeValues(const ValueTimeline& other, bool widen) {
+    size_t n = stack.size();
+#ifdef DINTERP_DEBUG
+    if (other.stack.size() != n) throw std::runtime_error("stack sizes were different when generalizing timelines");
+#endif
+    bool changed = false;
+    for (size_t i = 0; i < n; i++) {
+        stack[i].vars.Merge(other.stack[i].vars, [&changed, widen](Var& destvar, const Var& srcvar) {
+            auto before = destvar.val;
+            GeneralizeValue(destvar.val, srcvar.val);
+            if (destvar.closure != srcvar.closure) {
+                destvar.closure = nullptr;
+                changed = true;
+            }
+            if (before.index() ? destvar.val.index() && get<1>(destvar.val) == get<1>(before)
+                               : !destvar.val.index() && get<0>(destvar.val)->StrictTypeEq(*get<0>(before)))
+                return;
+            changed = true;
+            if (widen) destvar.val = make_shared<runtime::UnknownType>();
+        });
+    }
+    return changed;
+}
+
+void ValueTimeline::Speculate(Speculation* speculation) { this->speculation = speculation; }
+
+Speculation* ValueTimeline::CurrentSpeculation() const { return speculation; }
+
+void ValueTimeline::EvaluateCallsWith(ICallEvaluator* evaluator) { this->evaluator = evaluator; }
+
+ICallEvaluator* ValueTimeline::CallEvaluator() const { return evaluator; }
+
+void ValueTimeline::CheckClosuresAheadWith(ClosureCheckPool* pool) { closureChecks = pool; }
+
+ClosureCheckPool* ValueTimeline::ClosureChecksAhead() const { return closureChecks; }
+
+ValueTimeline ValueTimeline::Detached() const {
+    ValueTimeline res(*this);
+    res.speculation = nullptr;
+    res.evaluator = nullptr;
+    res.closureChecks = nullptr;
+    return res;
+}
+
+size_t ValueTimeline::VariableCount() const {
+    size_t res = 0;
+    for (auto& scope : stack) res += scope.vars.Size();
+    return res;
+}
+
+const KeptClosure* ValueTimeline::CheckedClosure(const ast::FuncLiteral& literal) const {
+    return speculation ? speculation->CheckedClosure(literal) : nullptr;
+}
+
+void ValueTimeline::KeepClosure(KeptClosure closure) {
+    if (speculation) speculation->KeepClosure(std::move(closure));
+}
+
 }  // namespace semantic
 }  // namespace dinterp
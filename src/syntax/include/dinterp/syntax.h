@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <initializer_list>
 #include <limits>
 #include <map>
 #include <memory>
@@ -21,13 +23,17 @@ public:
     virtual ~WrongNumberOfOperatorsSupplied() override = default;
 };
 
+// Only the rightmost failure matters for the message, and a position always holds the same token, so a report is a
+// position, the token found there and the set of token types expected there; messages are made by MakeReport
 class SyntaxErrorReport {
-    std::shared_ptr<const locators::CodeFile> file;
+    static_assert(static_cast<int>(Token::Type::tkEof) < 64, "every token type must have a bit in `expected`");
+    locators::FileId file;
     size_t rightmostPos = 0;
-    std::map<Token::Type, std::set<Token::Type>> unexpTokens;
+    Token::Type found = Token::Type::tkEof;
+    std::uint64_t expected = 0;  // bit `i` is set if a token of type `i` was expected at `rightmostPos`
 
 public:
-    SyntaxErrorReport(const std::shared_ptr<const locators::CodeFile>& file);
+    SyntaxErrorReport(locators::FileId file);
     void ReportUnexpectedToken(size_t pos, Token::Type expected, Token::Type found);
     std::vector<std::shared_ptr<complog::CompilationMessage>> MakeReport() const;
 };
@@ -53,32 +59,42 @@ private:
         StackBlock(int index, bool ignoreEoln);
     };
 
-    std::shared_ptr<const locators::CodeFile> codeFile;
-    std::vector<std::shared_ptr<Token>> tokens;
+    locators::FileId codeFile;
+    TokenBuffer tokens;
+    // Token objects are only made for the tokens that are returned by Peek or Read; each one is made once
+    std::vector<std::shared_ptr<Token>> tokenObjects;
     std::vector<StackBlock> stack;
     SyntaxErrorReport report;
 
     size_t StartOfToken(size_t index) const;
     size_t EndOfToken(size_t index) const;
     void SkipEolns();
+    const std::shared_ptr<Token>& TokenObject(size_t index);
 
 public:
+    TokenScanner(TokenBuffer tokens, const std::shared_ptr<const locators::CodeFile>& file);
     TokenScanner(const std::vector<std::shared_ptr<Token>>& tokens,
                  const std::shared_ptr<const locators::CodeFile>& file);
     locators::Locator PositionInFile() const;
     locators::Locator StartPositionInFile() const;
     locators::SpanLocator ReadSinceStart() const;
     size_t Index() const;
-    const std::vector<std::shared_ptr<Token>>& Tokens() const;
+    const TokenBuffer& Tokens() const;
     void Start();
     void StartIgnoreEoln();
     void StartUseEoln();
     void EndFail();
     void EndSuccess();
     std::shared_ptr<Token> Peek();
+    Token::Type PeekType() const;
+    // Reports the current token as unexpected where any of `expected` would do, like failed Skip calls would; used
+    // where the parser picks an alternative by the current token instead of trying each one
+    void ReportExpected(std::initializer_list<Token::Type> expected);
     std::shared_ptr<Token> Read();
     void Advance(size_t count = 1);
     std::optional<std::shared_ptr<Token>> Read(Token::Type type);
+    // Same as Read(type), without making the token object
+    bool Skip(Token::Type type);
     SyntaxErrorReport& Report();
     const SyntaxErrorReport& Report() const;
     AutoBlock AutoStart();
@@ -89,6 +105,8 @@ public:
 struct SyntaxContext {
     TokenScanner tokens;
     complog::ICompilationLog* const compilationLog;
+    SyntaxContext(TokenBuffer tokens, const std::shared_ptr<const locators::CodeFile>& file,
+                  complog::ICompilationLog& complog);
     SyntaxContext(const std::vector<std::shared_ptr<Token>>& tokens,
                   const std::shared_ptr<const locators::CodeFile>& file, complog::ICompilationLog& complog);
 };
@@ -622,6 +640,9 @@ public:
 
 class SyntaxAnalyzer {
 public:
+    static std::optional<std::shared_ptr<ast::Body>> analyze(TokenBuffer tokens,
+                                                             const std::shared_ptr<const locators::CodeFile>& file,
+                                                             complog::ICompilationLog& log);
     static std::optional<std::shared_ptr<ast::Body>> analyze(const std::vector<std::shared_ptr<Token>>& tokens,
                                                              const std::shared_ptr<const locators::CodeFile>& file,
                                                              complog::ICompilationLog& log);
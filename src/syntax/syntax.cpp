@@ -29,11 +29,11 @@ optional<shared_ptr<Body>> parseProgram(SyntaxContext& context) {
     vector<shared_ptr<Statement>> sts;
 
     while (true) {
-        if (tk.Read(Token::Type::tkEof)) break;
+        if (tk.Skip(Token::Type::tkEof)) break;
         auto optStmt = Statement::parse(context);
         if (optStmt) sts.push_back(*optStmt);
         if (parseSep(context)) continue;
-        if (tk.Read(Token::Type::tkEof)) break;
+        if (tk.Skip(Token::Type::tkEof)) break;
         return {};
     }
     auto res = make_shared<Body>(tk.ReadSinceStart());
@@ -44,13 +44,13 @@ optional<shared_ptr<Body>> parseProgram(SyntaxContext& context) {
 
 bool parseSep(SyntaxContext& context) {
     USESCAN;
-    return tk.Read(Token::Type::tkNewLine) || tk.Read(Token::Type::tkSemicolon);
+    return tk.Skip(Token::Type::tkNewLine) || tk.Skip(Token::Type::tkSemicolon);
 }
 
 optional<shared_ptr<Expression>> parseAssignExpression(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkAssign)) return {};
+    if (!tk.Skip(Token::Type::tkAssign)) return {};
     auto res = Expression::parse(context);
     if (res) block.Success();
     return res;
@@ -80,49 +80,65 @@ VISITOR(Body)
 optional<shared_ptr<Body>> parseLoopBody(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkLoop)) return {};
+    if (!tk.Skip(Token::Type::tkLoop)) return {};
     auto res = Body::parse(context);
     if (!res) return {};  // This is currently impossible. I am being explicit in case something changes.
-    if (!tk.Read(Token::Type::tkEnd)) return {};
+    if (!tk.Skip(Token::Type::tkEnd)) return {};
     block.Success();
     return res;
 }
 
 Statement::Statement(const locators::SpanLocator& pos) : ASTNode(pos) {}
+// Most kinds of statements are told apart by their first token. The exceptions are the two forms of `if` (known at
+// `then` or `=>`) and assignments, which start like expressions.
 optional<shared_ptr<Statement>> Statement::parse(SyntaxContext& context) {
 #define TRY(classname)                        \
     {                                         \
         auto res = classname::parse(context); \
         if (res) return res;                  \
     }
-    TRY(VarStatement)
-    TRY(IfStatement)
-    TRY(ShortIfStatement)
-    TRY(WhileStatement)
-    TRY(ForStatement)
-    TRY(LoopStatement)
-    TRY(ExitStatement)
-    TRY(AssignStatement)
-    TRY(PrintStatement)
-    TRY(ReturnStatement)
-    TRY(ExpressionStatement)
+    USESCAN;
+    switch (tk.PeekType()) {
+        case Token::Type::tkVar:
+            return VarStatement::parse(context);
+        case Token::Type::tkIf:
+            TRY(IfStatement)
+            return ShortIfStatement::parse(context);
+        case Token::Type::tkWhile:
+            return WhileStatement::parse(context);
+        case Token::Type::tkFor:
+            return ForStatement::parse(context);
+        case Token::Type::tkLoop:
+            return LoopStatement::parse(context);
+        case Token::Type::tkExit:
+            return ExitStatement::parse(context);
+        case Token::Type::tkPrint:
+            return PrintStatement::parse(context);
+        case Token::Type::tkReturn:
+            return ReturnStatement::parse(context);
+        default:
+            break;
+    }
+    tk.ReportExpected({Token::Type::tkVar, Token::Type::tkIf, Token::Type::tkWhile, Token::Type::tkFor,
+                       Token::Type::tkLoop, Token::Type::tkExit, Token::Type::tkPrint, Token::Type::tkReturn});
+    if (tk.PeekType() == Token::Type::tkIdent) TRY(AssignStatement)
+    return ExpressionStatement::parse(context);
 #undef TRY
-    return {};
 }
 
 VarStatement::VarStatement(const locators::SpanLocator& pos) : Statement(pos) {}
 optional<shared_ptr<VarStatement>> VarStatement::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkVar)) return {};
-    tk.Read(Token::Type::tkNewLine);
+    if (!tk.Skip(Token::Type::tkVar)) return {};
+    tk.Skip(Token::Type::tkNewLine);
     bool first = true;
     vector<pair<shared_ptr<IdentifierToken>, optional<shared_ptr<Expression>>>> defs;
     while (true) {
         auto bl = tk.AutoStart();
         if (!first) {
-            if (!tk.Read(Token::Type::tkComma)) break;
-            tk.Read(Token::Type::tkNewLine);
+            if (!tk.Skip(Token::Type::tkComma)) break;
+            tk.Skip(Token::Type::tkNewLine);
         }
         first = false;
         auto optIdent = tk.Read(Token::Type::tkIdent);
@@ -149,7 +165,7 @@ IfStatement::IfStatement(const locators::SpanLocator& pos, const shared_ptr<Expr
 optional<shared_ptr<IfStatement>> IfStatement::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkIf)) return {};
+    if (!tk.Skip(Token::Type::tkIf)) return {};
     optional<shared_ptr<Expression>> optExpr;
     {
         auto ign = tk.AutoStartIgnoreEoln();
@@ -157,16 +173,16 @@ optional<shared_ptr<IfStatement>> IfStatement::parse(SyntaxContext& context) {
         if (!optExpr) return {};
         ign.Success();
     }
-    if (!tk.Read(Token::Type::tkThen)) return {};
+    if (!tk.Skip(Token::Type::tkThen)) return {};
     auto optDoTrue = Body::parse(context);
     if (!optDoTrue) return {};
     optional<shared_ptr<Body>> optDoFalse;
     {
         auto bl = tk.AutoStart();
-        if (tk.Read(Token::Type::tkElse)) optDoFalse = Body::parse(context);
+        if (tk.Skip(Token::Type::tkElse)) optDoFalse = Body::parse(context);
         if (optDoFalse) bl.Success();
     }
-    if (!tk.Read(Token::Type::tkEnd)) return {};
+    if (!tk.Skip(Token::Type::tkEnd)) return {};
     block.Success();
     return make_shared<IfStatement>(tk.ReadSinceStart(), *optExpr, *optDoTrue, optDoFalse);
 }
@@ -179,15 +195,15 @@ optional<shared_ptr<ShortIfStatement>> ShortIfStatement::parse(SyntaxContext& co
     USESCAN;
     auto block = tk.AutoStart();
     optional<shared_ptr<Expression>> optExpr;
-    if (!tk.Read(Token::Type::tkIf)) return {};
+    if (!tk.Skip(Token::Type::tkIf)) return {};
     {
         auto ign = tk.AutoStartIgnoreEoln();
         optExpr = Expression::parse(context);
         if (!optExpr) return {};
         ign.Success();
     }
-    if (!tk.Read(Token::Type::tkArrow)) return {};
-    tk.Read(Token::Type::tkNewLine);
+    if (!tk.Skip(Token::Type::tkArrow)) return {};
+    tk.Skip(Token::Type::tkNewLine);
     auto optStatement = Statement::parse(context);
     if (!optStatement) return {};
     block.Success();
@@ -201,7 +217,7 @@ WhileStatement::WhileStatement(const locators::SpanLocator& pos, const shared_pt
 optional<shared_ptr<WhileStatement>> WhileStatement::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkWhile)) return {};
+    if (!tk.Skip(Token::Type::tkWhile)) return {};
     optional<shared_ptr<Expression>> optExpr;
     {
         auto ign = tk.AutoStartIgnoreEoln();
@@ -220,12 +236,12 @@ ForStatement::ForStatement(const locators::SpanLocator& pos) : Statement(pos) {}
 optional<shared_ptr<ForStatement>> ForStatement::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkFor)) return {};
+    if (!tk.Skip(Token::Type::tkFor)) return {};
     optional<shared_ptr<IdentifierToken>> optVarName;
     {
         auto bl = tk.AutoStart();
         auto optIdent = tk.Read(Token::Type::tkIdent);
-        if (optIdent && tk.Read(Token::Type::tkIn)) {
+        if (optIdent && tk.Skip(Token::Type::tkIn)) {
             optVarName = dynamic_pointer_cast<IdentifierToken>(*optIdent);
             bl.Success();
         }
@@ -240,7 +256,7 @@ optional<shared_ptr<ForStatement>> ForStatement::parse(SyntaxContext& context) {
     optional<shared_ptr<Expression>> rangeEnd;
     {
         auto bl = tk.AutoStart();
-        if (tk.Read(Token::Type::tkRange)) {
+        if (tk.Skip(Token::Type::tkRange)) {
             auto ign = tk.AutoStartIgnoreEoln();
             rangeEnd = Expression::parse(context);
             if (rangeEnd) ign.Success();
@@ -275,7 +291,7 @@ ExitStatement::ExitStatement(const locators::SpanLocator& pos) : Statement(pos)
 optional<shared_ptr<ExitStatement>> ExitStatement::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkExit)) return {};
+    if (!tk.Skip(Token::Type::tkExit)) return {};
     block.Success();
     return make_shared<ExitStatement>(tk.ReadSinceStart());
 }
@@ -289,7 +305,7 @@ optional<shared_ptr<AssignStatement>> AssignStatement::parse(SyntaxContext& cont
     auto block = tk.AutoStart();
     auto optRef = Reference::parse(context);
     if (!optRef) return {};
-    if (!tk.Read(Token::Type::tkAssign)) return {};
+    if (!tk.Skip(Token::Type::tkAssign)) return {};
     auto optExpr = Expression::parse(context);
     if (!optExpr) return {};
     block.Success();
@@ -302,7 +318,7 @@ PrintStatement::PrintStatement(const locators::SpanLocator& pos, const vector<sh
 optional<shared_ptr<PrintStatement>> PrintStatement::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkPrint)) return {};
+    if (!tk.Skip(Token::Type::tkPrint)) return {};
     block.Success();
     auto exprs = CommaExpressions::parse(context);
     vector<shared_ptr<Expression>> lst;
@@ -316,7 +332,7 @@ ReturnStatement::ReturnStatement(const locators::SpanLocator& pos, const optiona
 optional<shared_ptr<ReturnStatement>> ReturnStatement::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkReturn)) return {};
+    if (!tk.Skip(Token::Type::tkReturn)) return {};
     block.Success();
     auto optExpr = Expression::parse(context);
     return make_shared<ReturnStatement>(tk.ReadSinceStart(), optExpr);
@@ -342,7 +358,7 @@ optional<shared_ptr<CommaExpressions>> CommaExpressions::parse(SyntaxContext& co
     while (true) {
         auto bl = tk.AutoStart();
         if (!first) {
-            if (!tk.Read(Token::Type::tkComma)) break;
+            if (!tk.Skip(Token::Type::tkComma)) break;
         }
         first = false;
         auto optExpr = Expression::parse(context);
@@ -366,7 +382,7 @@ optional<shared_ptr<CommaIdents>> CommaIdents::parse(SyntaxContext& context) {
     while (true) {
         auto bl = tk.AutoStart();
         if (!first) {
-            if (!tk.Read(Token::Type::tkComma)) break;
+            if (!tk.Skip(Token::Type::tkComma)) break;
         }
         first = false;
         auto optIdent = tk.Read(Token::Type::tkIdent);
@@ -383,23 +399,20 @@ VISITOR(CommaIdents)
 
 Accessor::Accessor(const locators::SpanLocator& pos) : ASTNode(pos) {}
 optional<shared_ptr<Accessor>> Accessor::parse(SyntaxContext& context) {
-    {
-        auto res = IdentMemberAccessor::parse(context);
-        if (res) return res;
-    }
-    {
-        auto res = IntLiteralMemberAccessor::parse(context);
-        if (res) return res;
-    }
-    {
-        auto res = ParenMemberAccessor::parse(context);
-        if (res) return res;
-    }
-    {
-        auto res = IndexAccessor::parse(context);
-        if (res) return res;
+    USESCAN;
+    switch (tk.PeekType()) {
+        case Token::Type::tkDot: {
+            // member accessors differ in the token after the dot
+            if (auto res = IdentMemberAccessor::parse(context)) return res;
+            if (auto res = IntLiteralMemberAccessor::parse(context)) return res;
+            return ParenMemberAccessor::parse(context);
+        }
+        case Token::Type::tkOpenBracket:
+            return IndexAccessor::parse(context);
+        default:
+            tk.ReportExpected({Token::Type::tkDot, Token::Type::tkOpenBracket});
+            return {};
     }
-    return {};
 }
 
 IdentMemberAccessor::IdentMemberAccessor(const locators::SpanLocator& pos, const shared_ptr<IdentifierToken>& name)
@@ -407,7 +420,7 @@ IdentMemberAccessor::IdentMemberAccessor(const locators::SpanLocator& pos, const
 optional<shared_ptr<IdentMemberAccessor>> IdentMemberAccessor::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkDot)) return {};
+    if (!tk.Skip(Token::Type::tkDot)) return {};
     auto optIdent = tk.Read(Token::Type::tkIdent);
     if (!optIdent) return {};
     auto ident = dynamic_pointer_cast<IdentifierToken>(*optIdent);
@@ -422,7 +435,7 @@ IntLiteralMemberAccessor::IntLiteralMemberAccessor(const locators::SpanLocator&
 optional<shared_ptr<IntLiteralMemberAccessor>> IntLiteralMemberAccessor::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkDot)) return {};
+    if (!tk.Skip(Token::Type::tkDot)) return {};
     auto optint = tk.Read(Token::Type::tkIntLiteral);
     if (!optint) return {};
     auto intlit = dynamic_pointer_cast<IntegerToken>(*optint);
@@ -436,7 +449,7 @@ ParenMemberAccessor::ParenMemberAccessor(const locators::SpanLocator& pos, const
 optional<shared_ptr<ParenMemberAccessor>> ParenMemberAccessor::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkDot)) return {};
+    if (!tk.Skip(Token::Type::tkDot)) return {};
     auto expr = ParenthesesExpression::parse(context);
     if (!expr) return {};
     block.Success();
@@ -449,7 +462,7 @@ IndexAccessor::IndexAccessor(const locators::SpanLocator& pos, const shared_ptr<
 optional<shared_ptr<IndexAccessor>> IndexAccessor::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkOpenBracket)) return {};
+    if (!tk.Skip(Token::Type::tkOpenBracket)) return {};
     optional<shared_ptr<Expression>> expr;
     {
         auto ign = tk.AutoStartIgnoreEoln();
@@ -457,7 +470,7 @@ optional<shared_ptr<IndexAccessor>> IndexAccessor::parse(SyntaxContext& context)
         if (!expr) return {};
         ign.Success();
     }
-    if (!tk.Read(Token::Type::tkClosedBracket)) return {};
+    if (!tk.Skip(Token::Type::tkClosedBracket)) return {};
     block.Success();
     return make_shared<IndexAccessor>(tk.ReadSinceStart(), *expr);
 }
@@ -490,113 +503,159 @@ struct ParsedBinaryOperator {
     std::optional<std::variant<Term::TermOperator, Sum::SumOperator, BinaryRelationOperator>> OpKind;
 };
 
-optional<ParsedBinaryOperator> parseBinaryOperator(SyntaxContext& context) {
-    USESCAN;
-    if (tk.Read(Token::Type::tkTimes)) return {{BinaryPrecedence::Mul, Term::TermOperator::Times}};
-    if (tk.Read(Token::Type::tkDivide)) return {{BinaryPrecedence::Mul, Term::TermOperator::Divide}};
-    if (tk.Read(Token::Type::tkPlus)) return {{BinaryPrecedence::Sum, Sum::SumOperator::Plus}};
-    if (tk.Read(Token::Type::tkMinus)) return {{BinaryPrecedence::Sum, Sum::SumOperator::Minus}};
-    if (tk.Read(Token::Type::tkLess)) return {{BinaryPrecedence::Comparison, BinaryRelationOperator::Less}};
-    if (tk.Read(Token::Type::tkLessEq)) return {{BinaryPrecedence::Comparison, BinaryRelationOperator::LessEq}};
-    if (tk.Read(Token::Type::tkGreater)) return {{BinaryPrecedence::Comparison, BinaryRelationOperator::Greater}};
-    if (tk.Read(Token::Type::tkGreaterEq)) return {{BinaryPrecedence::Comparison, BinaryRelationOperator::GreaterEq}};
-    if (tk.Read(Token::Type::tkEqual)) return {{BinaryPrecedence::Comparison, BinaryRelationOperator::Equal}};
-    if (tk.Read(Token::Type::tkNotEqual)) return {{BinaryPrecedence::Comparison, BinaryRelationOperator::NotEqual}};
-    if (tk.Read(Token::Type::tkAnd)) return {{BinaryPrecedence::And, {}}};
-    if (tk.Read(Token::Type::tkOr)) return {{BinaryPrecedence::Or, {}}};
-    if (tk.Read(Token::Type::tkXor)) return {{BinaryPrecedence::Xor, {}}};
-    return {};
+static optional<ParsedBinaryOperator> binaryOperatorOf(Token::Type type) {
+    switch (type) {
+        case Token::Type::tkTimes:
+            return {{BinaryPrecedence::Mul, Term::TermOperator::Times}};
+        case Token::Type::tkDivide:
+            return {{BinaryPrecedence::Mul, Term::TermOperator::Divide}};
+        case Token::Type::tkPlus:
+            return {{BinaryPrecedence::Sum, Sum::SumOperator::Plus}};
+        case Token::Type::tkMinus:
+            return {{BinaryPrecedence::Sum, Sum::SumOperator::Minus}};
+        case Token::Type::tkLess:
+            return {{BinaryPrecedence::Comparison, BinaryRelationOperator::Less}};
+        case Token::Type::tkLessEq:
+            return {{BinaryPrecedence::Comparison, BinaryRelationOperator::LessEq}};
+        case Token::Type::tkGreater:
+            return {{BinaryPrecedence::Comparison, BinaryRelationOperator::Greater}};
+        case Token::Type::tkGreaterEq:
+            return {{BinaryPrecedence::Comparison, BinaryRelationOperator::GreaterEq}};
+        case Token::Type::tkEqual:
+            return {{BinaryPrecedence::Comparison, BinaryRelationOperator::Equal}};
+        case Token::Type::tkNotEqual:
+            return {{BinaryPrecedence::Comparison, BinaryRelationOperator::NotEqual}};
+        case Token::Type::tkAnd:
+            return {{BinaryPrecedence::And, {}}};
+        case Token::Type::tkOr:
+            return {{BinaryPrecedence::Or, {}}};
+        case Token::Type::tkXor:
+            return {{BinaryPrecedence::Xor, {}}};
+        default:
+            return {};
+    }
 }
 
-static void CollapseOperandStack(vector<shared_ptr<Expression>>& operands, vector<ParsedBinaryOperator>& operators,
-                                 int minPrecedence) {
-    while (operators.size() && static_cast<int>(operators.back().Precedence) < minPrecedence) {
-        auto precedence = operators.back().Precedence;
-        size_t count = 2;
-        size_t n_operands = operands.size(), n_operators = operators.size();
-        while (count < n_operands && operators[n_operators - count].Precedence == precedence) ++count;
-        vector<shared_ptr<Expression>> nds(operands.end() - count, operands.end());
-        operands.erase(operands.end() - count, operands.end());
-        shared_ptr<Expression> composite;
-        switch (precedence) {
-            case BinaryPrecedence::Mul: {
-                vector<Term::TermOperator> op(count - 1);
-                std::ranges::transform(operators.end() - (count - 1), operators.end(), op.begin(),
-                                       [](ParsedBinaryOperator p) { return get<Term::TermOperator>(*p.OpKind); });
-                composite = make_shared<Term>(nds, op);
-                break;
-            }
-            case BinaryPrecedence::Sum: {
-                vector<Sum::SumOperator> op(count - 1);
-                std::ranges::transform(operators.end() - (count - 1), operators.end(), op.begin(),
-                                       [](ParsedBinaryOperator p) { return get<Sum::SumOperator>(*p.OpKind); });
-                composite = make_shared<Sum>(nds, op);
-                break;
-            }
-            case BinaryPrecedence::Comparison: {
-                vector<BinaryRelationOperator> op(count - 1);
-                std::ranges::transform(operators.end() - (count - 1), operators.end(), op.begin(),
-                                       [](ParsedBinaryOperator p) { return get<BinaryRelationOperator>(*p.OpKind); });
-                composite = make_shared<BinaryRelation>(nds, op);
-                break;
-            }
-            case BinaryPrecedence::And: {
-                composite = make_shared<AndOperator>(nds);
-                break;
-            }
-            case BinaryPrecedence::Or: {
-                composite = make_shared<OrOperator>(nds);
-                break;
-            }
-            case BinaryPrecedence::Xor: {
-                composite = make_shared<XorOperator>(nds);
-                break;
-            }
-            default:
-                throw invalid_argument("NOT operator is not a binary operator");
-        }
-        operands.push_back(composite);
-        operators.erase(operators.end() - (count - 1), operators.end());
-    }
+template <typename OperatorKind>
+static vector<OperatorKind> operatorKinds(const vector<ParsedBinaryOperator>& operators) {
+    vector<OperatorKind> res(operators.size());
+    std::ranges::transform(operators, res.begin(), [](ParsedBinaryOperator p) { return get<OperatorKind>(*p.OpKind); });
+    return res;
 }
 
-Expression::Expression(const locators::SpanLocator& pos) : ASTNode(pos) {}
+static shared_ptr<Expression> makeOperatorNode(BinaryPrecedence precedence,
+                                               const vector<shared_ptr<Expression>>& operands,
+                                               const vector<ParsedBinaryOperator>& operators) {
+    switch (precedence) {
+        case BinaryPrecedence::Mul:
+            return make_shared<Term>(operands, operatorKinds<Term::TermOperator>(operators));
+        case BinaryPrecedence::Sum:
+            return make_shared<Sum>(operands, operatorKinds<Sum::SumOperator>(operators));
+        case BinaryPrecedence::Comparison:
+            return make_shared<BinaryRelation>(operands, operatorKinds<BinaryRelationOperator>(operators));
+        case BinaryPrecedence::And:
+            return make_shared<AndOperator>(operands);
+        case BinaryPrecedence::Or:
+            return make_shared<OrOperator>(operands);
+        case BinaryPrecedence::Xor:
+            return make_shared<XorOperator>(operands);
+        default:
+            throw invalid_argument("NOT operator is not a binary operator");
+    }
+}
 
-optional<shared_ptr<Expression>> Expression::parse(SyntaxContext& context, int max_precedence) {
-    USESCAN;
-    auto block = tk.AutoStart();
-    bool first = true;
-    vector<shared_ptr<Expression>> unaries;
-    vector<ParsedBinaryOperator> operators;
-    while (true) {
-        auto bl = tk.AutoStart();
-        ParsedBinaryOperator op;
-        if (!first) {
-            auto opt_op = parseBinaryOperator(context);
-            if (!opt_op) break;
-            if (static_cast<int>(opt_op->Precedence) > max_precedence) break;
-            op = *opt_op;
+/*
+ * Precedence climbing. A run of operators of the same precedence becomes one node (`a + b - c` is a single `Sum`), and
+ * an operand gets no wrapper it does not need: a lone `Primary` is not put into a `Unary`, and a lone `Unary` is not
+ * put into a one-operand `Term`.
+ *
+ * The expression ends at the first token that is not a binary operator, or before a binary operator that is not
+ * followed by an operand (`1 +` is the expression `1`).
+ */
+class ExpressionParser {
+    SyntaxContext& context;
+    TokenScanner& tk;
+    // the binary operator at the current token, valid while `ended` is false
+    ParsedBinaryOperator next{BinaryPrecedence::Mul, {}};
+    bool ended = false;
+
+    void PeekOperator() {
+        auto op = binaryOperatorOf(tk.PeekType());
+        if (op) {
+            next = *op;
+            return;
         }
-        optional<shared_ptr<Expression>> optunary = UnaryNot::parse(context);
-        if (!optunary) {
-            optunary = Unary::parse(context);
-            if (!optunary) break;
+        ended = true;
+        tk.ReportExpected({Token::Type::tkTimes, Token::Type::tkDivide, Token::Type::tkPlus, Token::Type::tkMinus,
+                           Token::Type::tkLess, Token::Type::tkLessEq, Token::Type::tkGreater, Token::Type::tkGreaterEq,
+                           Token::Type::tkEqual, Token::Type::tkNotEqual, Token::Type::tkAnd, Token::Type::tkOr,
+                           Token::Type::tkXor});
+    }
+
+    optional<shared_ptr<Expression>> ParseOperand() {
+        if (tk.PeekType() == Token::Type::tkNot) return UnaryNot::parse(context);
+        tk.ReportExpected({Token::Type::tkNot});
+        vector<shared_ptr<PrefixOperator>> prefs;
+        while (tk.PeekType() == Token::Type::tkMinus || tk.PeekType() == Token::Type::tkPlus)
+            prefs.push_back(*PrefixOperator::parse(context));
+        tk.ReportExpected({Token::Type::tkMinus, Token::Type::tkPlus});
+        auto prim = Primary::parse(context);
+        if (!prim) return {};
+        vector<shared_ptr<PostfixOperator>> posts;
+        while (true) {
+            auto op = PostfixOperator::parse(context);
+            if (!op) break;
+            posts.push_back(*op);
         }
-        bl.Success();
+        if (prefs.empty() && posts.empty()) return *prim;
+        locators::SpanLocator pos(prefs.empty() ? (*prim)->pos : prefs.front()->pos,
+                                  posts.empty() ? (*prim)->pos : posts.back()->pos);
+        return make_shared<Unary>(pos, prefs, posts, *prim);
+    }
 
-        if (first) {
-            first = false;
-            unaries.push_back(*optunary);
-            continue;
+    // Extends `lhs` with the following operators of precedence up to `maxPrecedence`
+    shared_ptr<Expression> Climb(shared_ptr<Expression> lhs, int maxPrecedence) {
+        while (!ended && static_cast<int>(next.Precedence) <= maxPrecedence) {
+            auto precedence = next.Precedence;
+            vector<shared_ptr<Expression>> operands{lhs};
+            vector<ParsedBinaryOperator> operators;
+            while (!ended && next.Precedence == precedence) {
+                auto op = next;
+                auto block = tk.AutoStart();
+                tk.Skip(tk.PeekType());
+                auto operand = ParseOperand();
+                if (!operand) {
+                    ended = true;
+                    break;
+                }
+                block.Success();
+                PeekOperator();
+                operands.push_back(Climb(*operand, static_cast<int>(precedence) - 1));
+                operators.push_back(op);
+            }
+            if (operators.size()) lhs = makeOperatorNode(precedence, operands, operators);
         }
-        CollapseOperandStack(unaries, operators, static_cast<int>(op.Precedence));
-        unaries.push_back(*optunary);
-        operators.push_back(op);
+        return lhs;
     }
-    if (first) return {};
-    CollapseOperandStack(unaries, operators, numeric_limits<int>::max());
-    block.Success();
-    return unaries.front();
+
+public:
+    ExpressionParser(SyntaxContext& context) : context(context), tk(context.tokens) {}
+
+    optional<shared_ptr<Expression>> Parse(int maxPrecedence) {
+        auto block = tk.AutoStart();
+        auto first = ParseOperand();
+        if (!first) return {};
+        PeekOperator();
+        auto res = Climb(*first, maxPrecedence);
+        block.Success();
+        return res;
+    }
+};
+
+Expression::Expression(const locators::SpanLocator& pos) : ASTNode(pos) {}
+
+optional<shared_ptr<Expression>> Expression::parse(SyntaxContext& context, int max_precedence) {
+    return ExpressionParser(context).Parse(max_precedence);
 }
 
 locators::SpanLocator SpanLocatorFromExpressions(const Expression& first, const Expression& last) {
@@ -633,7 +692,7 @@ VISITOR(BinaryRelation)
 optional<BinaryRelationOperator> parseBinaryRelationOperator(SyntaxContext& context) {
     USESCAN;
 #define TRY(op) \
-    if (tk.Read(Token::Type::tk##op)) return BinaryRelationOperator::op;
+    if (tk.Skip(Token::Type::tk##op)) return BinaryRelationOperator::op;
     TRY(Less)
     TRY(LessEq)
     TRY(Greater)
@@ -688,7 +747,7 @@ UnaryNot::UnaryNot(const locators::SpanLocator& pos, const shared_ptr<Expression
 optional<shared_ptr<UnaryNot>> UnaryNot::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkNot)) return {};
+    if (!tk.Skip(Token::Type::tkNot)) return {};
     auto nested = Expression::parse(context, static_cast<int>(BinaryPrecedence::Not));
     if (!nested) return {};
     block.Success();
@@ -705,9 +764,9 @@ optional<shared_ptr<PrefixOperator>> PrefixOperator::parse(SyntaxContext& contex
     USESCAN;
     auto block = tk.AutoStart();
     PrefixOperatorKind kind;
-    if (tk.Read(Token::Type::tkMinus))
+    if (tk.Skip(Token::Type::tkMinus))
         kind = PrefixOperatorKind::Minus;
-    else if (tk.Read(Token::Type::tkPlus))
+    else if (tk.Skip(Token::Type::tkPlus))
         kind = PrefixOperatorKind::Plus;
     else
         return {};
@@ -717,16 +776,20 @@ optional<shared_ptr<PrefixOperator>> PrefixOperator::parse(SyntaxContext& contex
 
 PostfixOperator::PostfixOperator(const locators::SpanLocator& pos) : ASTNode(pos) {}
 optional<shared_ptr<PostfixOperator>> PostfixOperator::parse(SyntaxContext& context) {
-#define TRY(classname)                        \
-    {                                         \
-        auto res = classname::parse(context); \
-        if (res) return res;                  \
+    USESCAN;
+    switch (tk.PeekType()) {
+        case Token::Type::tkIs:
+            return TypecheckOperator::parse(context);
+        case Token::Type::tkOpenParenthesis:
+            return Call::parse(context);
+        case Token::Type::tkDot:
+        case Token::Type::tkOpenBracket:
+            return AccessorOperator::parse(context);
+        default:
+            tk.ReportExpected({Token::Type::tkIs, Token::Type::tkOpenParenthesis, Token::Type::tkDot,
+                               Token::Type::tkOpenBracket});
+            return {};
     }
-    TRY(TypecheckOperator)
-    TRY(Call)
-    TRY(AccessorOperator)
-    return {};
-#undef TRY
 }
 
 TypecheckOperator::TypecheckOperator(const locators::SpanLocator& pos, TypeId typeId)
@@ -735,7 +798,7 @@ int TypecheckOperator::precedence() { return 3; }
 optional<shared_ptr<TypecheckOperator>> TypecheckOperator::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkIs)) return {};
+    if (!tk.Skip(Token::Type::tkIs)) return {};
     auto op = parseTypeId(context);
     if (!op) return {};
     block.Success();
@@ -746,7 +809,7 @@ VISITOR(TypecheckOperator)
 optional<TypeId> parseTypeId(SyntaxContext& context) {
     USESCAN;
 #define TRY(name)                         \
-    if (tk.Read(Token::Type::tk##name)) { \
+    if (tk.Skip(Token::Type::tk##name)) { \
         return TypeId::name;              \
     }
     TRY(Int)
@@ -758,14 +821,14 @@ optional<TypeId> parseTypeId(SyntaxContext& context) {
 #undef TRY
     {
         auto bl = tk.AutoStart();
-        if (tk.Read(Token::Type::tkOpenBracket) && tk.Read(Token::Type::tkClosedBracket)) {
+        if (tk.Skip(Token::Type::tkOpenBracket) && tk.Skip(Token::Type::tkClosedBracket)) {
             bl.Success();
             return TypeId::List;
         }
     }
     {
         auto bl = tk.AutoStart();
-        if (tk.Read(Token::Type::tkOpenCurlyBrace) && tk.Read(Token::Type::tkClosedCurlyBrace)) {
+        if (tk.Skip(Token::Type::tkOpenCurlyBrace) && tk.Skip(Token::Type::tkClosedCurlyBrace)) {
             bl.Success();
             return TypeId::Tuple;
         }
@@ -780,7 +843,7 @@ optional<shared_ptr<Call>> Call::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
     optional<shared_ptr<CommaExpressions>> comexpr;
-    if (!tk.Read(Token::Type::tkOpenParenthesis)) return {};
+    if (!tk.Skip(Token::Type::tkOpenParenthesis)) return {};
     {
         auto ign = tk.AutoStartIgnoreEoln();
         comexpr = CommaExpressions::parse(context);
@@ -788,7 +851,7 @@ optional<shared_ptr<Call>> Call::parse(SyntaxContext& context) {
     }
     vector<shared_ptr<Expression>> args;
     if (comexpr) args = comexpr.value()->expressions;
-    if (!tk.Read(Token::Type::tkClosedParenthesis)) return {};
+    if (!tk.Skip(Token::Type::tkClosedParenthesis)) return {};
     block.Success();
     return make_shared<Call>(tk.ReadSinceStart(), args);
 }
@@ -806,19 +869,32 @@ VISITOR(AccessorOperator)
 
 Primary::Primary(const locators::SpanLocator& pos) : Expression(pos) {}
 optional<shared_ptr<Primary>> Primary::parse(SyntaxContext& context) {
-#define TRY(classname)                        \
-    {                                         \
-        auto res = classname::parse(context); \
-        if (res) return res;                  \
+    USESCAN;
+    switch (tk.PeekType()) {
+        case Token::Type::tkIdent:
+            return PrimaryIdent::parse(context);
+        case Token::Type::tkOpenParenthesis:
+            return ParenthesesExpression::parse(context);
+        case Token::Type::tkFunc:
+            return FuncLiteral::parse(context);
+        case Token::Type::tkStringLiteral:
+        case Token::Type::tkIntLiteral:
+        case Token::Type::tkRealLiteral:
+        case Token::Type::tkTrue:
+        case Token::Type::tkFalse:
+        case Token::Type::tkNone:
+            return TokenLiteral::parse(context);
+        case Token::Type::tkOpenBracket:
+            return ArrayLiteral::parse(context);
+        case Token::Type::tkOpenCurlyBrace:
+            return TupleLiteral::parse(context);
+        default:
+            tk.ReportExpected({Token::Type::tkIdent, Token::Type::tkOpenParenthesis, Token::Type::tkFunc,
+                               Token::Type::tkStringLiteral, Token::Type::tkIntLiteral, Token::Type::tkRealLiteral,
+                               Token::Type::tkTrue, Token::Type::tkFalse, Token::Type::tkNone,
+                               Token::Type::tkOpenBracket, Token::Type::tkOpenCurlyBrace});
+            return {};
     }
-    TRY(PrimaryIdent)
-    TRY(ParenthesesExpression)
-    TRY(FuncLiteral)
-    TRY(TokenLiteral)
-    TRY(ArrayLiteral)
-    TRY(TupleLiteral)
-#undef TRY
-    return {};
 }
 
 PrimaryIdent::PrimaryIdent(const locators::SpanLocator& pos, const shared_ptr<IdentifierToken>& name)
@@ -838,7 +914,7 @@ ParenthesesExpression::ParenthesesExpression(const locators::SpanLocator& pos, c
 optional<shared_ptr<ParenthesesExpression>> ParenthesesExpression::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkOpenParenthesis)) return {};
+    if (!tk.Skip(Token::Type::tkOpenParenthesis)) return {};
     optional<shared_ptr<Expression>> expr;
     {
         auto ign = tk.AutoStartIgnoreEoln();
@@ -846,7 +922,7 @@ optional<shared_ptr<ParenthesesExpression>> ParenthesesExpression::parse(SyntaxC
         if (!expr) return {};
         ign.Success();
     }
-    if (!tk.Read(Token::Type::tkClosedParenthesis)) return {};
+    if (!tk.Skip(Token::Type::tkClosedParenthesis)) return {};
     block.Success();
     return make_shared<ParenthesesExpression>(tk.ReadSinceStart(), *expr);
 }
@@ -864,7 +940,7 @@ optional<shared_ptr<TupleLiteralElement>> TupleLiteralElement::parse(SyntaxConte
         auto bl = tk.AutoStart();
         auto optident = tk.Read(Token::Type::tkIdent);
         if (optident) {
-            if (tk.Read(Token::Type::tkAssign)) {
+            if (tk.Skip(Token::Type::tkAssign)) {
                 bl.Success();
                 ident = dynamic_pointer_cast<IdentifierToken>(*optident);
             }
@@ -882,7 +958,7 @@ TupleLiteral::TupleLiteral(const locators::SpanLocator& pos, const vector<shared
 optional<shared_ptr<TupleLiteral>> TupleLiteral::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkOpenCurlyBrace)) return {};
+    if (!tk.Skip(Token::Type::tkOpenCurlyBrace)) return {};
     vector<shared_ptr<TupleLiteralElement>> elems;
     bool first = true;
     {
@@ -891,7 +967,7 @@ optional<shared_ptr<TupleLiteral>> TupleLiteral::parse(SyntaxContext& context) {
         while (true) {
             auto bl = tk.AutoStart();
             if (!first) {
-                if (!tk.Read(Token::Type::tkComma)) break;
+                if (!tk.Skip(Token::Type::tkComma)) break;
             }
             first = false;
             auto elem = TupleLiteralElement::parse(context);
@@ -900,7 +976,7 @@ optional<shared_ptr<TupleLiteral>> TupleLiteral::parse(SyntaxContext& context) {
             bl.Success();
         }
     }
-    if (!tk.Read(Token::Type::tkClosedCurlyBrace)) return {};
+    if (!tk.Skip(Token::Type::tkClosedCurlyBrace)) return {};
     block.Success();
     return make_shared<TupleLiteral>(tk.ReadSinceStart(), elems);
 }
@@ -908,15 +984,16 @@ VISITOR(TupleLiteral)
 
 FuncBody::FuncBody(const locators::SpanLocator& pos) : ASTNode(pos) {}
 optional<shared_ptr<FuncBody>> FuncBody::parse(SyntaxContext& context) {
-#define TRY(classname)                        \
-    {                                         \
-        auto res = classname::parse(context); \
-        if (res) return res;                  \
+    USESCAN;
+    switch (tk.PeekType()) {
+        case Token::Type::tkArrow:
+            return ShortFuncBody::parse(context);
+        case Token::Type::tkIs:
+            return LongFuncBody::parse(context);
+        default:
+            tk.ReportExpected({Token::Type::tkArrow, Token::Type::tkIs});
+            return {};
     }
-    TRY(ShortFuncBody)
-    TRY(LongFuncBody)
-#undef TRY
-    return {};
 }
 
 ShortFuncBody::ShortFuncBody(const locators::SpanLocator& pos, const shared_ptr<Expression>& expressionToReturn)
@@ -924,7 +1001,7 @@ ShortFuncBody::ShortFuncBody(const locators::SpanLocator& pos, const shared_ptr<
 optional<shared_ptr<ShortFuncBody>> ShortFuncBody::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkArrow)) return {};
+    if (!tk.Skip(Token::Type::tkArrow)) return {};
     auto optExpr = Expression::parse(context);
     if (!optExpr) return {};
     block.Success();
@@ -937,10 +1014,10 @@ LongFuncBody::LongFuncBody(const locators::SpanLocator& pos, const shared_ptr<Bo
 optional<shared_ptr<LongFuncBody>> LongFuncBody::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkIs)) return {};
+    if (!tk.Skip(Token::Type::tkIs)) return {};
     auto optBody = Body::parse(context);
     if (!optBody) return {};
-    if (!tk.Read(Token::Type::tkEnd)) return {};
+    if (!tk.Skip(Token::Type::tkEnd)) return {};
     block.Success();
     return make_shared<LongFuncBody>(tk.ReadSinceStart(), *optBody);
 }
@@ -952,8 +1029,8 @@ FuncLiteral::FuncLiteral(const locators::SpanLocator& pos, const vector<shared_p
 optional<shared_ptr<FuncLiteral>> FuncLiteral::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkFunc)) return {};
-    if (!tk.Read(Token::Type::tkOpenParenthesis)) return {};
+    if (!tk.Skip(Token::Type::tkFunc)) return {};
+    if (!tk.Skip(Token::Type::tkOpenParenthesis)) return {};
     vector<shared_ptr<IdentifierToken>> params;
     {
         auto ign = tk.AutoStartIgnoreEoln();
@@ -961,7 +1038,7 @@ optional<shared_ptr<FuncLiteral>> FuncLiteral::parse(SyntaxContext& context) {
         auto optIdents = CommaIdents::parse(context);
         if (optIdents) params = optIdents.value()->idents;
     }
-    if (!tk.Read(Token::Type::tkClosedParenthesis)) return {};
+    if (!tk.Skip(Token::Type::tkClosedParenthesis)) return {};
     auto body = FuncBody::parse(context);
     if (!body) return {};
     block.Success();
@@ -998,7 +1075,7 @@ ArrayLiteral::ArrayLiteral(const locators::SpanLocator& pos, const vector<shared
 optional<shared_ptr<ArrayLiteral>> ArrayLiteral::parse(SyntaxContext& context) {
     USESCAN;
     auto block = tk.AutoStart();
-    if (!tk.Read(Token::Type::tkOpenBracket)) return {};
+    if (!tk.Skip(Token::Type::tkOpenBracket)) return {};
     vector<shared_ptr<Expression>> exprs;
     {
         auto ign = tk.AutoStartIgnoreEoln();
@@ -1006,20 +1083,31 @@ optional<shared_ptr<ArrayLiteral>> ArrayLiteral::parse(SyntaxContext& context) {
         auto optexprs = CommaExpressions::parse(context);
         if (optexprs) exprs = optexprs.value()->expressions;
     }
-    if (!tk.Read(Token::Type::tkClosedBracket)) return {};
+    if (!tk.Skip(Token::Type::tkClosedBracket)) return {};
     block.Success();
     return make_shared<ArrayLiteral>(tk.ReadSinceStart(), exprs);
 }
 VISITOR(ArrayLiteral)
 }  // namespace ast
 
-optional<shared_ptr<ast::Body>> SyntaxAnalyzer::analyze(const vector<shared_ptr<Token>>& tokens,
-                                                        const shared_ptr<const locators::CodeFile>& file,
-                                                        complog::ICompilationLog& log) {
-    SyntaxContext context(tokens, file, log);
+static optional<shared_ptr<ast::Body>> analyzeInContext(SyntaxContext& context, complog::ICompilationLog& log) {
     auto res = ast::parseProgram(context);
     if (!res)
         for (auto& err : context.tokens.Report().MakeReport()) log.Log(err);
     return res;
 }
+
+optional<shared_ptr<ast::Body>> SyntaxAnalyzer::analyze(TokenBuffer tokens,
+                                                        const shared_ptr<const locators::CodeFile>& file,
+                                                        complog::ICompilationLog& log) {
+    SyntaxContext context(std::move(tokens), file, log);
+    return analyzeInContext(context, log);
+}
+
+optional<shared_ptr<ast::Body>> SyntaxAnalyzer::analyze(const vector<shared_ptr<Token>>& tokens,
+                                                        const shared_ptr<const locators::CodeFile>& file,
+                                                        complog::ICompilationLog& log) {
+    SyntaxContext context(tokens, file, log);
+    return analyzeInContext(context, log);
+}
 }  // namespace dinterp
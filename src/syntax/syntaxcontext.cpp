@@ -1,3 +1,6 @@
+#include <bit>
+#include <cstdint>
+
 #include "dinterp/asterrors.h"
 #include "dinterp/complog/CompilationMessage.h"
 #include "dinterp/lexer.h"
@@ -33,24 +36,27 @@ void UnexpectedTokenTypeError::WriteMessageToStream(ostream& out, [[maybe_unused
 }
 vector<locators::Locator> UnexpectedTokenTypeError::Locators() const { return {loc}; }
 
-SyntaxErrorReport::SyntaxErrorReport(const shared_ptr<const locators::CodeFile>& file) : file(file) {}
+SyntaxErrorReport::SyntaxErrorReport(locators::FileId file) : file(file) {}
 void SyntaxErrorReport::ReportUnexpectedToken(size_t pos, Token::Type expected, Token::Type found) {
     if (rightmostPos > pos) return;
     if (rightmostPos < pos) {
         rightmostPos = pos;
-        unexpTokens.clear();
+        this->expected = 0;
     }
-    unexpTokens[found].insert(expected);
+    this->found = found;
+    this->expected |= uint64_t{1} << static_cast<int>(expected);
 }
 vector<shared_ptr<complog::CompilationMessage>> SyntaxErrorReport::MakeReport() const {
-    vector<shared_ptr<complog::CompilationMessage>> res;
-    for (auto& p : unexpTokens) {
-        res.push_back(make_shared<UnexpectedTokenTypeError>(
-            locators::Locator(file, rightmostPos), vector<Token::Type>(p.second.begin(), p.second.end()), p.first));
-    }
-    return res;
+    if (!expected) return {};
+    vector<Token::Type> types;
+    for (uint64_t rest = expected; rest; rest &= rest - 1) types.push_back(static_cast<Token::Type>(countr_zero(rest)));
+    return {make_shared<UnexpectedTokenTypeError>(locators::Locator(file, rightmostPos), types, found)};
 }
 
+SyntaxContext::SyntaxContext(TokenBuffer tokens, const std::shared_ptr<const locators::CodeFile>& file,
+                             complog::ICompilationLog& complog)
+    : tokens(std::move(tokens), file), compilationLog(&complog) {}
+
 SyntaxContext::SyntaxContext(const std::vector<std::shared_ptr<Token>>& tokens,
                              const std::shared_ptr<const locators::CodeFile>& file, complog::ICompilationLog& complog)
     : tokens(tokens, file), compilationLog(&complog) {}
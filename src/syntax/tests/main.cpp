@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <sstream>
 
 #include "dinterp/syntax.h"
 #include "fixture.h"
@@ -102,6 +103,46 @@ TEST_F(FileSample, CustomEmptyVar) {
     ExpectFailure(0, 3);
 }
 TEST_F(FileSample, CustomNewlines) { ReadFile("custom/newlines.d", true); }
+TEST_F(FileSample, CustomDispatch) { ReadFile("custom/dispatch.d", true); }
+TEST_F(FileSample, CustomPrecedence) {
+    ReadFile("custom/precedence.d", true);
+    auto print = dynamic_pointer_cast<ast::PrintStatement>(program->statements[0]);
+    ASSERT_EQ(print->expressions.size(), 4);
+    ASSERT_NE(dynamic_pointer_cast<ast::PrimaryIdent>(print->expressions[0]), nullptr);
+    auto negated = dynamic_pointer_cast<ast::Unary>(print->expressions[1]);
+    ASSERT_NE(negated, nullptr);
+    ASSERT_EQ(negated->pos.Excerpt(), "-a");
+    auto sum = dynamic_pointer_cast<ast::Sum>(print->expressions[2]);
+    ASSERT_NE(sum, nullptr);
+    ASSERT_EQ(sum->terms.size(), 3);
+    ASSERT_NE(dynamic_pointer_cast<ast::PrimaryIdent>(sum->terms[0]), nullptr);
+    ASSERT_NE(dynamic_pointer_cast<ast::Term>(sum->terms[1]), nullptr);
+    ASSERT_EQ(sum->terms[1]->pos.Excerpt(), "b * c");
+    auto conj = dynamic_pointer_cast<ast::AndOperator>(print->expressions[3]);
+    ASSERT_NE(conj, nullptr);
+    ASSERT_EQ(conj->operands.size(), 2);
+    auto inverted = dynamic_pointer_cast<ast::UnaryNot>(conj->operands[0]);
+    ASSERT_NE(inverted, nullptr);
+    ASSERT_NE(dynamic_pointer_cast<ast::BinaryRelation>(inverted->nested), nullptr);
+}
+
+TEST(SyntaxErrorReport, KeepsRightmostFailure) {
+    auto file = make_shared<locators::CodeFile>("<string>", "x := 1 2");
+    SyntaxErrorReport report(file->Id());
+    ASSERT_TRUE(report.MakeReport().empty());
+    report.ReportUnexpectedToken(2, Token::Type::tkIdent, Token::Type::tkAssign);
+    report.ReportUnexpectedToken(7, Token::Type::tkSemicolon, Token::Type::tkIntLiteral);
+    report.ReportUnexpectedToken(7, Token::Type::tkNewLine, Token::Type::tkIntLiteral);
+    report.ReportUnexpectedToken(5, Token::Type::tkPlus, Token::Type::tkIntLiteral);
+    report.ReportUnexpectedToken(7, Token::Type::tkSemicolon, Token::Type::tkIntLiteral);
+    auto messages = report.MakeReport();
+    ASSERT_EQ(messages.size(), 1);
+    stringstream text;
+    messages[0]->WriteMessageToStream(text, {});
+    ASSERT_EQ(text.str(), "Unexpected token at <string>:1:7; expected " + Token::TypeToString(Token::Type::tkNewLine) +
+                              " or " + Token::TypeToString(Token::Type::tkSemicolon) + ", but found " +
+                              Token::TypeToString(Token::Type::tkIntLiteral) + ".\n");
+}
 
 int main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
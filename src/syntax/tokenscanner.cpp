@@ -15,25 +15,40 @@ TokenScanner::StackBlock::StackBlock(int index, bool ignoreEoln)
     : StartIndex(index), Index(index), IgnoreEoln(ignoreEoln) {}
 
 size_t TokenScanner::StartOfToken(size_t index) const {
-    if (tokens.empty()) return 0;
-    if (index >= tokens.size()) return EndOfToken(tokens.size() - 1);
-    return tokens[index]->span.position;
+    if (!tokens.Size()) return 0;
+    if (index >= tokens.Size()) return EndOfToken(tokens.Size() - 1);
+    return tokens.SpanAt(index).position;
 }
 
 size_t TokenScanner::EndOfToken(size_t index) const {
-    if (tokens.empty()) return 0;
-    auto& span = tokens[min(tokens.size() - 1, index)]->span;
+    if (!tokens.Size()) return 0;
+    auto& span = tokens.SpanAt(min(tokens.Size() - 1, index));
     return span.position + span.length;
 }
 
 void TokenScanner::SkipEolns() {
-    while (Read(Token::Type::tkNewLine)) {
+    while (Skip(Token::Type::tkNewLine)) {
     }
 }
 
+const std::shared_ptr<Token>& TokenScanner::TokenObject(size_t index) {
+    auto& res = tokenObjects[index];
+    if (!res) res = tokens.MakeToken(index);
+    return res;
+}
+
+TokenScanner::TokenScanner(TokenBuffer tokens, const std::shared_ptr<const locators::CodeFile>& file)
+    : codeFile(file->Id()), tokens(std::move(tokens)), stack({{0, false}}), report(codeFile) {
+    tokenObjects.resize(this->tokens.Size());
+}
+
 TokenScanner::TokenScanner(const std::vector<std::shared_ptr<Token>>& tokens,
                            const std::shared_ptr<const locators::CodeFile>& file)
-    : codeFile(file), tokens(tokens), stack({{0, false}}), report(file) {}
+    : codeFile(file->Id()),
+      tokens(TokenBuffer::FromTokens(tokens)),
+      tokenObjects(tokens),
+      stack({{0, false}}),
+      report(codeFile) {}
 
 locators::Locator TokenScanner::PositionInFile() const { return locators::Locator(codeFile, StartOfToken(Index())); }
 
@@ -47,9 +62,9 @@ locators::SpanLocator TokenScanner::ReadSinceStart() const {
     if (startind == topframe.Index) return locators::SpanLocator(codeFile, StartOfToken(startind), 0);
     int endind = topframe.Index - 1;
     if (topframe.IgnoreEoln) {
-        while (endind >= startind && tokens[endind]->type == Token::Type::tkNewLine) --endind;
+        while (endind >= startind && tokens.TypeAt(endind) == Token::Type::tkNewLine) --endind;
         if (endind < startind) return locators::SpanLocator(codeFile, StartOfToken(startind), 0);
-        while (tokens[startind]->type == Token::Type::tkNewLine) ++startind;
+        while (tokens.TypeAt(startind) == Token::Type::tkNewLine) ++startind;
     }
     size_t start = StartOfToken(startind);
     size_t end = EndOfToken(endind);
@@ -58,7 +73,7 @@ locators::SpanLocator TokenScanner::ReadSinceStart() const {
 
 size_t TokenScanner::Index() const { return stack.back().Index; }
 
-const std::vector<std::shared_ptr<Token>>& TokenScanner::Tokens() const { return tokens; }
+const TokenBuffer& TokenScanner::Tokens() const { return tokens; }
 
 void TokenScanner::Start() {
     auto& topframe = stack.back();
@@ -82,28 +97,41 @@ void TokenScanner::EndSuccess() {
     if (prevframe.IgnoreEoln) SkipEolns();
 }
 
-std::shared_ptr<Token> TokenScanner::Peek() { return tokens[Index()]; }
+std::shared_ptr<Token> TokenScanner::Peek() { return TokenObject(Index()); }
+
+Token::Type TokenScanner::PeekType() const { return tokens.TypeAt(Index()); }
+
+void TokenScanner::ReportExpected(std::initializer_list<Token::Type> expected) {
+    size_t index = Index();
+    for (auto type : expected) report.ReportUnexpectedToken(tokens.SpanAt(index).position, type, tokens.TypeAt(index));
+}
 
 std::shared_ptr<Token> TokenScanner::Read() {
-    auto& res = tokens[Index()];
+    auto res = TokenObject(Index());
     Advance();
     return res;
 }
 
 void TokenScanner::Advance(size_t count) {
     int& index = stack.back().Index;
-    index = min(static_cast<int>(tokens.size()) - 1, static_cast<int>(index + count));
+    index = min(static_cast<int>(tokens.Size()) - 1, static_cast<int>(index + count));
 }
 
 std::optional<std::shared_ptr<Token>> TokenScanner::Read(Token::Type type) {
-    auto& res = tokens[Index()];
-    if (res->type != type) {
-        report.ReportUnexpectedToken(res->span.position, type, res->type);
-        return {};
+    size_t index = Index();
+    if (!Skip(type)) return {};
+    return TokenObject(index);
+}
+
+bool TokenScanner::Skip(Token::Type type) {
+    size_t index = Index();
+    if (tokens.TypeAt(index) != type) {
+        report.ReportUnexpectedToken(tokens.SpanAt(index).position, type, tokens.TypeAt(index));
+        return false;
     }
     Advance();
     if (stack.back().IgnoreEoln) SkipEolns();
-    return res;
+    return true;
 }
 
 SyntaxErrorReport& TokenScanner::Report() { return report; }